@@ -56,7 +56,7 @@
 #define CMSIS_device_header "stm32f4xx.h"
 #endif /* CMSIS_device_header */
 
-#define configENABLE_FPU                         0
+#define configENABLE_FPU                         1
 #define configENABLE_MPU                         0
 
 #define configUSE_PREEMPTION                     1
@@ -64,11 +64,13 @@
 #define configSUPPORT_DYNAMIC_ALLOCATION         1
 #define configUSE_IDLE_HOOK                      0
 #define configUSE_TICK_HOOK                      0
+#define configCHECK_FOR_STACK_OVERFLOW           2 /* vApplicationStackOverflowHook() in fault.c */
+#define configUSE_TICKLESS_IDLE                  1
 #define configCPU_CLOCK_HZ                       ( SystemCoreClock )
 #define configTICK_RATE_HZ                       ((TickType_t)1000)
 #define configMAX_PRIORITIES                     ( 56 )
 #define configMINIMAL_STACK_SIZE                 ((uint16_t)128)
-#define configTOTAL_HEAP_SIZE                    ((size_t)64000)
+#define configTOTAL_HEAP_SIZE                    ((size_t)4096)
 #define configMAX_TASK_NAME_LEN                  ( 16 )
 #define configUSE_TRACE_FACILITY                 1
 #define configUSE_16_BIT_TICKS                   0
@@ -157,7 +159,11 @@ See http://www.FreeRTOS.org/RTOS-Cortex-M3-M4.html. */
 /* Normal assert() semantics without relying on the provision of an assert.h
 header file. */
 /* USER CODE BEGIN 1 */
-#define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); for( ;; );}
+/* A failed assert is stored in the fault record (fault.c) and resets the board. */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void FAULT_assert(const char *file, int line) __attribute__((noreturn));
+#endif
+#define configASSERT( x ) if ((x) == 0) {taskDISABLE_INTERRUPTS(); FAULT_assert(__FILE__, __LINE__);}
 /* USER CODE END 1 */
 
 /* Definitions that map the FreeRTOS port interrupt handlers to their CMSIS
@@ -171,6 +177,22 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+
+/* Tickless idle: the HAL timebase (TIM1) would wake the MCU every ms, so it is
+suspended around the WFI in freertos.c. The parameter is passed by reference so
+the hook can report that it did its own wait-for-interrupt. */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void PreSleepProcessing(uint32_t *ulExpectedIdleTime);
+void PostSleepProcessing(uint32_t *ulExpectedIdleTime);
+#endif
+#define configPRE_SLEEP_PROCESSING( x )  PreSleepProcessing( &( x ) )
+#define configPOST_SLEEP_PROCESSING( x ) PostSleepProcessing( &( x ) )
+
+/* Trace ring of the fault record: the last tasks that ran before a fault. */
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+void FAULT_trace_switch(void);
+#endif
+#define traceTASK_SWITCHED_IN() FAULT_trace_switch()
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -3,8 +3,11 @@
 * @brief Behandelt de communicatie met de ARM-toetsjes met: Eventgroups, TaskNotify, Interrupt-handling.<br>
 * <b>Demonstreert: xEventGroupWaitBits(), xTaskGetHandle(), xTaskNotify(), xTaskNotifyWait(),xSemaphoregive(), xSemaphoreTake(). </b><br>
 *
-* Aan de ARM-keys is een interrupt gekoppeld (zie stm32f4xx_it.c). Die stuurt een event
-* door die opgevangen wordt door task ARM_keys_IRQ().
+* Aan de ARM-keys is een interrupt gekoppeld (zie stm32f4xx_it.c) die de keypad-scanner
+* start (keyscan.c). De scanner geeft de toetsen direct aan arm_keysshortcuts().
+* In de demo build (APP_PROFILE, admin.h) stuurt de scanner een ingedrukte toets ook als
+* event door naar task ARM_keys_IRQ(), voor de ledjes- en buzzer-demonstratie; in de
+* production build zijn er geen ARM_keys-taken.
 * @author MSC
 *
 * @date 5/5/2022
@@ -13,40 +16,57 @@
 #include <admin.h>
 #include "main.h"
 #include "cmsis_os.h"
-
-char enable_gpsaveraging = 0; // Flag to enable/disable GPS averaging
-char enable_errorcalc = 0; // Flag to enable/disable GPS error calculation
+#include "gps.h"
+#include "GPS_mode.h"
+#include "ARM_keys.h"
+#include "ledstatus.h"
+#include "beeper.h"
 
 /**
- * @brief Function to handle shortcuts based on ARM key presses
+ * @brief Function to handle shortcuts based on ARM key presses. The keys only
+ * generate events; GPS_mode decides whether the event is allowed in the current mode.
+ * Runs in the keypad scanner (timer service task).
  * 
- * @param key 
+ * @param key 1-16
+ * @param ev Press, auto-repeat or long press; the shortcuts ignore auto-repeat
  */
-void arm_keysshortcuts(uint32_t key){
+void arm_keysshortcuts(uint32_t key, KEY_EVENT ev){
+	if (ev == eKEY_REPEAT)
+		return;
+	if (ev == eKEY_LONG)
+	{
+		if (key == 16 && GPS_mode_get() != eMODE_IDLE && GPS_mode_get() != eMODE_REFERENCE_LOCKED)
+			GPS_mode_event(eEV_STOP); // hold Onder 4: stop survey-in or broadcasting
+		return;
+	}
+
 	switch(key){
 	case 13: //Onder 1
-		enable_gpsaveraging = 1; // Enable GPS averaging
-		UART_puts("GPS averaging enabled\r\n");
+		if (!GPS_mode_event(eEV_SURVEY_START)) // start averaging a reference position
+			UART_puts("Survey-in not possible now\r\n");
 		break;
 	case 14: //Onder 2
-		enable_gpsaveraging = 0; // Disable GPS averaging
-		UART_puts("GPS averaging disabled\r\n");
+		if (GPS_mode_get() == eMODE_SURVEY_IN) // stop the survey-in, keep any old reference
+			GPS_mode_event(eEV_STOP);
 		break;
 	case 15: //Onder 3
-		enable_errorcalc = 1; // Enable GPS error calculation
-		UART_puts("GPS error calculation enabled\r\n");
+		if (!GPS_mode_event(eEV_BROADCAST_START)) // start broadcasting corrections
+			UART_puts("Broadcast needs a locked reference\r\n");
 		break;
 	case 16: //Onder 4
-		enable_errorcalc = 0; // Disable GPS error calculation
-		UART_puts("GPS error calculation disabled\r\n");
-		LCD_clear();
-		LCD_puts("Disabled GPS err calc");
+		if (GPS_mode_get() == eMODE_BROADCASTING || GPS_mode_get() == eMODE_DEGRADED)
+		{
+			GPS_mode_event(eEV_STOP); // stop broadcasting
+			LCD_clear();
+			LCD_puts("Disabled GPS err calc");
+		}
 		break;
 	default:
 		break;
 	}
 }
 
+#if APP_PROFILE == APP_PROFILE_DEMO // de event-group- en notify-demonstratie
 /**
 * @brief Zet een kleurenledje aan en uit.
 * @param color De kleur.
@@ -61,7 +81,7 @@ void toggle_led (uint32_t color)
 
 
 /**
-* @brief Deze task handelt de ARM-toets af, die ontvangen is van de ISR-handler (zie: stm32f4xx_it.c).
+* @brief Deze task handelt de ARM-toets af, die ontvangen is van de keypad-scanner (zie: keyscan.c).
 * @param *argument Niet gebruikt, eventueel een waarde of string om te testen
 * @return void.
 */
@@ -77,7 +97,7 @@ void ARM_keys_IRQ (void *argument)
 
     while (1)
 	{
-		// wait for ISR (EXTI0_IRQHandler()) to signal that a key is pressed
+		// wait for the keypad scanner (keyscan.c) to signal that a key is pressed
 		key = xEventGroupWaitBits(hKEY_Event, 0xffff, pdTRUE, pdFALSE, portMAX_DELAY );
 
 		xTaskNotify(hTask, key, eSetValueWithOverwrite); // notify task2 with value
@@ -107,8 +127,8 @@ void ARM_keys_task (void *argument)
 
 	    xSemaphoreTake(hLED_Sem, portMAX_DELAY); // krijg toegang (mutex) tot leds
 
-    	LED_put((unsigned char)key); // set 8 leds-byte to key-value
-	    BUZZER_put (500);
+    	LEDSTAT_show((uint8_t)key); // set 8 leds-byte to key-value
+	    BEEP_play(eBEEP_KEY); // speelt op de achtergrond
 		osDelay(500);
 
 		UART_puts("\r\n\tARM_key pressed to leds: "); UART_putint(key);
@@ -129,9 +149,7 @@ void ARM_keys_task (void *argument)
 			toggle_led(led);
 	  	}
 
-		arm_keysshortcuts(key); // Check for shortcuts	
      	taskYIELD(); // done, force context switch
 	}
 }
-
-
+#endif
@@ -8,7 +8,8 @@
 #ifndef MYAPP_APP_ARM_KEYS_H_
 #define MYAPP_APP_ARM_KEYS_H_
 
-extern char enable_gpsaveraging; // Flag to enable/disable GPS averaging
-extern char enable_errorcalc; // Flag to enable/disable GPS error calculation
+#include "keyscan.h"
 
-#endif /* MYAPP_APP_GPS_PARSER_H_ */
+extern void arm_keysshortcuts(uint32_t key, KEY_EVENT ev);
+
+#endif /* MYAPP_APP_ARM_KEYS_H_ */
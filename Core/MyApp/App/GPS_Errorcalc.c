@@ -12,8 +12,16 @@
 #include "cmsis_os.h"
 #include "gps.h"
 #include "GPS_parser.h"
-#include "ARM_keys.h"
+#include "GPS_Errorcalc.h"
+#include "GPS_mode.h"
+#include "GPS_bus.h"
 #include "NRF_driver.h"
+#include "GPS_kalman.h"
+#include "fixfmt.h"
+#include "telemetry.h"
+#include "config.h"
+#include "supervisor.h"
+#include <math.h>
 
 #define debug_GPS_differential
 
@@ -21,34 +29,55 @@
 //#define live_GPS_differential
 #define dummy_GPS_differential
 
-GNRMC gnrmc_localcopy2; // local copy of struct for GNRMC-messages
+#ifdef dummy_GPS_differential
+    #define ERRORCALC_WAIT pdMS_TO_TICKS(1000) // no receiver needed: simulate a fix every second
+#else
+    #define ERRORCALC_WAIT pdMS_TO_TICKS(SUP_BEAT_MS) // block until fill_GNRMC() or a mode change wakes us, or the heartbeat is due
+#endif
+
+static GPS_SUB *sub;   // subscription on the fix bus
+GPS_FIX fix_localcopy2; // local copy of the latest epoch
 
 GPS_decimal_degrees_t currentpos;
 GPS_decimal_degrees_t differentialpos; // Struct to hold the working differential GPS position
-GPS_decimal_degrees_t GPS_error; // Struct to hold the latest GPS error
+float GPS_error_e, GPS_error_n, GPS_error_u; // latest GPS error in m, up is NAN without altitude
+
+static GPS_ENU_REF enu;         // local frame around differentialpos, set with the reference
+static KF_ERROR    kf;          // smoothed error and rate
+static uint16_t packet_seq;
+static osThreadId_t hNRF;      // NRF_driver, looked up once in GPS_Errorcalc()
 
-GPS_decimal_degrees_t differentialstorage[] = 
+/**
+ * @brief Metres to saturated integer millimetres for the correction packet.
+ */
+static int32_t mm32(float m)
 {
-    {52.084619172, 5.168584982},
-    {52.000100, 4.000100},
-    {52.000200, 4.000200},
-    {52.000300, 4.000300},
-    {0, 0}
-};
+    float mm = m * 1000.0f;
+    return (mm >= 2.1e9f ? INT32_MAX : mm <= -2.1e9f ? INT32_MIN : (int32_t)lrintf(mm));
+}
 
-void errorcalc()
+static int16_t mm16(float m)
 {
-    osThreadId_t hTask;
+    float mm = m * 1000.0f;
+    return (mm >= 32767.0f ? INT16_MAX : mm <= -32768.0f ? INT16_MIN : (int16_t)lrintf(mm));
+}
+
+/**
+ * @brief Variance in m^2 to a saturated standard deviation in mm.
+ */
+static uint16_t sd_mm(float var)
+{
+    float mm = sqrtf(var) * 1000.0f;
+    return (mm >= 65535.0f ? UINT16_MAX : (uint16_t)lrintf(mm));
+}
 
-    #ifdef debug_GPS_differential
-        UART_puts("\r\nStarting GPS error calc, waiting for new data\r\n");
-    #endif
 
+void errorcalc()
+{
     #ifdef live_GPS_differential
-    // Wait for notification from GPS.c that new data is available
-    ulTaskNotifyTake(pdTRUE, portMAX_DELAY); 
-    // Take a safe snapshot of the latest GNRMC data.
-	GPS_getLatestGNRMC(&gnrmc_localcopy2);
+    // Take a snapshot of the latest epoch, already decoded by fill_GNRMC()
+	if (!GPS_bus_read(sub, &fix_localcopy2))
+        return; // nothing new
     #endif
 
     #ifdef debug_GPS_differential
@@ -56,17 +85,18 @@ void errorcalc()
     #endif
 
     #ifdef dummy_GPS_differential
-        // For testing without real GPS data, cycle through the differential storage array
-        osDelay(1000); // Simulate delay for new data every second
-        strcpy(gnrmc_localcopy2.longitude, "5214.1873");
-        gnrmc_localcopy2.NS_ind = 'N';
-        strcpy(gnrmc_localcopy2.latitude, "0510.1150");
-        gnrmc_localcopy2.EW_ind = 'E';
-        gnrmc_localcopy2.status = 'A'; // Valid data
+        // For testing without real GPS data: a fixed position, $GNRMC ... 5214.1873,N,00510.1150,E
+        fix_localcopy2.latitude  = 52.236455;
+        fix_localcopy2.longitude = 5.168583;
+        fix_localcopy2.altitude  = NAN;
+        fix_localcopy2.status = 'A'; // Valid data
+        fix_localcopy2.time = (xTaskGetTickCount() * portTICK_PERIOD_MS) % 86400000UL;
+        fix_localcopy2.stamp = tlm_stamp();
     #endif
 
-	if(gnrmc_localcopy2.status != 'A') // If status is not valid, skip processing
+	if(fix_localcopy2.status != 'A') // If status is not valid, skip processing
 	{
+        GPS_mode_event(eEV_FIX_LOST); // broadcasting -> degraded
         LCD_clear();
         LCD_puts("No GPS Fix");
 		#ifdef debug_GPS_differential
@@ -76,45 +106,83 @@ void errorcalc()
 	}
 
     // Calculate error if valid GPS data is available
-    if(gnrmc_localcopy2.status == 'A')
+    if(fix_localcopy2.status == 'A')
     {
+        GPS_mode_event(eEV_FIX_OK); // degraded -> broadcasting
         UART_puts("Valid GPS data, calculating error...\r\n");
-        currentpos.latitude = convert_decimal_degrees(gnrmc_localcopy2.latitude, &gnrmc_localcopy2.NS_ind);
-        currentpos.longitude = convert_decimal_degrees(gnrmc_localcopy2.longitude, &gnrmc_localcopy2.EW_ind);
-        GPS_error.latitude = currentpos.latitude - differentialpos.latitude;
-        GPS_error.longitude = currentpos.longitude - differentialpos.longitude;
-
-        char lat_lcd[20];
-        char lon_lcd[20];
-        snprintf(lat_lcd, sizeof(lat_lcd), "ltE:%.9f", GPS_error.latitude);
-        snprintf(lon_lcd, sizeof(lon_lcd), "lgE:%.9f", GPS_error.longitude);
+        currentpos.latitude = fix_localcopy2.latitude;
+        currentpos.longitude = fix_localcopy2.longitude;
+        // Error in m: two multiplies per axis, the scale factors are set with the reference
+        GPS_enu(&enu, currentpos.latitude, currentpos.longitude, fix_localcopy2.altitude,
+                &GPS_error_e, &GPS_error_n, &GPS_error_u);
+
+        // Smooth the error; measurement variance from GST, else from the DOPs
+        float r, ru;
+        if (fix_localcopy2.std_lat > 0.0f && fix_localcopy2.std_lon > 0.0f)
+            r = (fix_localcopy2.std_lat * fix_localcopy2.std_lat + fix_localcopy2.std_lon * fix_localcopy2.std_lon) / 2.0f;
+        else
+            r = KF_UERE * KF_UERE * (fix_localcopy2.hdop > 0.0f ? fix_localcopy2.hdop * fix_localcopy2.hdop : 1.0f);
+        if (fix_localcopy2.std_alt > 0.0f)
+            ru = fix_localcopy2.std_alt * fix_localcopy2.std_alt;
+        else
+            ru = KF_UERE * KF_UERE * (fix_localcopy2.vdop > 0.0f ? fix_localcopy2.vdop * fix_localcopy2.vdop : 4.0f);
+
+        KF_update(&kf, fix_localcopy2.time, GPS_error_e, GPS_error_n, GPS_error_u, r, ru);
+
+        NRF_CORRECTION correction =
+        {
+            .version = NRF_PKT_VERSION,
+            .flags   = (kf.up_valid ? NRF_FLAG_UP_VALID : 0),
+            .seq     = packet_seq++,
+            .time    = kf.time,
+            .err_e   = mm32(kf.e.x),         .err_n  = mm32(kf.n.x),         .err_u  = mm32(kf.up_valid ? kf.u.x : 0.0f),
+            .rate_e  = mm16(kf.e.v),         .rate_n = mm16(kf.n.v),         .rate_u = mm16(kf.up_valid ? kf.u.v : 0.0f),
+            .sd_e    = sd_mm(kf.e.p00),      .sd_n   = sd_mm(kf.n.p00),      .sd_u   = sd_mm(kf.up_valid ? kf.u.p00 : 0.0f)
+        };
+
+        char lat_lcd[2 * FIXFMT_MAXLEN];
+        char lon_lcd[2 * FIXFMT_MAXLEN];
+        char *p;
+        p = fmt_str(lat_lcd, "N:"); p = fmt_float(p, kf.n.x, 2, FIXFMT_PLUS);
+        p = fmt_str(p, "m ");       p = fmt_float(p, kf.n.v, 2, FIXFMT_PLUS); fmt_str(p, "/s");
+        p = fmt_str(lon_lcd, "E:"); p = fmt_float(p, kf.e.x, 2, FIXFMT_PLUS);
+        p = fmt_str(p, "m ");       p = fmt_float(p, kf.e.v, 2, FIXFMT_PLUS); fmt_str(p, "/s");
         LCD_clear();
         LCD_puts(lat_lcd);
         LCD_puts(lon_lcd);
 
         // Update the error buffer for NRF transmission
-        NRF_setErrorBuffer(GPS_error);
+        NRF_setCorrection(&correction);
+        tlm_latency(TLM_PROBE_FIX_TO_CORR, fix_localcopy2.stamp);
+        tlm_send(TLM_ERROR, &correction, sizeof(correction));
 
         // Notify the NRF task that new error data is available
-        if (!(hTask = xTaskGetHandle("NRF_driver")))
-                    error_HaltOS("Err:NRF_hndle");
-        xTaskNotifyGive(hTask);
+        xTaskNotifyGive(hNRF);
 
         #ifdef debug_GPS_differential
-            char lat_str[20];
-            char lon_str[20];
-
-            snprintf(lat_str, sizeof(lat_str), "%.6f", currentpos.latitude);
-            snprintf(lon_str, sizeof(lon_str), "%.6f", currentpos.longitude);
-            UART_puts("Current Position: "); UART_puts(lat_str); UART_puts(" "); UART_puts(lon_str); UART_puts("\r\n");
-
-            snprintf(lat_str, sizeof(lat_str), "%.6f", differentialpos.latitude);
-            snprintf(lon_str, sizeof(lon_str), "%.6f", differentialpos.longitude);
-            UART_puts("Differential Position: "); UART_puts(lat_str); UART_puts(" "); UART_puts(lon_str); UART_puts("\r\n");
-
-            snprintf(lat_str, sizeof(lat_str), "%.6f", GPS_error.latitude);
-            snprintf(lon_str, sizeof(lon_str), "%.6f", GPS_error.longitude);
-            UART_puts("Calculated GPS Error: "); UART_puts(lat_str); UART_puts(" "); UART_puts(lon_str); UART_puts("\r\n");
+            char line[4 * FIXFMT_MAXLEN + 40];
+
+            p = fmt_str(line, "Current Position: ");      p = fmt_double(p, currentpos.latitude, 6, 0);
+            p = fmt_str(p, " ");                          p = fmt_double(p, currentpos.longitude, 6, 0);
+            fmt_str(p, "\r\n");
+            UART_puts(line);
+
+            p = fmt_str(line, "Differential Position: "); p = fmt_double(p, differentialpos.latitude, 6, 0);
+            p = fmt_str(p, " ");                          p = fmt_double(p, differentialpos.longitude, 6, 0);
+            fmt_str(p, "\r\n");
+            UART_puts(line);
+
+            p = fmt_str(line, "Calculated GPS Error E/N m: "); p = fmt_float(p, GPS_error_e, 3, FIXFMT_PLUS);
+            p = fmt_str(p, " ");                               p = fmt_float(p, GPS_error_n, 3, FIXFMT_PLUS);
+            fmt_str(p, "\r\n");
+            UART_puts(line);
+
+            p = fmt_str(line, "Filtered Error E/N m, m/s: ");
+            p = fmt_float(p, kf.e.x, 3, FIXFMT_PLUS); p = fmt_str(p, " "); p = fmt_float(p, kf.e.v, 4, FIXFMT_PLUS);
+            p = fmt_str(p, " ");
+            p = fmt_float(p, kf.n.x, 3, FIXFMT_PLUS); p = fmt_str(p, " "); p = fmt_float(p, kf.n.v, 4, FIXFMT_PLUS);
+            fmt_str(p, "\r\n");
+            UART_puts(line);
 
             DisplayTaskData();  // display all task data on UART
         #endif
@@ -123,22 +191,57 @@ void errorcalc()
 }
 
 
+/**
+ * @brief Sets the reference position the error is calculated against, and keeps it in
+ * the selected reference of the configuration (persistent after 'save').
+ * @note Only called outside broadcasting (survey-in, start-up), so errorcalc() never
+ * sees a half-written position.
+ */
+void GPS_Errorcalc_setReference(GPS_decimal_degrees_t pos)
+{
+    differentialpos = pos;
+    cfg.refs[cfg.ref_index] = pos;
+    GPS_enu_init(&enu, pos); // all trig happens here, not per epoch
+    KF_reset(&kf); // the error history belongs to the old reference
+}
+
+
+/**
+ * @brief Task that calculates and broadcasts the differential error. Blocks on its
+ * notification value (GPS_NOTIFY_FIX, GPS_NOTIFY_MODE); fixes are only forwarded
+ * while broadcasting or degraded.
+ */
 void GPS_Errorcalc(void *argument)
 {
+    uint32_t events;
+
     osDelay(100);
 
-	UART_puts((char *)__func__); UART_puts(" started\r\n");
+    if (!(hNRF = GetTaskhandle("NRF_driver")))
+        error_HaltOS("Err:NRF_hndle");
 
-    // Pointer to move through the differential storage array, start pointing to the first element
-    PGPS_decimal_degrees_t ptd = differentialstorage; 
+    sub = GPS_bus_subscribe(GPS_MODES(eMODE_BROADCASTING) | GPS_MODES(eMODE_DEGRADED));
+
+	UART_puts((char *)__func__); UART_puts(" started\r\n");
 
-    differentialpos.latitude = ptd->latitude;
-    differentialpos.longitude = ptd->longitude;
+    GPS_Errorcalc_setReference(cfg.refs[cfg.ref_index]); // stored reference, see config.c
+    GPS_mode_event(eEV_REFERENCE_SET); // idle -> reference-locked
 
     while (1)
     {
-		if(enable_errorcalc == 1){errorcalc();}
-        osDelay(1);
+        SUP_alive(SUP_ERRORCALC);
+
+        if (xTaskNotifyWait(0x00, 0xffffffff, &events, ERRORCALC_WAIT) == pdFALSE)
+#ifdef dummy_GPS_differential
+            events = GPS_NOTIFY_FIX; // dummy mode: timeout stands in for a new fix
+#else
+            continue; // only the heartbeat
+#endif
+
+        GPS_MODE mode = GPS_mode_get();
+
+        if ((events & GPS_NOTIFY_FIX) && (mode == eMODE_BROADCASTING || mode == eMODE_DEGRADED))
+            errorcalc();
     }
 }
 
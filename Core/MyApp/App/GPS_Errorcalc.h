@@ -11,5 +11,6 @@
 #define MYAPP_APP_GPS_ERRORCALC_H_
 
 extern void GPS_Errorcalc(void *argument);
+extern void GPS_Errorcalc_setReference(GPS_decimal_degrees_t pos);
 
 #endif /* MYAPP_APP_GPS_ERRORCALC_H_ */
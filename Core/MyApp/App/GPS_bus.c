@@ -0,0 +1,149 @@
+/*
+ * GPS_bus.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Publish/subscribe bus for GPS fixes. fill_GNRMC() decodes every epoch once into
+ * a GPS_FIX and publishes it; every subscriber task is woken with GPS_NOTIFY_FIX
+ * (if the current mode is in its mask) and reads the fix lock-free. Adding a
+ * consumer costs one notification per epoch, no extra parsing or conversion.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "gps.h"
+#include "seqbuf.h"
+#include "GPS_bus.h"
+
+static GPS_FIX  fix_slots[SEQBUF_SLOTS];
+static SEQBUF   fix_buf = SEQBUF_INIT(fix_slots);
+
+static GPS_SUB           subs[GPS_BUS_MAXSUBS];
+static volatile uint32_t nsubs = 0;
+
+
+/**
+ * @brief Registers the calling task as subscriber.
+ * @param modes GPS_MODES() mask of the modes in which fixes are wanted; mode changes
+ * are always delivered (GPS_NOTIFY_MODE)
+ * @return The subscription, pass it to GPS_bus_read()
+ */
+GPS_SUB *GPS_bus_subscribe(uint32_t modes)
+{
+	GPS_SUB *sub;
+
+	taskENTER_CRITICAL();
+	if (nsubs >= GPS_BUS_MAXSUBS)
+	{
+		taskEXIT_CRITICAL();
+		error_HaltOS("Err:GPS_bus full");
+	}
+	sub = &subs[nsubs];
+	sub->task     = xTaskGetCurrentTaskHandle();
+	sub->modes    = modes;
+	sub->last_seq = seqbuf_seq(&fix_buf);
+	nsubs++;
+	taskEXIT_CRITICAL();
+
+	return sub;
+}
+
+
+/**
+ * @brief Sets notification bits of the subscribed tasks. Fixes only wake the tasks
+ * that want them in the current mode, mode changes wake all.
+ * @param bits GPS_NOTIFY_FIX and/or GPS_NOTIFY_MODE
+ */
+void GPS_notify(uint32_t bits)
+{
+	uint32_t mode = GPS_MODES(GPS_mode_get());
+	uint32_t i, n = nsubs;
+	int      wake;
+
+	for (i = 0; i < n; i++)
+	{
+		// callers run in several tasks (and the timer task), GPS_bus_read() clears pending
+		taskENTER_CRITICAL();
+		if (bits & GPS_NOTIFY_MODE)
+			subs[i].pending = FALSE; // a fix skipped because of the mode change is no overrun
+
+		wake = ((bits & GPS_NOTIFY_MODE) || (subs[i].modes & mode));
+		if (wake)
+		{
+			if (bits & GPS_NOTIFY_FIX)
+			{
+				if (subs[i].pending)
+					subs[i].overruns++; // previous fix was never read
+				subs[i].pending = TRUE;
+			}
+			subs[i].wakeups++;
+		}
+		taskEXIT_CRITICAL();
+
+		if (wake)
+			xTaskNotify(subs[i].task, bits, eSetBits);
+	}
+}
+
+
+/**
+ * @brief Publishes a decoded fix and wakes the subscribers. Only fill_GNRMC() publishes.
+ * @param fix The decoded epoch; fix->seq is ignored, readers get it from GPS_bus_read()
+ * @return The epoch number
+ */
+uint32_t GPS_bus_publish(const GPS_FIX *fix)
+{
+	GPS_FIX *slot = seqbuf_begin(&fix_buf);
+	uint32_t seq;
+
+	*slot = *fix;
+	seq = seqbuf_commit(&fix_buf); // the slot is read-only from here on
+
+	GPS_notify(GPS_NOTIFY_FIX);
+	return seq;
+}
+
+
+/**
+ * @brief Copies the latest fix for a subscriber.
+ * @return Epoch number, 0 if nothing new was published since the last read
+ */
+uint32_t GPS_bus_read(GPS_SUB *sub, GPS_FIX *fix)
+{
+	uint32_t seq;
+
+	sub->pending = FALSE;
+
+	if (seqbuf_seq(&fix_buf) == sub->last_seq)
+		return 0;
+
+	if (!(seq = seqbuf_read(&fix_buf, fix)))
+		return 0;
+
+	fix->seq = seq;
+	sub->last_seq = seq;
+	return seq;
+}
+
+
+/**
+ * @brief Displays the subscribers and their counters on the UART.
+ */
+void GPS_bus_report(void)
+{
+	uint32_t i;
+
+	UART_puts("\r\nGPS bus, epochs published: "); UART_putint(seqbuf_seq(&fix_buf));
+	UART_puts("\t torn reads retried: ");         UART_putint(fix_buf.retries);
+
+	for (i = 0; i < nsubs; i++)
+	{
+		UART_puts("\r\n\t ");           UART_puts(pcTaskGetName(subs[i].task));
+		UART_puts("\t wakeups: ");      UART_putint(subs[i].wakeups);
+		UART_puts("\t last epoch: ");   UART_putint(subs[i].last_seq);
+		UART_puts("\t overruns: ");     UART_putint(subs[i].overruns);
+	}
+	UART_puts("\r\n");
+}
@@ -0,0 +1,63 @@
+/*
+ * GPS_bus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_GPS_BUS_H_
+#define MYAPP_APP_GPS_BUS_H_
+
+#include "GPS_mode.h"
+
+/// Maximum number of subscribers (parser, errorcalc, logger, display, ...)
+#define GPS_BUS_MAXSUBS 6
+
+/// Mode masks for GPS_bus_subscribe(): fixes are only delivered in these modes
+#define GPS_MODES(m)    (1UL << (m))
+#define GPS_MODES_ALL   0xffffffffUL
+
+/**
+ * @brief One GPS epoch, decoded once by fill_GNRMC() and shared by all subscribers.
+ */
+typedef struct
+{
+	uint32_t seq;        // epoch number, set by GPS_bus_publish()
+	uint32_t time;       // ms since midnight (UTC)
+	char     status;     // A=valid, V=not valid
+	double   latitude;   // decimal degrees, + for N
+	double   longitude;  // decimal degrees, + for E
+	float    speed;      // knots
+	float    course;     // degrees
+	// quality, from the latest GGA/GSA/GST (same or previous epoch), 0 if not received
+	float    altitude;   // GGA: m above mean sea level, NAN if no GGA
+	uint8_t  quality;    // GGA: 0=no fix, 1=GPS, 2=DGPS
+	uint8_t  numsv;      // GGA: satellites used
+	float    hdop;
+	float    vdop;       // GSA
+	float    pdop;
+	float    std_lat;    // GST: m
+	float    std_lon;    // GST: m
+	float    std_alt;    // GST: m
+	uint32_t stamp;      // tlm_stamp() at publication, for latency probes
+} GPS_FIX;
+
+/**
+ * @brief A registered subscriber with its own counters.
+ */
+typedef struct
+{
+	osThreadId_t      task;     // task that is notified
+	uint32_t          modes;    // GPS_MODES() mask
+	uint32_t          last_seq; // epoch of the last GPS_bus_read()
+	volatile uint32_t pending;  // a fix was delivered and not read yet
+	volatile uint32_t wakeups;  // notifications sent to the task
+	volatile uint32_t overruns; // fixes delivered but overwritten before they were read
+} GPS_SUB;
+
+extern GPS_SUB *GPS_bus_subscribe(uint32_t modes);
+extern uint32_t GPS_bus_publish  (const GPS_FIX *fix);
+extern uint32_t GPS_bus_read     (GPS_SUB *sub, GPS_FIX *fix);
+extern void     GPS_bus_report   (void);
+
+#endif /* MYAPP_APP_GPS_BUS_H_ */
@@ -0,0 +1,117 @@
+/*
+ * GPS_kalman.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Smooths the differential error with a constant-velocity Kalman filter per axis.
+ * The east, north and up errors are independent, so three 2-state filters replace one
+ * 6-state filter: no matrix inversion, a few dozen single-precision FPU operations
+ * per epoch. The rate lets rovers propagate the correction between packets.
+ */
+
+#include <string.h>
+#include <math.h>
+#include "GPS_kalman.h"
+
+#define MS_PER_DAY 86400000UL
+
+
+/**
+ * @brief Starts one axis at the first measurement.
+ */
+static void KF_axis_init(KF_AXIS *a, float z, float r)
+{
+	a->x   = z;
+	a->v   = 0.0f;
+	a->p00 = r;
+	a->p01 = 0.0f;
+	a->p11 = KF_P0_RATE;
+}
+
+
+/**
+ * @brief Predict dt seconds ahead, then correct with measurement z of variance r.
+ */
+static void KF_axis_step(KF_AXIS *a, float dt, float z, float r)
+{
+	float dt2 = dt * dt;
+	float y, s, k0, k1, p00, p01;
+
+	// predict: x = F x, P = F P F' + Q, F = [1 dt; 0 1], Q from white acceleration
+	a->x   += a->v * dt;
+	a->p00 += dt * (2.0f * a->p01 + dt * a->p11) + KF_Q * dt2 * dt / 3.0f;
+	a->p01 += dt * a->p11                        + KF_Q * dt2 / 2.0f;
+	a->p11 +=                                      KF_Q * dt;
+
+	// update with H = [1 0]
+	y  = z - a->x;
+	s  = a->p00 + r;
+	k0 = a->p00 / s;
+	k1 = a->p01 / s;
+
+	a->x += k0 * y;
+	a->v += k1 * y;
+
+	p00 = a->p00;
+	p01 = a->p01;
+	a->p00 = (1.0f - k0) * p00;
+	a->p01 = (1.0f - k0) * p01;
+	a->p11 -= k1 * p01;
+}
+
+
+/**
+ * @brief Clears the filter; the next measurement starts it again.
+ */
+void KF_reset(KF_ERROR *kf)
+{
+	memset(kf, 0, sizeof(KF_ERROR));
+}
+
+
+/**
+ * @brief Adds one epoch of the differential error.
+ * @param time Epoch time, ms since midnight (UTC)
+ * @param ze, zn, zu Measured error east/north/up in m; zu is NAN if there is no altitude
+ * @param r, ru Measurement variance horizontal/vertical in m^2
+ */
+void KF_update(KF_ERROR *kf, uint32_t time, float ze, float zn, float zu, float r, float ru)
+{
+	uint32_t dt_ms = (time + MS_PER_DAY - kf->time) % MS_PER_DAY; // handles midnight
+	float    dt = dt_ms / 1000.0f;
+
+	if (kf->valid && (dt_ms == 0 || dt_ms > KF_MAX_GAP_MS))
+	{
+		if (dt_ms == 0) // same epoch twice, nothing to add
+			return;
+		kf->restarts++;
+		kf->valid = 0;
+	}
+
+	if (!kf->valid)
+	{
+		KF_axis_init(&kf->e, ze, r);
+		KF_axis_init(&kf->n, zn, r);
+		kf->up_valid = 0;
+		kf->valid = 1;
+	}
+	else
+	{
+		KF_axis_step(&kf->e, dt, ze, r);
+		KF_axis_step(&kf->n, dt, zn, r);
+	}
+
+	if (isnan(zu))           // no altitude: up restarts when it comes back
+		kf->up_valid = 0;
+	else if (!kf->up_valid)
+	{
+		KF_axis_init(&kf->u, zu, ru);
+		kf->up_valid = 1;
+	}
+	else
+		KF_axis_step(&kf->u, dt, zu, ru);
+
+	kf->time = time;
+	kf->updates++;
+}
@@ -0,0 +1,46 @@
+/*
+ * GPS_kalman.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_GPS_KALMAN_H_
+#define MYAPP_APP_GPS_KALMAN_H_
+
+#include <stdint.h>
+
+/// process noise: white acceleration of the error, (m/s^2)^2 per s; GPS errors drift slowly
+#define KF_Q            0.0004f
+/// measurement noise if the receiver gives no GST sigmas: (KF_UERE * HDOP)^2
+#define KF_UERE         2.5f
+/// initial variance of the error rate, (m/s)^2
+#define KF_P0_RATE      0.01f
+/// a gap longer than this restarts the filter
+#define KF_MAX_GAP_MS   10000
+
+/**
+ * @brief Constant-velocity Kalman filter for one axis of the differential error, float32.
+ * State: error x (m) and its rate v (m/s); P is the symmetric covariance.
+ */
+typedef struct
+{
+	float x, v;          // state
+	float p00, p01, p11; // covariance
+} KF_AXIS;
+
+/// filter for the east, north and up error
+typedef struct
+{
+	KF_AXIS  e, n, u;
+	uint32_t time;       // ms since midnight of the last update
+	uint8_t  valid;      // FALSE until the first measurement
+	uint8_t  up_valid;   // FALSE while no altitude is available
+	uint32_t updates;
+	uint32_t restarts;
+} KF_ERROR;
+
+extern void KF_reset (KF_ERROR *kf);
+extern void KF_update(KF_ERROR *kf, uint32_t time, float ze, float zn, float zu, float r, float ru);
+
+#endif /* MYAPP_APP_GPS_KALMAN_H_ */
@@ -0,0 +1,118 @@
+/*
+ * GPS_mode.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Central operating-mode state machine. All mode changes go through
+ * GPS_mode_event(); a change wakes the GPS tasks with GPS_NOTIFY_MODE, and
+ * GPS_notify() only forwards fixes to the task the current mode needs. Survey-in
+ * and error calculation can therefore never run at the same time on the same data.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "gps.h"
+#include "GPS_mode.h"
+#include "beeper.h"
+
+static volatile GPS_MODE mode = eMODE_IDLE;
+static int reference_valid = FALSE; // a reference position has been set at least once
+
+static const char *mode_names[eMODE_COUNT] =
+{
+	"IDLE", "SURVEY-IN", "REFERENCE-LOCKED", "BROADCASTING", "DEGRADED"
+};
+
+
+/**
+ * @brief Returns the current operating mode. A single aligned read, no lock needed.
+ */
+GPS_MODE GPS_mode_get(void)
+{
+	return mode;
+}
+
+
+/**
+ * @brief Returns the printable name of a mode.
+ */
+const char *GPS_mode_name(GPS_MODE m)
+{
+	return (m < eMODE_COUNT ? mode_names[m] : "?");
+}
+
+
+/**
+ * @brief The transition table: returns the next mode for an event, or the
+ * current mode if the event is not allowed in this mode.
+ */
+static GPS_MODE GPS_mode_next(GPS_MODE current, GPS_MODE_EVENT event)
+{
+	switch (current)
+	{
+	case eMODE_IDLE:
+		if (event == eEV_SURVEY_START)    return eMODE_SURVEY_IN;
+		if (event == eEV_REFERENCE_SET)   return eMODE_REFERENCE_LOCKED;
+		break;
+
+	case eMODE_SURVEY_IN:
+		if (event == eEV_SURVEY_DONE)     return eMODE_REFERENCE_LOCKED;
+		if (event == eEV_STOP)            return (reference_valid ? eMODE_REFERENCE_LOCKED : eMODE_IDLE);
+		break;
+
+	case eMODE_REFERENCE_LOCKED:
+		if (event == eEV_SURVEY_START)    return eMODE_SURVEY_IN;
+		if (event == eEV_BROADCAST_START) return eMODE_BROADCASTING;
+		break;
+
+	case eMODE_BROADCASTING:
+		if (event == eEV_FIX_LOST)        return eMODE_DEGRADED;
+		if (event == eEV_STOP)            return eMODE_REFERENCE_LOCKED;
+		break;
+
+	case eMODE_DEGRADED:
+		if (event == eEV_FIX_OK)          return eMODE_BROADCASTING;
+		if (event == eEV_STOP)            return eMODE_REFERENCE_LOCKED;
+		break;
+
+	default:
+		break;
+	}
+	return current;
+}
+
+
+/**
+ * @brief Feeds an event into the state machine. On a mode change the GPS tasks
+ * are notified with GPS_NOTIFY_MODE.
+ * @param event The event
+ * @return TRUE if the mode changed, FALSE if the event was ignored in this mode
+ */
+int GPS_mode_event(GPS_MODE_EVENT event)
+{
+	GPS_MODE old, new;
+
+	taskENTER_CRITICAL();
+	if (event == eEV_SURVEY_DONE || event == eEV_REFERENCE_SET)
+		reference_valid = TRUE;
+	old  = mode;
+	new  = GPS_mode_next(old, event);
+	mode = new;
+	taskEXIT_CRITICAL();
+
+	if (new == old)
+		return FALSE;
+
+	UART_puts("\r\nMode: "); UART_puts(mode_names[old]);
+	UART_puts(" -> ");       UART_puts(mode_names[new]); UART_puts("\r\n");
+
+	if (new == eMODE_DEGRADED)
+		BEEP_play(eBEEP_FIX_LOST);
+	else if (event == eEV_SURVEY_DONE)
+		BEEP_play(eBEEP_SURVEY_DONE);
+
+	GPS_notify(GPS_NOTIFY_MODE);
+	return TRUE;
+}
@@ -0,0 +1,42 @@
+/*
+ * GPS_mode.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_GPS_MODE_H_
+#define MYAPP_APP_GPS_MODE_H_
+
+/**
+ * @brief Operating modes of the base station.
+ * Idle -> Survey-in -> Reference-locked -> Broadcasting <-> Degraded
+ */
+typedef enum
+{
+	eMODE_IDLE = 0,         // no reference position known
+	eMODE_SURVEY_IN,        // averaging fixes into a reference position (GPS_parser)
+	eMODE_REFERENCE_LOCKED, // reference known, nothing is broadcast
+	eMODE_BROADCASTING,     // calculating and transmitting corrections (GPS_Errorcalc)
+	eMODE_DEGRADED,         // broadcasting, but the receiver lost its fix
+	eMODE_COUNT
+} GPS_MODE;
+
+/// Events that drive the mode transitions
+typedef enum
+{
+	eEV_SURVEY_START = 0,   // user: (re)start the survey-in
+	eEV_SURVEY_DONE,        // GPS_parser: average complete, reference set
+	eEV_REFERENCE_SET,      // a stored reference position was loaded
+	eEV_BROADCAST_START,    // user: start broadcasting corrections
+	eEV_STOP,               // user: stop survey-in or broadcasting
+	eEV_FIX_LOST,           // GPS_Errorcalc: receiver reports status 'V'
+	eEV_FIX_OK,             // GPS_Errorcalc: receiver reports status 'A' again
+	eEV_COUNT
+} GPS_MODE_EVENT;
+
+extern GPS_MODE    GPS_mode_get  (void);
+extern int         GPS_mode_event(GPS_MODE_EVENT event);
+extern const char *GPS_mode_name (GPS_MODE mode);
+
+#endif /* MYAPP_APP_GPS_MODE_H_ */
@@ -12,86 +12,342 @@
 #include "cmsis_os.h"
 #include "gps.h"
 #include "GPS_parser.h"
-#include "ARM_keys.h"
+#include "GPS_Errorcalc.h"
+#include "GPS_mode.h"
+#include "GPS_bus.h"
+#include "fixfmt.h"
+#include "config.h"
+#include <math.h>
 
 // #define debug_GPS_parser 
 
-#define samples_size 200 // Number of samples to average for GPS data. Keep in mind sample frequency of 1Hz, so this is 15 minutes of data.
+/*
+ * Survey-in: robust, quality-weighted mean, computed incrementally (no sample array).
+ * Each fix gets a weight from its accuracy (GST sigmas, else HDOP). Residuals beyond
+ * SURVEY_HUBER_K sigma are down-weighted (Huber), beyond SURVEY_GATE_K sigma rejected.
+ * The survey ends as soon as the standard error of the mean reaches cfg.survey.target_mm.
+ * Successive fixes are not independent: the standard error uses at most one effective
+ * sample per cfg.survey.decorr_s seconds of survey time.
+ * The sample limits, the target and the HDOP limit are in the stored configuration (cfg.survey).
+ */
+#define SURVEY_MIN_SV        4      // satellites needed for a 3D fix
+#define SURVEY_WARMUP        10     // accepted fixes before the outlier gate is used
+#define SURVEY_HUBER_K       1.5f   // residuals beyond k*sigma are down-weighted
+#define SURVEY_GATE_K        5.0f   // residuals beyond k*sigma are rejected
+#define SURVEY_SIGMA_FLOOR   0.5f   // m, sigma used by the gate never drops below this
+
+/// reasons a fix is not used for the survey-in
+typedef enum
+{
+	eREJ_STATUS = 0,  // status 'V'
+	eREJ_QUALITY,     // GGA quality 0 or too few satellites
+	eREJ_HDOP,        // HDOP above cfg.survey.max_hdop
+	eREJ_STALE,       // same epoch time as the previous fix
+	eREJ_OUTLIER,     // residual beyond SURVEY_GATE_K sigma
+	eREJ_COUNT
+} SURVEY_REJECT;
+
+static const char *reject_names[eREJ_COUNT] = { "no fix", "quality/sats", "hdop", "stale", "outlier" };
+
+/// running state of the survey-in; float32 (FPU): the means are offsets of at most a few
+/// metres from the first fix
+typedef struct
+{
+	GPS_ENU_REF frame;         // local frame around the first accepted fix
+	float    sw, sw2;          // sum of weights, sum of squared weights
+	float    n, e;             // weighted mean, m north/east of the origin
+	float    swu, u;           // sum of weights and weighted mean of the fixes with an altitude
+	float    S;                // weighted sum of squared residuals (West's algorithm)
+	uint32_t accepted;
+	uint32_t downweighted;     // accepted with a Huber weight < 1
+	uint32_t first_time;       // epoch time of the first accepted fix
+	uint32_t last_time;        // epoch time of the last fix
+	uint32_t rejected[eREJ_COUNT];
+} SURVEY;
+
+static GPS_SUB *sub;  // subscription on the fix bus
+GPS_FIX fix_localcopy; // local copy of the latest epoch
+GPS_decimal_degrees_t GPS_average_pos = {0.0, 0.0, NAN}; // Struct to hold the average GPS position
+static SURVEY survey;
+
+char savedLatitude[FIXFMT_MAXLEN]; // Buffer to save latitude
+char savedLongitude[FIXFMT_MAXLEN]; // Buffer to save longitude
 
-GNRMC gnrmc_localcopy; // local copy of struct for GNRMC-messages
-GPS_decimal_degrees_t GPS_samples[samples_size]; // Struct array to hold converted GPS coordinates
-GPS_decimal_degrees_t GPS_average_pos = {0.0, 0.0}; // Struct to hold the average GPS position
-int samplecount = 0; // Counter for the number of samples taken
+double convert_decimal_degrees(char *nmea_coordinate, char* ns);
 
-char savedLatitude[20]; // Buffer to save latitude
-char savedLongitude[20]; // Buffer to save longitude
 
-double convert_decimal_degrees(char *nmea_coordinate, char* ns);
-double calc_average(GPS_decimal_degrees_t *samples, int count, char coord);
+/**
+ * @brief Starts a new survey-in.
+ */
+static void survey_reset(void)
+{
+	memset(&survey, 0, sizeof(survey));
+}
+
+
+/**
+ * @brief Standard deviation of one axis, from the weighted residuals so far.
+ */
+static float survey_sigma(void)
+{
+	return (survey.sw > 0.0f ? sqrtf(survey.S / survey.sw / 2.0f) : 0.0f);
+}
+
+
+/**
+ * @brief Effective number of independent samples: sw^2/sw2 for the weights, but at most
+ * one per cfg.survey.decorr_s seconds since the first fix (the epoch time wraps at midnight).
+ */
+static float survey_neff(void)
+{
+	float    n = survey.sw * survey.sw / survey.sw2;
+	uint32_t span_ms, t;
+
+	if (cfg.survey.decorr_s)
+	{
+		span_ms = (survey.last_time - survey.first_time + 86400000u) % 86400000u;
+		t = 1 + span_ms / (1000 * cfg.survey.decorr_s);
+		if ((float)t < n)
+			n = (float)t;
+	}
+	return n;
+}
+
 
 /**
- * @brief Adds a sample to the GPS_samples array and calculates the average position when enough samples are collected.
- * @note This function checks validity of the GPS data before adding a sample.The sample size is defined by samples_size.
+ * @brief Standard error of the mean in mm, with the effective number of samples.
+ */
+static uint32_t survey_stderr_mm(void)
+{
+	if (survey.accepted < 2)
+		return 0xffffffff;
+	return (uint32_t)(1000.0f * survey_sigma() / sqrtf(survey_neff()));
+}
+
+
+/**
+ * @brief Progress of the survey-in in percent: it ends when the minimum number of fixes
+ * is reached and either the target standard error or the maximum number of fixes.
+ * Read-only, for the status LEDs; a value torn by a concurrent update is harmless.
+ */
+uint32_t GPS_survey_progress(void)
+{
+	uint32_t accepted = survey.accepted, min_pct, end_pct, err;
+
+	if (accepted == 0)
+		return 0;
+	min_pct = accepted * 100 / cfg.survey.min_samples;
+	end_pct = accepted * 100 / cfg.survey.max_samples;
+	if ((err = survey_stderr_mm()) > 0 && cfg.survey.target_mm * 100 / err > end_pct)
+		end_pct = cfg.survey.target_mm * 100 / err;
+
+	min_pct = (min_pct < end_pct ? min_pct : end_pct);
+	return (min_pct > 100 ? 100 : min_pct);
+}
+
+
+/**
+ * @brief Displays the survey-in result and the rejected fixes per reason on the UART.
+ */
+static void survey_report(void)
+{
+	int i;
+
+	UART_puts("\r\n\t accepted: ");        UART_putint(survey.accepted);
+	UART_puts("\t down-weighted: ");         UART_putint(survey.downweighted);
+	UART_puts("\t sigma mm: ");              UART_putint((int)(1000.0f * survey_sigma()));
+	UART_puts("\t std error mm: ");          UART_putint(survey_stderr_mm());
+	UART_puts("\t effective samples: ");     UART_putint((int)survey_neff());
+	UART_puts("\r\n\t rejected:");
+	for (i = 0; i < eREJ_COUNT; i++)
+	{
+		UART_puts(" "); UART_puts(reject_names[i]); UART_puts(": "); UART_putint(survey.rejected[i]);
+	}
+	UART_puts("\r\n");
+}
+
+
+/**
+ * @brief Checks a fix and returns its base weight, or the reason to reject it.
+ * @param weight Weight from the accuracy: 1/(sigma_lat^2 + sigma_lon^2) from GST, else 1/HDOP^2
+ * @return eREJ_COUNT if the fix can be used
+ */
+static SURVEY_REJECT survey_check(GPS_FIX *fix, float *weight)
+{
+	if (fix->status != 'A')
+		return eREJ_STATUS;
+	if ((fix->numsv || fix->quality) && (fix->quality == 0 || fix->numsv < SURVEY_MIN_SV)) // only if GGA was received
+		return eREJ_QUALITY;
+	if (fix->hdop > cfg.survey.max_hdop)
+		return eREJ_HDOP;
+	if (survey.accepted && fix->time == survey.last_time) // receiver repeats its last fix
+		return eREJ_STALE;
+
+	if (fix->std_lat > 0.0f && fix->std_lon > 0.0f)
+		*weight = 1.0f / (fix->std_lat * fix->std_lat + fix->std_lon * fix->std_lon);
+	else if (fix->hdop > 0.0f)
+		*weight = 1.0f / (fix->hdop * fix->hdop);
+	else
+		*weight = 1.0f;
+
+	return eREJ_COUNT;
+}
+
+
+/**
+ * @brief Adds a fix to the survey-in and ends the survey when the mean is accurate enough.
+ * @note The fix is checked (status, quality, HDOP, stale, outlier) before it is used;
+ * rejected fixes are counted per reason.
  * 
  */
 void add_GPS_sample()
 {
-	/*
-	 * Take a safe snapshot of the latest GNRMC data. GPS_getLatestGNRMC
-	 * copies under the GPS mutex into the provided destination, so we
-	 * first copy into a local temporary and then memcpy that snapshot
-	 * into `gnrmc_localcopy`. This ensures the data we
-	 * use remains valid even if frontendBuffer changes later.
-	 */
-	GPS_getLatestGNRMC(&gnrmc_localcopy);
-
-	if(gnrmc_localcopy.status == 'V') // If status is 'N' (not valid), skip processing
+	SURVEY_REJECT reason;
+	float w, dn, de, r, s, new_n, new_e;
+	float fe, fn, fu;
+
+	// Nothing new since the last sample (e.g. a mode notification): skip
+	if (!GPS_bus_read(sub, &fix_localcopy))
+		return;
+
+	if ((reason = survey_check(&fix_localcopy, &w)) != eREJ_COUNT)
 	{
+		survey.rejected[reason]++;
 		#ifdef debug_GPS_parser 
-			UART_puts("\r\nInvalid GPS data received (status N). Skipping sample.\r\n");
+			UART_puts("\r\nGPS sample rejected: "); UART_puts(reject_names[reason]);
 		#endif
+		return;
 	}
+	survey.last_time = fix_localcopy.time;
 
-	if(samplecount < samples_size && gnrmc_localcopy.status == 'A') // Check if we have space for more samples and if data is valid
+	if (survey.accepted == 0) // first fix: origin of the local frame
 	{
-		GPS_samples[samplecount].latitude = convert_decimal_degrees(gnrmc_localcopy.latitude, &gnrmc_localcopy.NS_ind);
-		GPS_samples[samplecount].longitude = convert_decimal_degrees(gnrmc_localcopy.longitude, &gnrmc_localcopy.EW_ind);
+		survey.first_time = fix_localcopy.time;
+		GPS_decimal_degrees_t origin = { fix_localcopy.latitude, fix_localcopy.longitude, fix_localcopy.altitude };
+		GPS_enu_init(&survey.frame, origin);
+	}
 
+	// residual to the current mean, in m
+	GPS_enu(&survey.frame, fix_localcopy.latitude, fix_localcopy.longitude, fix_localcopy.altitude, &fe, &fn, &fu);
+	dn = fn - survey.n;
+	de = fe - survey.e;
 
-		// Print the saved GPS sample to UART
-		UART_puts("\r\nGPS sample added: ");
-		UART_putint(samplecount);
-		UART_puts("	Lat: ");
-		snprintf(savedLatitude, sizeof(savedLatitude),"%.6f", GPS_samples[samplecount].latitude);
-		UART_puts(savedLatitude);
+	if (survey.accepted >= SURVEY_WARMUP)
+	{
+		r = sqrtf(dn * dn + de * de);
+		s = survey_sigma();
+		if (s < SURVEY_SIGMA_FLOOR)
+			s = SURVEY_SIGMA_FLOOR;
 
-		UART_puts(" Long: ");
-		snprintf(savedLongitude, sizeof(savedLongitude),"%.6f", GPS_samples[samplecount].longitude);
-		UART_puts(savedLongitude);
+		if (r > SURVEY_GATE_K * s)
+		{
+			survey.rejected[eREJ_OUTLIER]++;
+			return;
+		}
+		if (r > SURVEY_HUBER_K * s)
+		{
+			w *= SURVEY_HUBER_K * s / r; // Huber: influence limited to k*sigma
+			survey.downweighted++;
+		}
+	}
 
-		samplecount++;
+	// incremental weighted mean and variance
+	survey.sw  += w;
+	survey.sw2 += w * w;
+	new_n = survey.n + dn * w / survey.sw;
+	new_e = survey.e + de * w / survey.sw;
+	survey.S  += w * (dn * (survey.n + dn - new_n) + de * (survey.e + de - new_e));
+	survey.n   = new_n;
+	survey.e   = new_e;
+	survey.accepted++;
+
+	if (!isnan(fu)) // altitude: same weight, no outlier test of its own
+	{
+		survey.swu += w;
+		survey.u   += (fu - survey.u) * w / survey.swu;
 	}
-	else if (samplecount >= samples_size) // If we have enough samples, calculate the average
+
+	// Print the sample to UART
+	UART_puts("\r\nGPS sample added: ");
+	UART_putint(survey.accepted);
+	UART_puts("	Lat: ");
+	fmt_double(savedLatitude, fix_localcopy.latitude, 6, 0);
+	UART_puts(savedLatitude);
+
+	UART_puts(" Long: ");
+	fmt_double(savedLongitude, fix_localcopy.longitude, 6, 0);
+	UART_puts(savedLongitude);
+
+	if (survey.accepted >= 2)
 	{
-		GPS_average_pos.latitude = calc_average(GPS_samples, samplecount, 'L');
-		GPS_average_pos.longitude = calc_average(GPS_samples, samplecount, 'G');
-
-		// Print the average GPS position to UART
-		UART_puts("\r\nAverage GPS position: ");
-		UART_puts("Lat: ");
-		snprintf(savedLatitude, sizeof(savedLatitude),"%.6f", GPS_average_pos.latitude);
-		UART_puts(savedLatitude);
-
-		UART_puts(" Long: ");
-		snprintf(savedLongitude, sizeof(savedLongitude),"%.6f", GPS_average_pos.longitude);
-		UART_puts(savedLongitude);
-
-		// Reset sample count for next averaging
-		samplecount = 0;
-		enable_gpsaveraging = 0; // Disable GPS averaging after one complete average
+		UART_puts(" std error mm: ");
+		UART_putint(survey_stderr_mm());
 	}
+
+	if (survey.accepted < cfg.survey.min_samples ||
+	   (survey.accepted < cfg.survey.max_samples && survey_stderr_mm() > cfg.survey.target_mm))
+		return;
+
+	// Accurate enough: the mean becomes the reference position
+	GPS_average_pos.latitude  = survey.frame.ref.latitude  + (double)(survey.n / survey.frame.m_per_deg_lat);
+	GPS_average_pos.longitude = survey.frame.ref.longitude + (double)(survey.e / survey.frame.m_per_deg_lon);
+	GPS_average_pos.altitude  = (survey.swu > 0.0f && !isnan(survey.frame.ref.altitude) ?
+	                             survey.frame.ref.altitude + survey.u : NAN);
+
+	// Print the average GPS position to UART
+	UART_puts("\r\nAverage GPS position: ");
+	UART_puts("Lat: ");
+	fmt_double(savedLatitude, GPS_average_pos.latitude, 6, 0);
+	UART_puts(savedLatitude);
+
+	UART_puts(" Long: ");
+	fmt_double(savedLongitude, GPS_average_pos.longitude, 6, 0);
+	UART_puts(savedLongitude);
+	survey_report();
+
+	survey_reset();
+
+	// The average becomes the reference; errorcalc does not run during survey-in
+	GPS_Errorcalc_setReference(GPS_average_pos);
+	GPS_mode_event(eEV_SURVEY_DONE);
 }
 
+/**
+ * @brief Calculates the scale factors of a local ENU frame around ref, on the WGS84
+ * ellipsoid. This is the only place with trig; call it when the reference changes.
+ * @param enu The frame
+ * @param ref Origin of the frame
+ */
+void GPS_enu_init(GPS_ENU_REF *enu, GPS_decimal_degrees_t ref)
+{
+	const double a  = 6378137.0;          // WGS84 semi-major axis, m
+	const double e2 = 6.69437999014e-3;   // WGS84 first eccentricity squared
+	double lat = ref.latitude * M_PI / 180.0;
+	double s   = sin(lat);
+	double w   = sqrt(1.0 - e2 * s * s);
+	double h   = (isnan(ref.altitude) ? 0.0 : ref.altitude); // geoid separation is negligible here
+
+	enu->ref = ref;
+	enu->m_per_deg_lat = (float)((a * (1.0 - e2) / (w * w * w) + h) * M_PI / 180.0); // meridional radius M
+	enu->m_per_deg_lon = (float)((a / w + h) * cos(lat) * M_PI / 180.0);             // prime vertical N
+}
+
+
+/**
+ * @brief Converts a position to east/north/up metres in the frame. Up is NAN if the
+ * altitude of the position or of the reference is unknown.
+ * @note Only the offset from the reference is double (one soft-float subtract per axis,
+ * exact); it is scaled in float32 on the FPU.
+ */
+void GPS_enu(const GPS_ENU_REF *enu, double latitude, double longitude, float altitude,
+             float *e, float *n, float *u)
+{
+	*e = (float)(longitude - enu->ref.longitude) * enu->m_per_deg_lon;
+	*n = (float)(latitude  - enu->ref.latitude)  * enu->m_per_deg_lat;
+	*u = altitude - enu->ref.altitude; // NAN propagates
+}
+
+
 /**
  * @brief Converts NMEA coordinate format (ddmm.mmmm) to decimal degrees. (+ for N/E, - for S/W)
  * 
@@ -118,50 +374,36 @@ double convert_decimal_degrees(char *nmea_coordinate, char* ns)
 
 
 /**
- * @brief Calculates the average of an array of GPS samples for either latitude or longitude.
- * 
- * @param samples Array of GPS samples of type GPS_decimal_degrees_t
- * @param count Number of samples in the array
- * @param coord 'L' for latitude, 'G' for longitude
- * @return Average value as double
+ * @brief Task that feeds the averaging. Blocks on its notification value until
+ * fill_GNRMC() signals a new fix or the mode changes; fixes are only forwarded
+ * during survey-in, so the task does not wake up at all in the other modes.
  */
-double calc_average(GPS_decimal_degrees_t *samples, int count, char coord)
-{
-	double sum = 0.0;
-
-	for (int i = 0; i < count; i++)
-	{
-		if (coord == 'L') // Latitude
-		{
-			sum += samples[i].latitude;
-		}
-		else if (coord == 'G') // Longitude
-		{
-			sum += samples[i].longitude;
-		}
-	}
-
-	return sum / count; // Return the average
-}
-
 void GPS_parser(void *argument)
 {
+	uint32_t events;
+
 	osDelay(100);
 
+	sub = GPS_bus_subscribe(GPS_MODES(eMODE_SURVEY_IN));
+
 	UART_puts((char *)__func__); UART_puts(" started\r\n");
 
 	while (TRUE)
 	{
+		xTaskNotifyWait(0x00,       // don't clear any bits on entry
+		                0xffffffff, // clear all bits on exit
+		                &events,
+		                portMAX_DELAY);
 
-		// Wait for notification from fill_gnrmc that new data is available
-		ulTaskNotifyTake(pdTRUE, portMAX_DELAY); 
+		if ((events & GPS_NOTIFY_MODE) && GPS_mode_get() != eMODE_SURVEY_IN && survey.accepted)
+		{
+			UART_puts("\r\nSurvey-in aborted");
+			survey_report();
+			survey_reset(); // start over next time
+		}
 
-		// Check if GPSdata mutex is available
-		
 		// Add a GPS sample to the averaging function
-		if(enable_gpsaveraging == 1){add_GPS_sample();}
-
- 		osDelay(1); //Function runs every second, as GPS data is updated every second
+		if ((events & GPS_NOTIFY_FIX) && GPS_mode_get() == eMODE_SURVEY_IN)
+			add_GPS_sample();
 	}
 }
-
@@ -14,8 +14,41 @@
 typedef struct {
 	double latitude;    // Latitude in decimal degrees
 	double longitude;   // Longitude in decimal degrees
+	float  altitude;    // m above mean sea level, NAN if unknown
 } GPS_decimal_degrees_t, *PGPS_decimal_degrees_t;
 
+/**
+ * @brief Local east/north/up frame around a reference position. The scale factors are
+ * calculated once (GPS_enu_init), so converting a position costs two multiplies, no trig.
+ * Positions stay double (float32 resolves only ~0.5 m at 52 degrees); the offset from the
+ * reference is small, so it and everything after it is float32 on the FPU: at 10 km from
+ * the reference the rounding is below 1 mm.
+ */
+typedef struct {
+	GPS_decimal_degrees_t ref;
+	float m_per_deg_lat;  // meridional radius of curvature, per degree
+	float m_per_deg_lon;  // prime-vertical radius * cos(lat), per degree
+} GPS_ENU_REF;
+
+/// survey-in thresholds, part of the stored configuration (cfg.survey, console: set survey.*)
+typedef struct
+{
+	uint32_t min_samples; // never finish before this many accepted fixes
+	uint32_t max_samples; // finish at the latest here
+	uint32_t target_mm;   // finish when the standard error of the mean is below this
+	float    max_hdop;    // worse fixes are rejected
+	uint32_t decorr_s;    // fixes within this many s count as one for the standard error, 0: independent
+} SURVEY_CFG;
+
+/// defaults: at least 30 fixes, at most 200 (at 1 Hz a bit over 3 minutes), 300 mm, HDOP 5;
+/// the position error of a standalone receiver is correlated over tens of seconds, so
+/// 1 Hz fixes give one independent sample per 30 s
+#define SURVEY_CFG_DEFAULTS { 30, 200, 300, 5.0f, 30 }
+
 extern double convert_decimal_degrees(char *nmea_coordinate, char* ns);
+extern uint32_t GPS_survey_progress(void);
+extern void   GPS_enu_init(GPS_ENU_REF *enu, GPS_decimal_degrees_t ref);
+extern void   GPS_enu     (const GPS_ENU_REF *enu, double latitude, double longitude, float altitude,
+                           float *e, float *n, float *u);
 
 #endif /* MYAPP_APP_GPS_PARSER_H_ */
@@ -0,0 +1,119 @@
+/*
+ * GPS_usb.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * USB GNSS receiver, see GPS_usb.h. Runs in the USB host task (usbh_core.c): the
+ * class library calls USBH_CDC_ReceiveCallback() when a bulk-IN transfer ends, on a
+ * short packet or a full buffer. Two buffers alternate: the next transfer is armed
+ * on the other buffer before the filled one goes through the framer, so the library
+ * never writes into a buffer that is still being read.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "usbh_cdc.h"
+#include "GPS_usb.h"
+
+static uint8_t           rx_buf[2][GPS_USB_RXBUF];
+static uint32_t          rx_cur;           // buffer of the running transfer
+static volatile int      usb_active = FALSE;
+static volatile uint32_t usb_connects, usb_transfers, usb_bytes, usb_errors;
+static uint16_t          usb_vid, usb_pid; // last receiver
+
+
+/**
+ * @brief Arms a bulk-IN transfer into the current buffer.
+ */
+static void usb_receive(USBH_HandleTypeDef *phost)
+{
+	if (USBH_CDC_Receive(phost, rx_buf[rx_cur], GPS_USB_RXBUF) != USBH_OK)
+		usb_errors++;
+}
+
+
+/**
+ * @brief Called from USBH_UserProcess() for every host event: starts reading when a
+ * CDC device is enumerated and falls back to UART4 when it is unplugged.
+ * @param phost The host handle
+ * @param id HOST_USER_* event
+ */
+void GPS_usb_event(USBH_HandleTypeDef *phost, uint8_t id)
+{
+	switch (id)
+	{
+	case HOST_USER_CLASS_ACTIVE:
+		if (phost->pActiveClass != USBH_CDC_CLASS) // a stick for the logger (logdisk_fatfs.c)
+			break;
+		usb_vid = phost->device.DevDesc.idVendor;
+		usb_pid = phost->device.DevDesc.idProduct;
+		usb_connects++;
+		rx_cur     = 0;
+		usb_active = TRUE;
+		GPS_rx_select(TRUE);
+		usb_receive(phost);
+		UART_puts("\r\nGPS: USB receiver ");
+		UART_putnum(usb_vid, 16); UART_puts(":"); UART_putnum(usb_pid, 16);
+		UART_puts(" connected, UART4 ignored\r\n");
+		break;
+
+	case HOST_USER_DISCONNECTION:
+		if (!usb_active)
+			break;
+		usb_active = FALSE;
+		GPS_rx_select(FALSE);
+		UART_puts("\r\nGPS: USB receiver disconnected, back to UART4\r\n");
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+/**
+ * @brief Overrides the weak callback of usbh_cdc.c: a bulk-IN transfer is done. The
+ * library advances pRxData per full packet, so the length is that offset plus the
+ * size of the last packet.
+ */
+void USBH_CDC_ReceiveCallback(USBH_HandleTypeDef *phost)
+{
+	CDC_HandleTypeDef *cdc    = (CDC_HandleTypeDef *)phost->pActiveClass->pData;
+	uint8_t           *filled = rx_buf[rx_cur];
+	uint32_t           n;
+
+	if (!usb_active)
+		return;
+
+	n = (cdc->pRxData - filled) + USBH_CDC_GetLastReceivedDataSize(phost);
+	if (n > GPS_USB_RXBUF)
+		n = GPS_USB_RXBUF;
+
+	rx_cur ^= 1;
+	usb_receive(phost); // next transfer first
+
+	usb_transfers++;
+	usb_bytes += n;
+	GPS_rx_bytes(filled, n);
+}
+
+
+/**
+ * @brief Displays the USB receiver state and counters.
+ */
+void GPS_usb_report(void)
+{
+	UART_puts("\r\nGPS USB receiver: ");
+	if (usb_connects)
+	{
+		UART_putnum(usb_vid, 16); UART_puts(":"); UART_putnum(usb_pid, 16);
+	}
+	UART_puts(usb_active ? " active" : " not connected");
+	UART_puts("\r\n\t connects: ");  UART_putint(usb_connects);
+	UART_puts("\t transfers: ");     UART_putint(usb_transfers);
+	UART_puts("\t bytes: ");         UART_putint(usb_bytes);
+	UART_puts("\t errors: ");        UART_putint(usb_errors);
+	UART_puts("\r\n");
+}
@@ -0,0 +1,23 @@
+/*
+ * GPS_usb.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * GNSS receiver on the USB OTG FS port (USB host, CDC-ACM class), as an alternative
+ * to UART4. The bytes go through the same NMEA framer (gps.c); while a receiver is
+ * active UART4 is ignored. Plug and unplug are handled in USBH_UserProcess (usb_host.c).
+ */
+
+#ifndef MYAPP_APP_GPS_USB_H_
+#define MYAPP_APP_GPS_USB_H_
+
+#include "usbh_core.h"
+
+/// size of each of the two bulk-IN buffers; a multiple of the 64-byte packet
+#define GPS_USB_RXBUF  512
+
+extern void GPS_usb_event (USBH_HandleTypeDef *phost, uint8_t id);
+extern void GPS_usb_report(void);
+
+#endif /* MYAPP_APP_GPS_USB_H_ */
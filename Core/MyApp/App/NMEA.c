@@ -0,0 +1,216 @@
+/*
+ * NMEA.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Schema-driven NMEA decoder, see NMEA.h. The sentence is found by comparing a
+ * packed 32-bit key with the (small) table, then a single pass over the fields
+ * decodes only the fields in the schema; empty fields are kept in place (no strtok)
+ * and left 0. No atof(): the numbers are parsed with integer arithmetic.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "NMEA.h"
+
+/// packed key: talker system letter + 3 type chars; all GNSS talkers start with 'G'
+#define NMEA_KEY(t, c1, c2, c3) (((uint32_t)(t) << 24) | ((uint32_t)(c1) << 16) | ((uint32_t)(c2) << 8) | (uint32_t)(c3))
+#define NMEA_ANY_TALKER(t)      ((t) == '*')
+
+typedef struct
+{
+	uint8_t  index;   // field number after the tag
+	uint8_t  kind;    // NMEA_KIND
+	uint16_t offset;  // offset of the member in the sentence struct
+} NMEA_FIELD;
+
+typedef struct
+{
+	uint32_t          key;
+	uint32_t          mask;     // 0x00ffffff if any talker is accepted
+	const NMEA_FIELD *fields;
+	uint8_t           nfields;
+	NMEA_ID           id;
+} NMEA_SCHEMA;
+
+/// field descriptor tables: fields_RMC[], fields_GGA[], ...
+#define NMEA_DESC(S, idx, kind, m) { idx, eNMEA_##kind, offsetof(S, m) },
+#define NMEA_DESCS(type, t, c1, c2, c3) static const NMEA_FIELD fields_##type[] = { NMEA_FIELDS_##type(NMEA_DESC, NMEA_##type) };
+NMEA_SENTENCES(NMEA_DESCS)
+
+/// the dispatch table
+#define NMEA_ROW(type, t, c1, c2, c3) \
+	{ NMEA_KEY(NMEA_ANY_TALKER(t) ? 0 : (t), c1, c2, c3), NMEA_ANY_TALKER(t) ? 0x00ffffffUL : 0xffffffffUL, \
+	  fields_##type, sizeof(fields_##type) / sizeof(NMEA_FIELD), eNMEA_##type },
+static const NMEA_SCHEMA schema[] = { NMEA_SENTENCES(NMEA_ROW) };
+
+static const float pow10f_table[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f };
+
+
+/**
+ * @brief Finds the schema of a sentence from its tag ("$GNRMC").
+ * @param sentence At least the first 6 chars of the sentence
+ * @return The schema entry, NULL if the sentence is not in the schema
+ */
+static const NMEA_SCHEMA *NMEA_find(const char *sentence)
+{
+	uint32_t key;
+	int      i;
+
+	if (sentence[0] != '$' || sentence[1] != 'G')
+		return NULL;
+
+	key = NMEA_KEY(sentence[2], sentence[3], sentence[4], sentence[5]);
+
+	for (i = 0; i < (int)(sizeof(schema) / sizeof(schema[0])); i++)
+		if ((key & schema[i].mask) == schema[i].key)
+			return &schema[i];
+	return NULL;
+}
+
+
+/**
+ * @brief Returns the id of a sentence from its tag, cheap enough for the UART ISR.
+ */
+NMEA_ID NMEA_lookup(const char *sentence)
+{
+	const NMEA_SCHEMA *s = NMEA_find(sentence);
+
+	return (s ? s->id : eNMEA_NONE);
+}
+
+
+/**
+ * @brief Parses [p, end) as an unsigned integer; *ndigits returns the number of digits.
+ */
+static uint32_t NMEA_uint(const char **p, const char *end, int *ndigits)
+{
+	uint32_t v = 0;
+	int      n = 0;
+
+	while (*p < end && **p >= '0' && **p <= '9')
+	{
+		if (n < 9) // more digits than fit in 32 bits are ignored
+		{
+			v = v * 10 + (**p - '0');
+			n++;
+		}
+		(*p)++;
+	}
+	if (ndigits)
+		*ndigits = n;
+	return v;
+}
+
+
+/**
+ * @brief Decodes one field into its member.
+ * @param f Field descriptor
+ * @param p First char of the field
+ * @param end The ',' or '\0' after the field
+ * @param dest Start of the sentence struct
+ */
+static void NMEA_field(const NMEA_FIELD *f, const char *p, const char *end, uint8_t *dest)
+{
+	uint32_t ip, fp;
+	int      neg = 0, n;
+
+	dest += f->offset;
+
+	if (p == end && f->kind != eNMEA_HEMI) // empty field: member stays 0
+		return;
+
+	switch (f->kind)
+	{
+	case eNMEA_CHAR:
+		*(char *)dest = *p;
+		break;
+
+	case eNMEA_INT:
+		if (*p == '-') { neg = 1; p++; }
+		ip = NMEA_uint(&p, end, NULL);
+		*(int32_t *)dest = (neg ? -(int32_t)ip : (int32_t)ip);
+		break;
+
+	case eNMEA_FLOAT:
+		if (*p == '-') { neg = 1; p++; }
+		ip = NMEA_uint(&p, end, NULL);
+		fp = 0; n = 0;
+		if (p < end && *p == '.')
+		{
+			p++;
+			fp = NMEA_uint(&p, end, &n);
+		}
+		*(float *)dest = (neg ? -1.0f : 1.0f) * ((float)ip + (float)fp / pow10f_table[n]);
+		break;
+
+	case eNMEA_DEG: // (d)ddmm.mmmm: degrees are the digits before the last two integer digits
+		ip = NMEA_uint(&p, end, NULL);
+		fp = 0; n = 0;
+		if (p < end && *p == '.')
+		{
+			p++;
+			fp = NMEA_uint(&p, end, &n);
+		}
+		*(double *)dest = (double)(ip / 100) +
+		                  ((double)(ip % 100) + (double)fp / (double)pow10f_table[n]) / 60.0;
+		break;
+
+	case eNMEA_HEMI:
+		if (p < end && (*p == 'S' || *p == 'W'))
+			*(double *)dest = -*(double *)dest;
+		break;
+
+	case eNMEA_TIME: // hhmmss.sss
+		ip = NMEA_uint(&p, end, NULL);
+		fp = 0; n = 0;
+		if (p < end && *p == '.')
+		{
+			p++;
+			fp = NMEA_uint(&p, end, &n);
+		}
+		while (n < 3) { fp *= 10; n++; } // to ms
+		while (n > 3) { fp /= 10; n--; }
+		*(uint32_t *)dest = ((ip / 10000) * 3600 + (ip / 100 % 100) * 60 + ip % 100) * 1000 + fp;
+		break;
+	}
+}
+
+
+/**
+ * @brief Decodes a sentence with its schema, in one pass over the fields.
+ * @param sentence The sentence from '$', checksum already removed, '\0'-terminated
+ * @param msg Destination; all members not present in the sentence are 0
+ * @return The sentence id, eNMEA_NONE if the sentence is not in the schema
+ */
+NMEA_ID NMEA_decode(const char *sentence, NMEA_MSG *msg)
+{
+	const NMEA_SCHEMA *s;
+	const char        *p, *end;
+	int                index = 0, f = 0;
+
+	if (!(s = NMEA_find(sentence)))
+		return eNMEA_NONE;
+
+	memset(msg, 0, sizeof(NMEA_MSG));
+	msg->id     = s->id;
+	msg->talker = sentence[2];
+
+	p = sentence;
+	while (f < s->nfields)
+	{
+		// p points at the start of field 'index' (field 0 is the tag)
+		for (end = p; *end && *end != ','; end++)
+			;
+
+		while (f < s->nfields && s->fields[f].index == index)
+			NMEA_field(&s->fields[f++], p, end, (uint8_t *)&msg->u);
+
+		if (!*end) // sentence shorter than the schema: the rest stays 0
+			break;
+		p = end + 1;
+		index++;
+	}
+	return s->id;
+}
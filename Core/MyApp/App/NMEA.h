@@ -0,0 +1,143 @@
+/*
+ * NMEA.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Declarative NMEA schema. Every sentence is one row in NMEA_SENTENCES and one
+ * field list NMEA_FIELDS_<type>; the decoded structs, the sentence ids and the
+ * field descriptor tables (NMEA.c) are all generated from these X-macros.
+ * Adding a sentence type = adding a row and a field list.
+ */
+
+#ifndef MYAPP_APP_NMEA_H_
+#define MYAPP_APP_NMEA_H_
+
+#include <stdint.h>
+
+/**
+ * Sentences: S(type, talker, c1, c2, c3)
+ * talker is the system letter after the 'G' (P=GPS, L=GLONASS, A=Galileo, B=BeiDou,
+ * N=combined), or '*' for any. GSV is sent per system, so it always uses '*'.
+ */
+#define NMEA_SENTENCES(S) \
+	S(RMC, '*', 'R','M','C') \
+	S(GGA, '*', 'G','G','A') \
+	S(GSA, '*', 'G','S','A') \
+	S(GSV, '*', 'G','S','V') \
+	S(VTG, '*', 'V','T','G') \
+	S(GST, '*', 'G','S','T')
+
+/**
+ * Fields: F(struct, index, kind, member), index 1 is the first field after the tag.
+ * Fields must be in ascending index order. HEMI (N/S, E/W) negates the DEG member it names.
+ */
+#define NMEA_FIELDS_RMC(F, S) \
+	F(S,  1, TIME,  time)      /* hhmmss.sss */                 \
+	F(S,  2, CHAR,  status)    /* A=valid, V=not valid */       \
+	F(S,  3, DEG,   latitude)  /* ddmm.mmmm */                  \
+	F(S,  4, HEMI,  latitude)  /* N/S */                        \
+	F(S,  5, DEG,   longitude) /* dddmm.mmmm */                 \
+	F(S,  6, HEMI,  longitude) /* E/W */                        \
+	F(S,  7, FLOAT, speed)     /* knots */                      \
+	F(S,  8, FLOAT, course)    /* degrees */                    \
+	F(S,  9, INT,   date)      /* ddmmyy */                     \
+	F(S, 12, CHAR,  mode)      /* A=autonomous, D=differential, N=no fix */
+
+#define NMEA_FIELDS_GGA(F, S) \
+	F(S,  1, TIME,  time)                                       \
+	F(S,  2, DEG,   latitude)                                   \
+	F(S,  3, HEMI,  latitude)                                   \
+	F(S,  4, DEG,   longitude)                                  \
+	F(S,  5, HEMI,  longitude)                                  \
+	F(S,  6, INT,   quality)   /* 0=no fix, 1=GPS, 2=DGPS */    \
+	F(S,  7, INT,   numsv)     /* satellites used */            \
+	F(S,  8, FLOAT, hdop)                                       \
+	F(S,  9, FLOAT, altitude)  /* m above mean sea level */     \
+	F(S, 11, FLOAT, geoid_sep) /* m */
+
+#define NMEA_FIELDS_GSA(F, S) \
+	F(S,  1, CHAR,  opmode)    /* M=manual, A=automatic */      \
+	F(S,  2, INT,   navmode)   /* 1=no fix, 2=2D, 3=3D */       \
+	F(S, 15, FLOAT, pdop)                                       \
+	F(S, 16, FLOAT, hdop)                                       \
+	F(S, 17, FLOAT, vdop)
+
+#define NMEA_FIELDS_GSV(F, S) \
+	F(S,  1, INT,   nummsg)                                     \
+	F(S,  2, INT,   msgnum)                                     \
+	F(S,  3, INT,   numsv)     /* satellites in view */         \
+	F(S,  4, INT,   sv1)                                        \
+	F(S,  7, INT,   cno1)      /* dBHz */                       \
+	F(S,  8, INT,   sv2)                                        \
+	F(S, 11, INT,   cno2)                                       \
+	F(S, 12, INT,   sv3)                                        \
+	F(S, 15, INT,   cno3)                                       \
+	F(S, 16, INT,   sv4)                                        \
+	F(S, 19, INT,   cno4)
+
+#define NMEA_FIELDS_VTG(F, S) \
+	F(S,  1, FLOAT, course_true)                                \
+	F(S,  3, FLOAT, course_mag)                                 \
+	F(S,  5, FLOAT, speed_kn)                                   \
+	F(S,  7, FLOAT, speed_kmh)                                  \
+	F(S,  9, CHAR,  mode)
+
+#define NMEA_FIELDS_GST(F, S) \
+	F(S,  1, TIME,  time)                                       \
+	F(S,  2, FLOAT, rms)       /* m, pseudorange residuals */   \
+	F(S,  3, FLOAT, std_major) /* m, error ellipse */           \
+	F(S,  4, FLOAT, std_minor)                                  \
+	F(S,  5, FLOAT, orient)    /* degrees */                    \
+	F(S,  6, FLOAT, std_lat)   /* m */                          \
+	F(S,  7, FLOAT, std_lon)   /* m */                          \
+	F(S,  8, FLOAT, std_alt)   /* m */
+
+/// field kinds and the C type of their destination member
+typedef enum
+{
+	eNMEA_CHAR = 0,
+	eNMEA_INT,
+	eNMEA_FLOAT,
+	eNMEA_DEG,
+	eNMEA_HEMI,
+	eNMEA_TIME
+} NMEA_KIND;
+
+#define NMEA_MEMBER_CHAR(m)  char     m;
+#define NMEA_MEMBER_INT(m)   int32_t  m;
+#define NMEA_MEMBER_FLOAT(m) float    m;
+#define NMEA_MEMBER_DEG(m)   double   m; // decimal degrees
+#define NMEA_MEMBER_HEMI(m)              // sign of a DEG member
+#define NMEA_MEMBER_TIME(m)  uint32_t m; // ms since midnight (UTC)
+#define NMEA_MEMBER(S, idx, kind, m) NMEA_MEMBER_##kind(m)
+
+/// one struct per sentence: NMEA_RMC, NMEA_GGA, ...
+#define NMEA_STRUCT(type, t, c1, c2, c3) typedef struct { NMEA_FIELDS_##type(NMEA_MEMBER, NMEA_##type) } NMEA_##type;
+NMEA_SENTENCES(NMEA_STRUCT)
+
+/// sentence ids: eNMEA_RMC, eNMEA_GGA, ...; 0 = not in the schema
+#define NMEA_ENUM(type, t, c1, c2, c3) eNMEA_##type,
+typedef enum
+{
+	eNMEA_NONE = 0,
+	NMEA_SENTENCES(NMEA_ENUM)
+	eNMEA_COUNT
+} NMEA_ID;
+
+/// a decoded sentence
+#define NMEA_UNION(type, t, c1, c2, c3) NMEA_##type type;
+typedef struct
+{
+	NMEA_ID id;
+	char    talker;   // system letter, see NMEA_SENTENCES
+	union
+	{
+		NMEA_SENTENCES(NMEA_UNION)
+	} u;
+} NMEA_MSG;
+
+extern NMEA_ID NMEA_lookup(const char *sentence);
+extern NMEA_ID NMEA_decode(const char *sentence, NMEA_MSG *msg);
+
+#endif /* MYAPP_APP_NMEA_H_ */
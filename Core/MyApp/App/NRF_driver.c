@@ -16,22 +16,51 @@
 #include "stm32f4xx_hal.h"
 #include "NRF24_conf.h"
 #include "GPS_parser.h"
+#include "NRF_power.h"
+#include "telemetry.h"
+#include "config.h"
+#include "supervisor.h"
+#include "logger.h"
+#include "seqbuf.h"
 
-#define PLD_SIZE 32 // Payload size in bytes
 uint8_t txBuffer[PLD_SIZE] = {"Hello"}; // Transmission buffer test
 uint8_t ack[PLD_SIZE]; // Acknowledgment buffer
 uint8_t status = 1;
 
 extern SPI_HandleTypeDef hspiX;
 
-GPS_decimal_degrees_t errorBuffer = {0, 0}; // Struct to hold the GPS error to be transmitted
+/// A correction as handed over by GPS_Errorcalc, with its tlm_stamp()
+typedef struct
+{
+    NRF_CORRECTION corr;
+    uint32_t       stamp;
+} NRF_PENDING;
+
+// GPS_Errorcalc publishes, the (higher-priority) NRF task copies: no torn corrections
+static NRF_PENDING pending_slots[SEQBUF_SLOTS];
+static SEQBUF      pending_buf = SEQBUF_INIT(pending_slots);
+
+NRF_CORRECTION errorBuffer; // Struct to hold the correction being transmitted, NRF task only
+static uint32_t errorStamp; // tlm_stamp() when the correction was set
+
+static volatile uint8_t radioChanged; // cfg.radio changed, apply before the next transmission
 
 void NRF_transmitGPS(){
-    memset(txBuffer, 0, PLD_SIZE);
+    NRF_PENDING next;
+
+    if (!seqbuf_read(&pending_buf, &next))
+        return; // no correction set yet
+    errorBuffer = next.corr;
+    errorStamp  = next.stamp;
     memcpy(txBuffer, &errorBuffer, sizeof(errorBuffer));
 
     HAL_GPIO_WritePin(GPIOD, LEDBLUE, GPIO_PIN_SET); // Turn on LED
     status = nrf24_transmit(txBuffer, sizeof(txBuffer)); // Transmit data
+    LOG_correction(&errorBuffer, status);
+
+    TLM_RADIO_REC radio = { .seq = errorBuffer.seq, .status = status };
+    tlm_latency(TLM_PROBE_CORR_TO_TX, errorStamp);
+    tlm_send(TLM_RADIO, &radio, sizeof(radio));
     LCD_clear();
     LCD_puts("Sent packet. TX status: ");
     char fail[] = "Failed";
@@ -41,8 +70,28 @@ void NRF_transmitGPS(){
     HAL_GPIO_WritePin(GPIOD, LEDBLUE, GPIO_PIN_RESET); // Turn off LED
 }
 
-void NRF_setErrorBuffer(GPS_decimal_degrees_t error) {
-    errorBuffer = error;
+/**
+ * @brief Requests the NRF task to apply cfg.radio. The SPI bus belongs to the NRF task,
+ * so the console never writes the radio registers itself.
+ */
+void NRF_setRadio(void) {
+    radioChanged = TRUE;
+}
+
+static void NRF_applyRadio(void) {
+    radioChanged = FALSE;
+    nrf24_tx_pwr(cfg.radio.power);
+    nrf24_data_rate(cfg.radio.rate);
+    nrf24_set_channel(cfg.radio.channel);
+    nrf24_open_tx_pipe((uint8_t *)cfg.radio.addr);
+}
+
+void NRF_setCorrection(const NRF_CORRECTION *correction) {
+    NRF_PENDING *slot = seqbuf_begin(&pending_buf);
+
+    slot->corr  = *correction;
+    slot->stamp = tlm_stamp();
+    seqbuf_commit(&pending_buf);
 }
 
 uint8_t nrf24_SPI_commscheck(void) {
@@ -66,26 +115,48 @@ void NRF_Driver(void *argument)
     osDelay(100);
 
     UART_puts((char *)__func__); UART_puts(" started\r\n");
-    uint8_t addr[5] = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7};
     HAL_GPIO_WritePin(ce_gpio_port, ce_gpio_pin, 0); // Set CE low
     HAL_GPIO_WritePin(csn_gpio_port, csn_gpio_pin, 1); // Set CSN high
 
 
     nrf24_init(); // Initialize NRF24L01+
-    nrf24_tx_pwr(3); // Set transmission power to maximum
-    nrf24_data_rate(0); // Set data rate to 1Mbps
-    nrf24_set_channel(78); // Set channel to 76
     nrf24_pipe_pld_size(0, PLD_SIZE); // Set payload size for pipe 0
     nrf24_set_crc(en_crc, _1byte); // Enable CRC with 1 byte
 
-    nrf24_open_tx_pipe(addr); // Open TX pipe with address
+    NRF_applyRadio(); // Power, data rate, channel and TX address from the stored configuration
+
+    NRF_power_init(); // Radio sleeps in power-down until the first correction
 
-    nrf24_pwr_up(); // Power up the NRF24L01+
-    
     while (TRUE)
     {
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t wait = NRF_power_slot_wait(); // ticks the radio may stay in power-down
+        uint32_t notified = 0;
+
+        SUP_alive(SUP_NRF);
+
+        if (wait)
+        {
+            NRF_power_sleep();
+            notified = ulTaskNotifyTake(pdTRUE, (wait > pdMS_TO_TICKS(SUP_BEAT_MS) ? pdMS_TO_TICKS(SUP_BEAT_MS) : wait));
+            if (!notified && wait > pdMS_TO_TICKS(SUP_BEAT_MS))
+                continue; // only the heartbeat, keep sleeping
+        }
+
+        if (!notified) // next slot is close, wake up ahead of it and wait for the correction
+        {
+            NRF_power_wake();
+            notified = ulTaskNotifyTake(pdTRUE, NRF_power_slot_guard());
+            if (!notified)
+            {
+                NRF_power_slot_missed(); // fix lost or calculation stopped, sleep until notified
+                continue;
+            }
+        }
+
+        NRF_power_wake(); // no-op if already awake, otherwise the correction waits Tpd2stby
+        if (radioChanged)
+            NRF_applyRadio();
         NRF_transmitGPS();
-        osDelay(1);
+        NRF_power_tx_done(status);
     }
 }
\ No newline at end of file
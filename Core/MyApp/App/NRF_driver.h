@@ -9,8 +9,48 @@
 #ifndef MYAPP_APP_NRF_DRIVER_H_
 #define MYAPP_APP_NRF_DRIVER_H_
 
+#define PLD_SIZE 32 // Payload size in bytes
+
+#define NRF_PKT_VERSION 3 // 1: 2 doubles in degrees, 2: floats in m, 3: integer mm ENU
+
+#define NRF_FLAG_UP_VALID 0x01 // err_u, rate_u, sd_u are valid
+
+/**
+ * @brief Correction packet, exactly one payload. The error is the smoothed error of
+ * the base (measured - reference) in a local east/north/up frame; a rover subtracts
+ * err + rate * (t_now - time). Values that do not fit are saturated.
+ */
+typedef struct __attribute__((packed))
+{
+	uint8_t  version;                // NRF_PKT_VERSION
+	uint8_t  flags;                  // NRF_FLAG_*
+	uint16_t seq;                    // packet counter
+	uint32_t time;                   // ms since midnight (UTC) the correction is valid at
+	int32_t  err_e, err_n, err_u;    // mm
+	int16_t  rate_e, rate_n, rate_u; // mm/s
+	uint16_t sd_e, sd_n, sd_u;       // mm, standard deviation of err_*
+} NRF_CORRECTION;
+
+_Static_assert(sizeof(NRF_CORRECTION) == PLD_SIZE, "correction must fill one payload");
+
+/**
+ * @brief Radio settings, part of the stored configuration (cfg.radio, console: set nrf.*).
+ * The NRF task applies them before its next transmission, see NRF_setRadio().
+ */
+typedef struct
+{
+	uint8_t channel; // 2400 + channel MHz, 0..125
+	uint8_t rate;    // enum data_rate: 0 = 1 Mbps, 1 = 2 Mbps, 2 = 250 kbps
+	uint8_t power;   // enum tx_power: 0 = -18 dBm .. 3 = 0 dBm
+	uint8_t addr[5]; // TX address
+} NRF_RADIO_CFG;
+
+/// defaults of cfg.radio (config.c): channel 78, 1 Mbps, maximum power
+#define NRF_RADIO_CFG_DEFAULTS { 78, 0, 3, { 0xE7, 0xE7, 0xE7, 0xE7, 0xE7 } }
+
 extern void NRF_Driver(void *);
 extern uint8_t nrf24_SPI_commscheck(void);
-void NRF_setErrorBuffer(GPS_decimal_degrees_t error);
+void NRF_setCorrection(const NRF_CORRECTION *correction);
+void NRF_setRadio(void);
 
 #endif
\ No newline at end of file
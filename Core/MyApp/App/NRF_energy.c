@@ -0,0 +1,97 @@
+/*
+ * NRF_energy.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Energy model of the nRF24L01+, see NRF_energy.h. The caller books every state
+ * change with its own clock; the energy per state follows from datasheet currents.
+ * Plain C on purpose: no RTOS or HAL headers, so it also builds on a Linux host.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "NRF_energy.h"
+
+// Energy model, nRF24L01+ product specification v1.0 (typical values, VDD = 3.3 V)
+#define NRF_SUPPLY_MV      3300
+#define NRF_I_PWRDWN_NA    900        // power down
+#define NRF_I_STANDBY_NA   26000      // standby-I
+#define NRF_I_STARTUP_NA   400000     // average during crystal start-up
+#define NRF_I_TX_NA        11300000   // TX at 0 dBm
+#define NRF_I_RX_NA        13500000   // RX at 1 Mbps (waiting for the ACK)
+#define NRF_T_SETTLE_US    130        // TX/RX PLL settling
+#define NRF_T_PACKET_US    321        // 1+5+32+1 bytes + 9 bits PCF at 1 Mbps
+#define NRF_T_ACK_US       65         // ACK packet without payload at 1 Mbps
+#define NRF_T_ARD_US       250        // auto retransmit delay (ARD reset value)
+#define NRF_RETRIES        3          // auto retransmit count (ARC reset value)
+
+
+/**
+ * @brief Starts an empty activity record.
+ * @param state State the radio is in now
+ * @param now_ms Caller's clock in ms
+ */
+void NRF_activity_init(NRF_ACTIVITY *a, NRF_POWERSTATE state, uint32_t now_ms)
+{
+	memset(a, 0, sizeof(*a));
+	a->state    = state;
+	a->since_ms = now_ms;
+}
+
+
+/**
+ * @brief Books the time spent in the current state and switches to the next one.
+ * Calling it with the current state only books the running interval.
+ */
+void NRF_activity_state(NRF_ACTIVITY *a, NRF_POWERSTATE next, uint32_t now_ms)
+{
+	a->state_ms[a->state] += now_ms - a->since_ms;
+	if (a->state == eNRF_PWRDWN && next == eNRF_STANDBY)
+		a->wakeups++;
+	a->since_ms = now_ms;
+	a->state    = next;
+}
+
+
+/**
+ * @brief Registers a transmitted correction.
+ * @param failed TRUE if no ACK was received
+ */
+void NRF_activity_tx(NRF_ACTIVITY *a, int failed)
+{
+	a->corrections++;
+	if (failed)
+		a->failures++;
+}
+
+
+/**
+ * @brief Energy in nJ of a current drawn for a time, at the modelled supply voltage.
+ */
+static uint64_t NRF_energy_nJ(uint64_t current_nA, uint64_t time_us)
+{
+	return ((NRF_SUPPLY_MV * current_nA) / 1000 * time_us) / 1000000; // nW * us = fJ
+}
+
+
+/**
+ * @brief Calculates the energy of an activity record, both duty-cycled and for the
+ * same time span with the radio permanently in standby-I (the behaviour before duty
+ * cycling). The running interval is not booked: call NRF_activity_state() first.
+ */
+void NRF_energy(const NRF_ACTIVITY *a, NRF_ENERGY *e)
+{
+	uint64_t total_ms = a->state_ms[eNRF_PWRDWN] + a->state_ms[eNRF_STANDBY];
+	uint64_t attempts = a->corrections + (uint64_t)a->failures * NRF_RETRIES; // a failure used all retransmits
+
+	e->tx_nJ = attempts * (NRF_energy_nJ(NRF_I_TX_NA, NRF_T_SETTLE_US + NRF_T_PACKET_US) +
+			               NRF_energy_nJ(NRF_I_RX_NA, NRF_T_SETTLE_US + NRF_T_ACK_US)) +
+			   (uint64_t)a->failures * NRF_RETRIES * NRF_energy_nJ(NRF_I_STANDBY_NA, NRF_T_ARD_US);
+
+	e->duty_nJ = NRF_energy_nJ(NRF_I_PWRDWN_NA,  a->state_ms[eNRF_PWRDWN]  * 1000) +
+			     NRF_energy_nJ(NRF_I_STANDBY_NA, a->state_ms[eNRF_STANDBY] * 1000) +
+			     a->wakeups * NRF_energy_nJ(NRF_I_STARTUP_NA, NRF_TPD2STBY_US) + e->tx_nJ;
+
+	e->standby_nJ = NRF_energy_nJ(NRF_I_STANDBY_NA, total_ms * 1000) + e->tx_nJ;
+}
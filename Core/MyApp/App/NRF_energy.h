@@ -0,0 +1,52 @@
+/*
+ * NRF_energy.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * State-duration and energy model of the nRF24L01+ (NRF_energy.c). Plain C without
+ * RTOS or HAL headers: NRF_power.c feeds it from the tick count, the host test
+ * Tools/hosttest/nrf_energy_test from a simulated slot timeline.
+ */
+
+#ifndef MYAPP_APP_NRF_ENERGY_H_
+#define MYAPP_APP_NRF_ENERGY_H_
+
+#include <stdint.h>
+
+/// nRF24L01+ power-down -> standby-I start-up time (Tpd2stby, datasheet: 1.5 ms)
+#define NRF_TPD2STBY_US    1500
+
+/// Radio power states used by the energy model
+typedef enum
+{
+	eNRF_PWRDWN = 0,	// power down, registers kept
+	eNRF_STANDBY,		// standby-I, crystal running
+	eNRF_STATES
+} NRF_POWERSTATE;
+
+/// What the radio did: time per state and the events that cost extra energy
+typedef struct
+{
+	NRF_POWERSTATE state;              // current state
+	uint32_t       since_ms;           // time of the last state change
+	uint64_t       state_ms[eNRF_STATES];
+	uint32_t       wakeups;            // power-down -> standby transitions
+	uint32_t       corrections;        // transmitted corrections
+	uint32_t       failures;           // corrections without ACK (MAX_RT)
+} NRF_ACTIVITY;
+
+/// Modelled energy of an activity record
+typedef struct
+{
+	uint64_t tx_nJ;                    // TX/RX bursts, the same in both configurations
+	uint64_t duty_nJ;                  // duty-cycled: power-down between slots
+	uint64_t standby_nJ;               // the same time span permanently in standby-I
+} NRF_ENERGY;
+
+extern void NRF_activity_init (NRF_ACTIVITY *a, NRF_POWERSTATE state, uint32_t now_ms);
+extern void NRF_activity_state(NRF_ACTIVITY *a, NRF_POWERSTATE next, uint32_t now_ms);
+extern void NRF_activity_tx   (NRF_ACTIVITY *a, int failed);
+extern void NRF_energy        (const NRF_ACTIVITY *a, NRF_ENERGY *e);
+
+#endif /* MYAPP_APP_NRF_ENERGY_H_ */
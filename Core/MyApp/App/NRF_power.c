@@ -0,0 +1,193 @@
+/*
+ * NRF_power.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Power manager for the nRF24L01+. The radio is kept in power-down between
+ * correction bursts and is woken NRF_WAKE_LEAD_MS before the next expected
+ * slot, so the 1.5 ms crystal start-up (Tpd2stby) is hidden from the TX path.
+ * The slot period is learned from the interval between corrections.
+ *
+ * Every state change is booked in an activity record (NRF_energy.c), so
+ * NRF_power_report() can estimate the radio energy per correction from datasheet
+ * currents and compare it with the old 'always in standby' configuration.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "NRF24.h"
+#include "NRF_power.h"
+#include "beeper.h"
+
+static NRF_ACTIVITY act;          // time per power state, wakeups, corrections
+
+static uint8_t    last_failed;   // the last correction got no ACK
+static uint32_t   missed_slots;  // woke up, but no correction arrived within the guard
+static TickType_t last_slot;     // tick of the last transmission
+static uint32_t   slot_period = NRF_SLOT_PERIOD_MS;
+static int        slot_valid = FALSE; // is the next slot predictable?
+
+
+/**
+ * @brief Books the time spent in the current state and switches to the next one.
+ * @param next New radio power state
+ */
+static void NRF_power_account(NRF_POWERSTATE next)
+{
+	taskENTER_CRITICAL(); // NRF_power_report() books from another task
+	NRF_activity_state(&act, next, xTaskGetTickCount() * portTICK_PERIOD_MS);
+	taskEXIT_CRITICAL();
+}
+
+
+/**
+ * @brief Starts the bookkeeping and puts the (already configured) radio in power-down.
+ */
+void NRF_power_init(void)
+{
+	NRF_activity_init(&act, eNRF_STANDBY, xTaskGetTickCount() * portTICK_PERIOD_MS); // nrf24_init() leaves the radio powered up
+	NRF_power_sleep();
+}
+
+
+/**
+ * @brief Powers the radio up and blocks until the crystal has started (Tpd2stby).
+ * @note No-op when the radio is already in standby.
+ */
+void NRF_power_wake(void)
+{
+	if (act.state != eNRF_PWRDWN)
+		return;
+
+	NRF_power_account(eNRF_STANDBY);
+	nrf24_pwr_up();
+
+	// +1: osDelay() may return up to one tick early
+	osDelay(pdMS_TO_TICKS((NRF_TPD2STBY_US + 999) / 1000) + 1);
+}
+
+
+/**
+ * @brief Puts the radio in power-down. Register contents are retained.
+ */
+void NRF_power_sleep(void)
+{
+	if (act.state == eNRF_PWRDWN)
+		return;
+
+	ce_low();
+	nrf24_pwr_dwn();
+	NRF_power_account(eNRF_PWRDWN);
+}
+
+
+/**
+ * @brief Returns how long the radio may stay in power-down before the next slot.
+ * @return Ticks until wake-up; 0 if the radio should be awake now, portMAX_DELAY
+ * if no slot can be predicted (no correction seen yet, or the last slot was missed).
+ */
+uint32_t NRF_power_slot_wait(void)
+{
+	TickType_t elapsed, lead;
+
+	if (!slot_valid)
+		return portMAX_DELAY;
+
+	elapsed = xTaskGetTickCount() - last_slot;
+	lead    = pdMS_TO_TICKS(slot_period - NRF_WAKE_LEAD_MS);
+
+	return (elapsed >= lead ? 0 : lead - elapsed);
+}
+
+
+/**
+ * @brief Returns how long an awake radio waits for a correction before the slot counts as missed.
+ */
+uint32_t NRF_power_slot_guard(void)
+{
+	return pdMS_TO_TICKS(NRF_WAKE_LEAD_MS + NRF_SLOT_GUARD_MS);
+}
+
+
+/**
+ * @brief No correction arrived within the guard: stop predicting slots, so the
+ * radio waits for the next correction in power-down.
+ */
+void NRF_power_slot_missed(void)
+{
+	missed_slots++;
+	slot_valid = FALSE;
+}
+
+
+/**
+ * @brief Registers a finished transmission and updates the slot prediction.
+ * @param failed Result of nrf24_transmit(), 1 if no ACK was received
+ */
+void NRF_power_tx_done(uint8_t failed)
+{
+	TickType_t now = xTaskGetTickCount();
+	uint32_t   interval = (now - last_slot) * portTICK_PERIOD_MS;
+
+	// learn the slot period, ignore gaps (fix lost, calculation disabled)
+	if (slot_valid && interval > NRF_WAKE_LEAD_MS && interval < 4 * slot_period)
+		slot_period = (3 * slot_period + interval) / 4;
+
+	last_slot  = now;
+	slot_valid = TRUE;
+	taskENTER_CRITICAL();
+	NRF_activity_tx(&act, failed);
+	taskEXIT_CRITICAL();
+	if (failed && !last_failed) // only when the link goes from acknowledged to failing
+		BEEP_play(eBEEP_RADIO_FAIL);
+	last_failed = failed;
+}
+
+
+/**
+ * @brief State of the link from the last transmission; safe from any task.
+ */
+NRF_LINK NRF_power_link(void)
+{
+	if (!act.corrections || (xTaskGetTickCount() - last_slot) * portTICK_PERIOD_MS > NRF_LINK_IDLE_MS)
+		return eNRF_LINK_IDLE;
+	return (last_failed ? eNRF_LINK_FAIL : eNRF_LINK_OK);
+}
+
+
+/**
+ * @brief Displays the modelled radio energy on the UART. The same time span is
+ * also calculated for the radio permanently in standby-I, the behaviour before
+ * duty cycling, so both configurations can be compared.
+ */
+void NRF_power_report(void)
+{
+	NRF_ACTIVITY a;
+	NRF_ENERGY   e;
+
+	taskENTER_CRITICAL();
+	NRF_activity_state(&act, act.state, xTaskGetTickCount() * portTICK_PERIOD_MS); // book the running interval
+	a = act;
+	taskEXIT_CRITICAL();
+
+	NRF_energy(&a, &e);
+
+	UART_puts("\r\nNRF power (modelled)");
+	UART_puts("\r\n\t power-down ms: "); UART_putint((unsigned int)a.state_ms[eNRF_PWRDWN]);
+	UART_puts("\t standby ms: ");        UART_putint((unsigned int)a.state_ms[eNRF_STANDBY]);
+	UART_puts("\r\n\t wakeups: ");       UART_putint(a.wakeups);
+	UART_puts("\t corrections: ");       UART_putint(a.corrections);
+	UART_puts("\t failed: ");            UART_putint(a.failures);
+	UART_puts("\t missed slots: ");      UART_putint(missed_slots);
+	UART_puts("\t slot period ms: ");    UART_putint(slot_period);
+	UART_puts("\r\n\t MCU load %: ");    UART_putint(GetCPULoad());
+
+	if (a.corrections)
+	{
+		UART_puts("\r\n\t nJ/correction duty-cycled: "); UART_putint((unsigned int)(e.duty_nJ / a.corrections));
+		UART_puts("\t always standby: ");              UART_putint((unsigned int)(e.standby_nJ / a.corrections));
+	}
+	UART_puts("\r\n");
+}
@@ -0,0 +1,42 @@
+/*
+ * NRF_power.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_NRF_POWER_H_
+#define MYAPP_APP_NRF_POWER_H_
+
+#include <stdint.h>
+#include "NRF_energy.h"
+
+/// Wake the radio this many ms before the expected slot, covers Tpd2stby plus scheduling jitter
+#define NRF_WAKE_LEAD_MS   5
+/// Default slot period until the first two corrections have been seen (GPS epoch of 1 Hz)
+#define NRF_SLOT_PERIOD_MS 1000
+/// Slot guard: how long the radio stays awake waiting for a late correction
+#define NRF_SLOT_GUARD_MS  50
+
+/// state of the radio link, for the status LEDs
+typedef enum
+{
+	eNRF_LINK_IDLE = 0,	// nothing transmitted for NRF_LINK_IDLE_MS
+	eNRF_LINK_OK,		// the last correction was acknowledged
+	eNRF_LINK_FAIL		// the last correction got no ACK (MAX_RT)
+} NRF_LINK;
+
+/// no transmission for this long counts as idle: three missed slots at 1 Hz
+#define NRF_LINK_IDLE_MS   3000
+
+extern void     NRF_power_init   (void);
+extern void     NRF_power_wake   (void);
+extern void     NRF_power_sleep  (void);
+extern uint32_t NRF_power_slot_wait(void);
+extern uint32_t NRF_power_slot_guard(void);
+extern void     NRF_power_slot_missed(void);
+extern void     NRF_power_tx_done(uint8_t failed);
+extern void     NRF_power_report (void);
+extern NRF_LINK NRF_power_link   (void);
+
+#endif /* MYAPP_APP_NRF_POWER_H_ */
@@ -0,0 +1,319 @@
+/*
+ * UART_cmds.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Table-driven console: a line is split in words (space or ','), the first word is
+ * looked up in cmd_table[] and the rest is checked against the argument schema of
+ * the command before its handler runs. Parameters in param_table[] can be read and
+ * changed at runtime with get/set.
+ *
+ * Machine mode ("machine 1") is meant for a test rig: every command ends with exactly
+ * one status line, "OK <cmd>" or "ERR <cmd> <code> <reason>"; values are printed as
+ * "name=value". A line may start with a tag, "#12 set nrf.channel 80", that is
+ * repeated in the status line ("OK #12 set") to match replies to requests.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "UART_cmds.h"
+#include "fixfmt.h"
+
+int cmd_machine = FALSE;
+
+static const char *cmd_errors[] = { "ok", "unknown", "arguments", "range", "state" };
+
+
+/**
+ * @brief Case-insensitive compare.
+ */
+static int cmd_equal(const char *a, const char *b)
+{
+	while (*a && tolower((unsigned char)*a) == tolower((unsigned char)*b))
+	{
+		a++;
+		b++;
+	}
+	return (*a == '\0' && *b == '\0');
+}
+
+
+/**
+ * @brief Splits the line in place at spaces and ','.
+ * @return Number of words
+ */
+static int cmd_split(char *line, char **words, int max)
+{
+	int n = 0;
+
+	while (*line && n < max)
+	{
+		while (*line == ' ' || *line == ',')
+			*line++ = '\0';
+		if (!*line)
+			break;
+		words[n++] = line;
+		while (*line && *line != ' ' && *line != ',')
+			line++;
+	}
+	return n;
+}
+
+
+/**
+ * @brief Parses the words with the schema of the command.
+ * @return CMD_OK or CMD_ERR_ARGS
+ */
+static int cmd_parse(const char *schema, int nwords, char **words, CMD_ARG *argv)
+{
+	char *end;
+	int   i;
+
+	for (i = 0; i < nwords; i++, schema++)
+	{
+		switch (*schema)
+		{
+		case 'i': case 'I':
+			argv[i].i = strtol(words[i], &end, 0);
+			if (*end)
+				return CMD_ERR_ARGS;
+			break;
+
+		case 'f': case 'F':
+			argv[i].f = strtof(words[i], &end);
+			if (*end)
+				return CMD_ERR_ARGS;
+			break;
+
+		case 'd': case 'D':
+			argv[i].d = strtod(words[i], &end);
+			if (*end)
+				return CMD_ERR_ARGS;
+			break;
+
+		case 's': case 'S':
+			argv[i].s = words[i];
+			break;
+
+		default: // more words than the schema has
+			return CMD_ERR_ARGS;
+		}
+	}
+
+	if (*schema >= 'a' && *schema <= 'z') // a required argument is missing
+		return CMD_ERR_ARGS;
+	return CMD_OK;
+}
+
+
+/**
+ * @brief Executes one console line.
+ * @param line The line, changed in place
+ */
+void CMD_execute(char *line)
+{
+	char       *words[CMD_MAXARGS + 2];
+	CMD_ARG     argv[CMD_MAXARGS];
+	const char *tag = NULL;
+	const CMD  *cmd;
+	int         n, err;
+
+	n = cmd_split(line, words, CMD_MAXARGS + 2);
+	if (n && words[0][0] == '#') // request tag of a test rig
+	{
+		tag = words[0];
+		memmove(words, words + 1, --n * sizeof(char *));
+	}
+	if (!n)
+		return;
+
+	for (cmd = cmd_table; cmd->name; cmd++)
+		if (cmd_equal(cmd->name, words[0]))
+			break;
+
+	if (!cmd->name)
+		err = CMD_ERR_UNKNOWN;
+	else if (n - 1 > CMD_MAXARGS)
+		err = CMD_ERR_ARGS;
+	else if ((err = cmd_parse(cmd->args, n - 1, words + 1, argv)) == CMD_OK)
+		err = cmd->handler(n - 1, argv);
+
+	if (cmd_machine)
+	{
+		UART_puts(err ? "ERR" : "OK");
+		if (tag)
+		{
+			UART_puts(" "); UART_puts(tag);
+		}
+		UART_puts(" "); UART_puts(words[0]);
+		if (err)
+		{
+			UART_puts(" "); UART_putint(err);
+			UART_puts(" "); UART_puts(cmd_errors[err]);
+		}
+		UART_puts("\r\n");
+	}
+	else if (err)
+	{
+		UART_puts("\r\n"); UART_puts(words[0]);
+		UART_puts(": "); UART_puts(cmd_errors[err]);
+		if (err == CMD_ERR_ARGS)
+		{
+			UART_puts(", usage: "); UART_puts(cmd->name);
+			UART_puts(" "); UART_puts(cmd->args);
+		}
+		UART_puts(" (m = menu)\r\n");
+	}
+}
+
+
+/**
+ * @brief Lists all commands with their schema and help text.
+ */
+void CMD_help(void)
+{
+	const CMD *cmd;
+
+	for (cmd = cmd_table; cmd->name; cmd++)
+	{
+		UART_puts(" ");      UART_puts(cmd->name);
+		UART_puts(" ");      UART_puts(cmd->args);
+		UART_puts("\t: ");   UART_puts(cmd->help);
+		UART_puts("\r\n");
+	}
+	UART_puts(" args: i=int, f=float, d=double, s=word, upper case=optional; separate with ' ' or ','\r\n");
+}
+
+
+/**
+ * @brief Finds a parameter by name.
+ */
+static const PARAM *param_find(const char *name)
+{
+	const PARAM *p;
+
+	for (p = param_table; p->name; p++)
+		if (cmd_equal(p->name, name))
+			return p;
+	return NULL;
+}
+
+
+/**
+ * @brief Prints "name=value".
+ */
+static void param_print(const PARAM *p)
+{
+	char buf[FIXFMT_MAXLEN];
+
+	switch (p->type)
+	{
+	case PARAM_U8:    fmt_u32(buf, *(uint8_t *)p->ptr);     break;
+	case PARAM_U32:   fmt_u32(buf, *(uint32_t *)p->ptr);    break;
+	case PARAM_I32:   fmt_i32(buf, *(int32_t *)p->ptr, 0);  break;
+	case PARAM_FLOAT: fmt_float(buf, *(float *)p->ptr, 3, 0); break;
+	}
+	UART_puts(p->name); UART_puts("="); UART_puts(buf);
+}
+
+
+/**
+ * @brief get name: prints the value of a parameter.
+ */
+int CMD_get(int argc, CMD_ARG *argv)
+{
+	const PARAM *p = param_find(argv[0].s);
+
+	if (!p)
+		return CMD_ERR_UNKNOWN;
+	UART_puts("\r\n");
+	param_print(p);
+	UART_puts("\r\n");
+	return CMD_OK;
+}
+
+
+/**
+ * @brief set name value: range-checks and writes a parameter, then applies it.
+ */
+int CMD_set(int argc, CMD_ARG *argv)
+{
+	const PARAM *p = param_find(argv[0].s);
+	char        *end;
+	float        v;
+
+	if (!p)
+		return CMD_ERR_UNKNOWN;
+
+	v = strtof(argv[1].s, &end);
+	if (*end)
+		return CMD_ERR_ARGS;
+	if (v < p->min || v > p->max)
+		return CMD_ERR_RANGE;
+	if (p->type != PARAM_FLOAT && v != (float)(int32_t)v)
+		return CMD_ERR_ARGS; // integer parameter
+
+	taskENTER_CRITICAL(); // readers in other tasks never see half a value
+	switch (p->type)
+	{
+	case PARAM_U8:    *(uint8_t *)p->ptr  = (uint8_t)v;  break;
+	case PARAM_U32:   *(uint32_t *)p->ptr = (uint32_t)v; break;
+	case PARAM_I32:   *(int32_t *)p->ptr  = (int32_t)v;  break;
+	case PARAM_FLOAT: *(float *)p->ptr    = v;           break;
+	}
+	taskEXIT_CRITICAL();
+
+	if (p->apply)
+		p->apply();
+
+	UART_puts("\r\n");
+	param_print(p);
+	UART_puts("\r\n");
+	return CMD_OK;
+}
+
+
+/**
+ * @brief params: lists all parameters with value, range and help.
+ */
+int CMD_params(int argc, CMD_ARG *argv)
+{
+	const PARAM *p;
+	char         buf[FIXFMT_MAXLEN];
+
+	UART_puts("\r\n");
+	for (p = param_table; p->name; p++)
+	{
+		param_print(p);
+		if (!cmd_machine) // machine mode: only name=value
+		{
+			UART_puts("\t[");  fmt_float(buf, p->min, (p->type == PARAM_FLOAT ? 3 : 0), 0); UART_puts(buf);
+			UART_puts("..");   fmt_float(buf, p->max, (p->type == PARAM_FLOAT ? 3 : 0), 0); UART_puts(buf);
+			UART_puts("] ");   UART_puts(p->help);
+		}
+		UART_puts("\r\n");
+	}
+	return CMD_OK;
+}
+
+
+/**
+ * @brief machine 0|1: switches the machine-readable replies.
+ */
+int CMD_machine(int argc, CMD_ARG *argv)
+{
+	cmd_machine = (argv[0].i != 0);
+	return CMD_OK;
+}
+
+
+/**
+ * @brief help / m: the menu.
+ */
+int CMD_helpcmd(int argc, CMD_ARG *argv)
+{
+	DisplayMenu();
+	return CMD_OK;
+}
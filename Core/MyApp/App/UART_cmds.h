@@ -0,0 +1,85 @@
+/*
+ * UART_cmds.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_UART_CMDS_H_
+#define MYAPP_APP_UART_CMDS_H_
+
+#include <stdint.h>
+
+/// most arguments after the command name
+#define CMD_MAXARGS 6
+
+/// handler results
+#define CMD_OK          0
+#define CMD_ERR_UNKNOWN 1 // no such command or parameter
+#define CMD_ERR_ARGS    2 // wrong number or type of arguments
+#define CMD_ERR_RANGE   3 // value out of range
+#define CMD_ERR_STATE   4 // not possible in the current mode
+
+/// one parsed argument, the type follows from the schema
+typedef union
+{
+	int32_t     i;
+	float       f;
+	double      d;
+	const char *s;
+} CMD_ARG;
+
+/**
+ * @brief A console command.
+ * args is the argument schema, one char per argument: 'i' integer, 'f' float,
+ * 'd' double (coordinates: a float resolves only ~0.5 m at 52 degrees), 's' word;
+ * upper case ('I', 'F', 'D', 'S') = optional, only at the end.
+ */
+typedef struct
+{
+	const char *name;                            // case-insensitive
+	const char *args;
+	int       (*handler)(int argc, CMD_ARG *argv); // returns CMD_OK or CMD_ERR_*
+	const char *help;
+} CMD;
+
+typedef enum
+{
+	PARAM_U8 = 0,
+	PARAM_U32,
+	PARAM_I32,
+	PARAM_FLOAT
+} PARAM_TYPE;
+
+/**
+ * @brief A runtime parameter for get/set. apply (may be NULL) is called after a set,
+ * for parameters that have to be pushed to hardware or another task.
+ */
+typedef struct
+{
+	const char *name;
+	PARAM_TYPE  type;
+	void       *ptr;
+	float       min, max;
+	void      (*apply)(void);
+	const char *help;
+} PARAM;
+
+/// the tables, in UART_keys.c; both end with a NULL name
+extern const CMD   cmd_table[];
+extern const PARAM param_table[];
+
+/// TRUE: every command ends with one "OK ..." or "ERR ..." line, for test rigs
+extern int cmd_machine;
+
+extern void CMD_execute(char *line);
+extern void CMD_help   (void);
+
+/// handlers of the generic commands, for cmd_table[]
+extern int  CMD_get    (int argc, CMD_ARG *argv);
+extern int  CMD_set    (int argc, CMD_ARG *argv);
+extern int  CMD_params (int argc, CMD_ARG *argv);
+extern int  CMD_machine(int argc, CMD_ARG *argv);
+extern int  CMD_helpcmd(int argc, CMD_ARG *argv);
+
+#endif /* MYAPP_APP_UART_CMDS_H_ */
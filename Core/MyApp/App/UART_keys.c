@@ -1,13 +1,14 @@
 /**
 * @file UART_keys.c
 * @brief Behandelt de communicatie met de UART.<br>
-* <b>Demonstreert: IRQ-handling, queue-handling, tasknotifcation, string-handling (strtok, pointers).</b><br>
+* <b>Demonstreert: IRQ-handling, queue-handling, tasknotifcation, command-tabellen (function pointers).</b><br>
 * Aan de UART is een interrupt gekoppeld, waarvan de ISR (zie: HAL_UART_RxCpltCallback())
 * in main.c gegenereerd is. Elke toets (character), die in een terminalprogramma ingedrukt wordt, wordt in de ISR
 * in een queue gezet.<br>
 * De task UART_keys_IRQ() leest de queue uit nadat het LINEFEED-character is gevonden (nadat ENTER gedrukt is). De
 * task leest de queue uit en vult een eigen buffer. Deze buffer wordt via TaskNotify doorgestuurd naar de task die
-* deze buffer interpreteert: UART_menu().
+* deze buffer interpreteert: UART_menu(), met de commando's en parameters in cmd_table[] en param_table[]
+* (zie UART_cmds.c).
 * @author MSC
 *
 * @date 5/5/2022
@@ -18,8 +19,21 @@
 #include "cmsis_os.h"
 #include "uart.h"
 #include "NRF_driver.h"
+#include "NRF_power.h"
+#include "GPS_bus.h"
+#include "telemetry.h"
+#include "GPS_mode.h"
+#include "GPS_parser.h"
+#include "GPS_Errorcalc.h"
+#include "UART_cmds.h"
+#include "config.h"
+#include "supervisor.h"
+#include "fault.h"
+#include "mathbench.h"
+#include "beeper.h"
+#include "logger.h"
+#include <math.h>
 
-extern unsigned int os_delay; /// deze waarde kan hier veranderd worden.
 
 /**
 * @brief Polt en leest characters in die de gebruiker via Terminalprogramma intikt.
@@ -30,7 +44,7 @@ extern unsigned int os_delay; /// deze waarde kan hier veranderd worden.
 */
 void UART_keys_poll (void *argument)
 {
-    char buffer[QSIZE_UART];
+    char buffer[UART_LINELEN];
 
 	osThreadId_t hTask = xTaskGetHandle("UART_menu");
 
@@ -38,7 +52,7 @@ void UART_keys_poll (void *argument)
 
 	while(TRUE)
     {
-	    UART_gets(buffer, QSIZE_UART, TRUE); // wait for string
+	    UART_gets(buffer, UART_LINELEN, TRUE); // wait for string
 
     	xTaskNotify(hTask, buffer, eSetValueWithOverwrite); // notify task2 with value
 
@@ -61,8 +75,8 @@ void UART_keys_poll (void *argument)
 */
 void UART_keys_IRQ (void *argument)
 {
-    char  		    buffer[QSIZE_UART];
-    char		    buffer_copy[QSIZE_UART];
+    char  		    buffer[UART_LINELEN];
+    char		    buffer_copy[UART_LINELEN];
 	int 			pos = 0;
 	int             finish = FALSE;
 	osThreadId_t    hTask;
@@ -80,8 +94,8 @@ void UART_keys_IRQ (void *argument)
 		// nb: q-receive haalt gelijk de buffer leeg (q-peek niet).
 		xQueueReceive(hUART_Queue, &buffer[pos], portMAX_DELAY);
 
-		// negeer dit char bij geen data: -1, 255, of CR of spatie
-		if (buffer[pos] == 0 || buffer[pos] == -1 || buffer[pos] == 255 || buffer[pos] == CRETURN || buffer[pos] == 32)
+		// negeer dit char bij geen data: -1, 255, of CR; spaties scheiden nu argumenten (zie CMD_execute)
+		if (buffer[pos] == 0 || buffer[pos] == -1 || buffer[pos] == 255 || buffer[pos] == CRETURN)
 			continue;
 
 		//UART_putchar(buffer[pos]);  // echo
@@ -93,7 +107,7 @@ void UART_keys_IRQ (void *argument)
 			finish = TRUE;
 
 		}
-		else if (pos == QSIZE_UART - 2) // close if end of buf
+		else if (pos == UART_LINELEN - 2) // close if end of buf
 		{
 			buffer[++pos] = '\0';       // first, skip to last position, then close string
 			finish = TRUE;
@@ -104,7 +118,7 @@ void UART_keys_IRQ (void *argument)
 			// de volgende taak krijgt een copy van de string
 			// mijn eigen buffer kan zo gelijk weer gevuld worden door de ISR
 			strcpy(buffer_copy, buffer);
-			memset(buffer, 0, QSIZE_UART); // clear original buffer
+			memset(buffer, 0, UART_LINELEN); // clear original buffer
 			finish = FALSE;
 			pos = 0;
 
@@ -125,17 +139,287 @@ void UART_keys_IRQ (void *argument)
 
 
 /**
-* @brief User Interface. De task wacht op kant en klare user-strings (TaskNotifyTake) van ISR-handler, en interpreteert
-* de string. Het eerste character geeft het hoofd-commando aan. Afhankelijk van het commando worden opvolgende chars
-* geinterpreteerd.
+ *************************************************************************************************************************
+ * Command handlers, zie cmd_table[]. Elke handler krijgt de al gecontroleerde argumenten (schema) en geeft
+ * CMD_OK of een CMD_ERR_* terug; de foutmelding (of in machine-mode de OK/ERR-regel) komt van CMD_execute().
+ *************************************************************************************************************************
+ */
+
+/// zet een debug-output aan/uit en toont de nieuwe stand
+static void toggle_debug(int mask, char *name)
+{
+	Uart_debug_out ^= mask; // toggle output on/off
+	UART_puts("\r\n"); UART_puts(name); UART_puts(" output = ");
+	UART_puts(Uart_debug_out & mask ? "ON\r\n" : "OFF\r\n");
+}
+
+/// <b>0 - 5</b>: Togglet verschillende debug-outputs naar UART
+static int cmd_debug_all(int argc, CMD_ARG *argv)
+{
+	Uart_debug_out = (Uart_debug_out ? DEBUG_OUT_NONE : DEBUG_OUT_ALL);
+	UART_puts("\r\nall debug output = ");
+	UART_puts(Uart_debug_out == DEBUG_OUT_ALL ? "ON\r\n" : "OFF\r\n");
+
+	// als alle output uitgezet wordt, is het handig om gelijk het menu te laten zien.
+	if (Uart_debug_out == DEBUG_OUT_NONE && !cmd_machine)
+		DisplayMenu();
+	return CMD_OK;
+}
+
+static int cmd_debug_uart   (int argc, CMD_ARG *argv) { toggle_debug(UART_DEBUG_OUT,    "uart");    return CMD_OK; }
+static int cmd_debug_gps    (int argc, CMD_ARG *argv) { toggle_debug(GPS_DEBUG_OUT,     "GPS");     return CMD_OK; }
+
+#if APP_PROFILE == APP_PROFILE_DEMO // de lesvoorbeelden (ledjes.c, student.c, ARM_keys_task)
+static int cmd_debug_leds   (int argc, CMD_ARG *argv) { toggle_debug(LEDS_DEBUG_OUT,    "leds");    return CMD_OK; }
+static int cmd_debug_armkeys(int argc, CMD_ARG *argv) { toggle_debug(ARMKEYS_DEBUG_OUT, "armkeys"); return CMD_OK; }
+static int cmd_debug_student(int argc, CMD_ARG *argv) { toggle_debug(STUDENT_DEBUG_OUT, "student"); return CMD_OK; }
+
+/// D: Verandert de Default OSTIME-DELAY, die gebruikt wordt bij de LEDs, bv. <b>"d,200"</b>
+static int cmd_delay(int argc, CMD_ARG *argv)
+{
+	if (argv[0].i < 1)
+		return CMD_ERR_RANGE;
+	os_delay = argv[0].i;
+	UART_puts("\r\n os_delay set to: "); UART_putint(os_delay);
+	return CMD_OK;
+}
+#endif
+
+/// P: Verandert de Prioriteit van een taak, bv. <b>"p,9,20"</b>: set Task 9 op priority 20
+static int cmd_priority(int argc, CMD_ARG *argv)
+{
+	if (argv[0].i < 1 || argv[1].i < 1 || argv[1].i >= osPriorityISR)
+		return CMD_ERR_RANGE;
+	SetTaskPriority(argv[0].i, argv[1].i);
+	return CMD_OK;
+}
+
+/// S: Start/Stop task, bv. <b>"s,9"</b>: start/stop Task 9
+static int cmd_startstop(int argc, CMD_ARG *argv)
+{
+	if (argv[0].i < 1)
+		return CMD_ERR_RANGE;
+	StartStopTask(argv[0].i);
+	return CMD_OK;
+}
+
+/// T, E, F, G: overzichten
+static int cmd_tasks (int argc, CMD_ARG *argv) { DisplayTaskData();  return CMD_OK; }
+static int cmd_energy(int argc, CMD_ARG *argv) { NRF_power_report(); return CMD_OK; }
+static int cmd_gpsbus(int argc, CMD_ARG *argv) { GPS_bus_report();   return CMD_OK; }
+static int cmd_gpsrx (int argc, CMD_ARG *argv) { GPS_rx_report();    return CMD_OK; }
+
+/// B: Zet binaire telemetrie aan/uit; in binaire mode komt alle tekst als TLM_TEXT-records
+static int cmd_binary(int argc, CMD_ARG *argv)
+{
+	if (!tlm_binary)
+	{
+		UART_puts("\r\nbinary telemetry = ON\r\n");
+		tlm_set_binary(TRUE);
+	}
+	else
+	{
+		tlm_set_binary(FALSE);
+		UART_puts("\r\nbinary telemetry = OFF\r\n");
+		tlm_report();
+	}
+	return CMD_OK;
+}
+
+/// X: Test de SPI-verbinding met de NRF24
+static int cmd_nrftest(int argc, CMD_ARG *argv)
+{
+	uint8_t reg;
+
+	UART_puts("Testing NRF24 SPI communication..., should return 0x08\r\n");
+	reg = nrf24_SPI_commscheck();
+	UART_puts("CONFIG register: 0x"); UART_putnum(reg >> 4, 16); UART_putnum(reg & 0x0f, 16); UART_puts("\r\n");
+	return CMD_OK;
+}
+
+/// mode: toont de mode, of geeft een event: survey, stop, broadcast
+static int cmd_mode(int argc, CMD_ARG *argv)
+{
+	static const struct { char *name; GPS_MODE_EVENT ev; } events[] =
+	{
+		{ "survey", eEV_SURVEY_START }, { "broadcast", eEV_BROADCAST_START }, { "stop", eEV_STOP }
+	};
+	unsigned int i;
+
+	if (argc)
+	{
+		for (i = 0; i < sizeof(events) / sizeof(events[0]); i++)
+			if (!strcmp(argv[0].s, events[i].name))
+				break;
+		if (i == sizeof(events) / sizeof(events[0]))
+			return CMD_ERR_ARGS;
+		if (!GPS_mode_event(events[i].ev))
+			return CMD_ERR_STATE; // niet toegestaan in deze mode
+	}
+	UART_puts("\r\nmode="); UART_puts(GPS_mode_name(GPS_mode_get())); UART_puts("\r\n");
+	return CMD_OK;
+}
+
+/// ref: zet de referentiepositie (decimale graden als double, hoogte in m), alleen als er niet uitgezonden wordt
+static int cmd_reference(int argc, CMD_ARG *argv)
+{
+	GPS_decimal_degrees_t pos;
+	GPS_MODE              m = GPS_mode_get();
+
+	if (argv[0].d < -90.0 || argv[0].d > 90.0 || argv[1].d < -180.0 || argv[1].d > 180.0)
+		return CMD_ERR_RANGE;
+	if (m == eMODE_BROADCASTING || m == eMODE_DEGRADED || m == eMODE_SURVEY_IN)
+		return CMD_ERR_STATE;
+
+	pos.latitude  = argv[0].d;
+	pos.longitude = argv[1].d;
+	pos.altitude  = (argc > 2 ? argv[2].f : NAN);
+	GPS_Errorcalc_setReference(pos);
+	GPS_mode_event(eEV_REFERENCE_SET);
+	return CMD_OK;
+}
+
+/// sup: toont de heartbeats en de oorzaak van de laatste watchdog-reset
+static int cmd_supervisor(int argc, CMD_ARG *argv) { SUP_report(); return CMD_OK; }
+
+/// fault: toont de fout van voor de laatste herstart (fault.c)
+static int cmd_fault(int argc, CMD_ARG *argv) { FAULT_report(); return CMD_OK; }
+
+/// bench: meet de correctie-rekenpaden in double, float32 en fixed point (mathbench.c)
+static int cmd_bench(int argc, CMD_ARG *argv) { BENCH_math(); return CMD_OK; }
+
+/// beep: speelt een buzzer-patroon (beeper.h) en toont de tellers
+static int cmd_beep(int argc, CMD_ARG *argv)
+{
+	if (argc)
+	{
+		if (argv[0].i < 0 || argv[0].i >= eBEEP_COUNT)
+			return CMD_ERR_RANGE;
+		BEEP_play((BEEP_PATTERN)argv[0].i);
+	}
+	BEEP_report();
+	return CMD_OK;
+}
+
+/// log: toont de logger, of: log start|stop|dump; dump alleen als de opname gestopt is
+static int cmd_log(int argc, CMD_ARG *argv)
+{
+	if (argc)
+	{
+		if (!strcmp(argv[0].s, "start"))
+			LOG_run(TRUE);
+		else if (!strcmp(argv[0].s, "stop"))
+			LOG_run(FALSE);
+		else if (!strcmp(argv[0].s, "dump"))
+		{
+			if (LOG_running())
+				return CMD_ERR_STATE; // eerst 'log stop'
+			LOG_dump();
+			return CMD_OK;
+		}
+		else
+			return CMD_ERR_ARGS;
+	}
+	LOG_report();
+	return CMD_OK;
+}
+
+/// config: toont waar de instellingen vandaan komen
+static int cmd_config(int argc, CMD_ARG *argv) { config_report(); return CMD_OK; }
+
+/// save: bewaart de instellingen (cfg) in flash
+static int cmd_save(int argc, CMD_ARG *argv)
+{
+	if (!config_save())
+		return CMD_ERR_STATE; // flash kon niet geschreven worden
+	config_report();
+	return CMD_OK;
+}
+
+/// defaults: zet de standaardinstellingen terug, in RAM
+static int cmd_defaults(int argc, CMD_ARG *argv)
+{
+	config_defaults();
+	config_report();
+	return CMD_OK;
+}
+
+
+
+/// alle commando's: naam, argumenten (i=int, f=float, d=double, s=woord, hoofdletter=optioneel), handler, help.
+/// De 1-letter-commando's zijn de oude menu-toetsen en werken zoals voorheen, bv. "p,7,20".
+const CMD cmd_table[] =
+{
+	{ "0",       "",    cmd_debug_all,     "[on/off] ALL TEST OUTPUT" },
+#if APP_PROFILE == APP_PROFILE_DEMO
+	{ "1",       "",    cmd_debug_leds,    "[on/off] LEDS output" },
+	{ "2",       "",    cmd_debug_armkeys, "[on/off] ARM_keys output" },
+#endif
+	{ "3",       "",    cmd_debug_uart,    "[on/off] UART_keys output" },
+#if APP_PROFILE == APP_PROFILE_DEMO
+	{ "4",       "",    cmd_debug_student, "[on/off] STUDENT output" },
+#endif
+	{ "5",       "",    cmd_debug_gps,     "[on/off] GPS output" },
+#if APP_PROFILE == APP_PROFILE_DEMO
+	{ "d",       "i",   cmd_delay,         "change DELAY time (default 200), eg. 'd,50'" },
+#endif
+	{ "p",       "ii",  cmd_priority,      "change TASK PRIORITY, eg. 'p,7,20' sets priority of task 7 to 20" },
+	{ "s",       "i",   cmd_startstop,     "start/stop TASK, eg. s,7 starts or stops task 7" },
+	{ "t",       "",    cmd_tasks,         "display TASK DATA (number, priority, stack usage, status)" },
+	{ "e",       "",    cmd_energy,        "display radio ENERGY estimate (power-down/standby time, nJ per correction)" },
+	{ "f",       "",    cmd_gpsbus,        "display GPS FIX bus subscribers (wakeups, overruns)" },
+	{ "g",       "",    cmd_gpsrx,         "display GPS RECEIVE counters (sentences, dropped, checksum errors, USB receiver)" },
+	{ "b",       "",    cmd_binary,        "[on/off] BINARY telemetry on this port (frames, see Tools/tlm_decode.py)" },
+	{ "x",       "",    cmd_nrftest,       "test the NRF24 SPI connection" },
+	{ "m",       "",    CMD_helpcmd,       "this menu" },
+	{ "help",    "",    CMD_helpcmd,       "this menu" },
+	{ "mode",    "S",   cmd_mode,          "show the mode, or: mode survey|broadcast|stop" },
+	{ "ref",     "ddF", cmd_reference,     "set the reference position: ref lat lon [alt], not while broadcasting" },
+	{ "get",     "s",   CMD_get,           "show a parameter, eg. 'get nrf.channel'" },
+	{ "set",     "ss",  CMD_set,           "change a parameter, eg. 'set nrf.channel 80'" },
+	{ "params",  "",    CMD_params,        "list all parameters" },
+	{ "sup",     "",    cmd_supervisor,    "display task heartbeats and the cause of the last watchdog reset" },
+	{ "fault",   "",    cmd_fault,         "display the fault (registers, task, trace) from before the last reset" },
+	{ "bench",   "",    cmd_bench,         "benchmark the correction math: double, float32 (FPU), fixed point, cycles per epoch" },
+	{ "beep",    "I",   cmd_beep,          "play buzzer pattern 0-3 (key, fix lost, radio fail, survey done) and show the counters" },
+	{ "log",     "S",   cmd_log,           "show the logger, or: log start|stop|dump (RAM disk as hex, see Tools/log_replay.py)" },
+	{ "config",  "",    cmd_config,        "display the configuration source and flash slot" },
+	{ "save",    "",    cmd_save,          "store radio, survey and reference settings in flash" },
+	{ "defaults","",    cmd_defaults,      "restore the default settings (not stored until 'save')" },
+	{ "machine", "i",   CMD_machine,       "1: machine-readable replies (OK/ERR line per command), 0: off" },
+	{ NULL,      NULL,  NULL,              NULL }
+};
+
+
+/// alle runtime-parameters voor get/set: naam, type, adres, min, max, apply (na set), help.
+const PARAM param_table[] =
+{
+	{ "debug",            PARAM_I32,   &Uart_debug_out,             0, 255,    NULL,           "debug output mask, see 0-5" },
+#if APP_PROFILE == APP_PROFILE_DEMO
+	{ "led.delay",        PARAM_U32,   &os_delay,                   1, 5000,   NULL,           "LED task delay, ms" },
+#endif
+	{ "nrf.channel",      PARAM_U8,    &cfg.radio.channel,            0, 125,    NRF_setRadio,   "radio channel, 2400 + n MHz" },
+	{ "nrf.rate",         PARAM_U8,    &cfg.radio.rate,               0, 2,      NRF_setRadio,   "0 = 1 Mbps, 1 = 2 Mbps, 2 = 250 kbps" },
+	{ "nrf.power",        PARAM_U8,    &cfg.radio.power,              0, 3,      NRF_setRadio,   "0 = -18 dBm .. 3 = 0 dBm" },
+	{ "survey.min",       PARAM_U32,   &cfg.survey.min_samples,     1, 10000,  NULL,           "never finish before this many fixes" },
+	{ "survey.max",       PARAM_U32,   &cfg.survey.max_samples,     1, 100000, NULL,           "finish at the latest after this many fixes" },
+	{ "survey.target_mm", PARAM_U32,   &cfg.survey.target_mm,       1, 100000, NULL,           "finish at this standard error of the mean" },
+	{ "survey.max_hdop",  PARAM_FLOAT, &cfg.survey.max_hdop,        0.5f, 50,  NULL,           "reject fixes with a higher HDOP" },
+	{ "survey.decorr_s",  PARAM_U32,   &cfg.survey.decorr_s,        0, 3600,   NULL,           "one independent fix per this many s, 0: all independent" },
+	{ "ref.index",        PARAM_U8,    &cfg.ref_index,              0, CONFIG_NREFS - 1, NULL, "stored reference used at boot and set by ref/survey" },
+	{ NULL,               0,           NULL,                        0, 0,      NULL,           NULL }
+};
+
+
+/**
+* @brief User Interface. De task wacht op kant en klare user-strings (TaskNotifyTake) van ISR-handler, en
+* geeft ze aan CMD_execute(): het eerste woord is het commando (zie cmd_table[]), de rest zijn de argumenten.
 * @param *argument Niet gebruikt, eventueel een waarde of string om te testen
 * @return void
 */
 void UART_menu (void *argument)
 {
-	char   *s;
-	char   *tok = ",";  // token if command is more than 1 char
-	int     val1, val2;
+	char *s;
 
 	UART_puts((char *)__func__); UART_puts("started\n\r");
 
@@ -145,93 +429,6 @@ void UART_menu (void *argument)
 		// want de waarde die ik terug krijg is een pointer.
 		s = (char *)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-		// check het eerste (en vaak enige) karakter van de inkomende command-string
-		// toupper() zorgt ervoor dat het eerste karakter hoofdletter wordt, zo hoef ik niet op kleine
-		// letters te checken.
-		switch (toupper((unsigned char)s[0]))
-		{
-		default:  UART_puts(s);
-				  UART_puts(" (unkown command)\r\n");
-				  break;
-
-		/// <b>0 - 5</b>: Togglet verschillende debug-outputs naar UART
-		case '0': Uart_debug_out = (Uart_debug_out ? DEBUG_OUT_NONE : DEBUG_OUT_ALL);
-		  	  	  UART_puts("\r\nall debug output = ");
-		  	  	  UART_puts(Uart_debug_out == DEBUG_OUT_ALL ? "ON\r\n" : "OFF\r\n");
-
-		  	  	  // als alle output uitgezet wordt, is het handig om gelijk het menu te laten zien.
-		  	  	  if (Uart_debug_out == DEBUG_OUT_NONE)
-		  	  		  DisplayMenu();
-				  break;
-
-		case '1': Uart_debug_out ^= LEDS_DEBUG_OUT; // toggle output on/off
-				  UART_puts("\r\nleds output = ");
-				  UART_puts(Uart_debug_out & LEDS_DEBUG_OUT ? "ON\r\n" : "OFF\r\n");
-				  break;
-
-		case '2': Uart_debug_out ^= ARMKEYS_DEBUG_OUT; // toggle output on/off
-		  	      UART_puts("\r\narmkeys output = ");
-		  	      UART_puts(Uart_debug_out & ARMKEYS_DEBUG_OUT ? "ON\r\n" : "OFF\r\n");
-				  break;
-
-		case '3': Uart_debug_out ^= UART_DEBUG_OUT; // toggle output on/off
-		  	      UART_puts("\r\nuart output = ");
-		  	      UART_puts(Uart_debug_out & UART_DEBUG_OUT ? "ON\r\n" : "OFF\r\n");
-				  break;
-
-		case '4': Uart_debug_out ^= STUDENT_DEBUG_OUT; // toggle output on/off
-		  	  	  UART_puts("\r\nstudent output = ");
-		  	  	  UART_puts(Uart_debug_out & STUDENT_DEBUG_OUT ? "ON\r\n" : "OFF\r\n");
-				  break;
-
-		case '5': Uart_debug_out ^= GPS_DEBUG_OUT; // toggle output on/off
-		  	  	  UART_puts("\r\nGPS output = ");
-		  	  	  UART_puts(Uart_debug_out & GPS_DEBUG_OUT ? "ON\r\n" : "OFF\r\n");
-				  break;
-
-		/// ... en reageert ook op een paar letters
-		case 'D': /// D: Verandert de Default OSTIME-DELAY, die gebruikt wordt bij de LEDs.
-				  /// commando: <b>"d,200"</b> betekent: set delay op 200, NB: spaties worden niet afgevangen...
-				  os_delay = atoi(s+2); // skip first 2 characters
-				  UART_puts("\r\n os_delay set to: "); UART_putint(os_delay);
-				  break;
-
-		case 'M': DisplayMenu(); /// M: Displays het menu (zie my_app.c)
-				  break;
-
-		case 'T': DisplayTaskData(); /// T: Displays de stackdata van alle Tasks
-				  break;
-
-		case 'P': /// P: Verandert de Prioriteit van een taak
-				  /// commando, als: <b>"t,9,20"</b> betekent: set Task 9 op priority 20
-				  //  eerst: de 2 waarden worden uit de string gehaald met strtok()
-			      //  dan: de strings worden naar int geconverteerd
-				  //  nb. dit is wel grof geprogrammeerd zo, in het echt maak je hier een mooie functie van.
-			      s = strtok(s,    tok); 				 // naar start van string, negeer 't,'
-				  s = strtok(NULL, tok); val1 = atoi(s); // volgende = task_id
-				  s = strtok(NULL, tok); val2 = atoi(s); // volgende = priority
-				  if (val1 && val2)						 // kleine validiteitscontrole
-					  SetTaskPriority(val1, val2);
-				  break;
-
-		case 'S': /// S: Start/Stop task
-				  /// commando, als: <b>"s,9"</b> betekent: start/stop Task 9
-				  //  eerst: de waarde worden uit de string gehaald met strtok()
-			      //  dan: de string wordt naar int geconverteerd
-				  //  nb. dit is wel grof geprogrammeerd zo, in het echt maak je hier een mooie functie van.
-			      s = strtok(s,    tok); 				 // naar start van string, negeer 's,'
-				  s = strtok(NULL, tok); val1 = atoi(s); // volgende = task_id
-				  if (val1)						 // kleine validiteitscontrole
-					  StartStopTask(val1);
-				  break;
-		
-		case 'X':
-				UART_puts("Testing NRF24 SPI communication..., should return 0x08\r\n");
-				uint8_t cfg = nrf24_SPI_commscheck();
-				char tmp[8];
-				snprintf(tmp, sizeof(tmp), "%02X", cfg);   // prints two hex digits
-				UART_puts("CONFIG register: 0x"); UART_puts(tmp); UART_puts("\r\n");
-				break;
-		}
+		CMD_execute(s);
 	}
 }
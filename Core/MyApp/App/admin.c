@@ -31,9 +31,21 @@
 #include "admin.h"
 #include "NRF_driver.h"
 #include "GPS_Errorcalc.h"
+#include "telemetry.h"
+#include "supervisor.h"
+#include "fault.h"
+#include "UART_cmds.h"
+#include "ledstatus.h"
+#include "keyscan.h"
+#include "beeper.h"
+#include "logger.h"
 
 /// output strings for initialization
+#if APP_PROFILE == APP_PROFILE_DEMO
 char *app_name    = "\r\n=== freeRTOS_GPS 407 ===\r\n";
+#else
+char *app_name    = "\r\n=== freeRTOS_GPS 407 (production) ===\r\n";
+#endif
 char *app_nameLCD = "Differential GPS TX"; // max 16 chars
 
 /// default: debug all output to uart
@@ -43,14 +55,67 @@ int Uart_debug_out = DEBUG_OUT_NONE;
 /// all handles used, note: defined to 'extern' in admin.h
 QueueHandle_t 	      hKey_Queue;
 QueueHandle_t 	      hUART_Queue; /// uses UART2
-QueueHandle_t 	      hGPS_Queue;  /// uses UART1
+MessageBufferHandle_t hGPS_MsgBuf; /// uses UART4
+MessageBufferHandle_t hTLM_MsgBuf; /// uses UART2
+#if APP_PROFILE == APP_PROFILE_DEMO
 SemaphoreHandle_t     hLED_Sem;
+#endif
+#if APP_PROFILE == APP_PROFILE_DEMO
 EventGroupHandle_t 	  hKEY_Event;
+#endif
 TimerHandle_t         hTimer1;
-SemaphoreHandle_t     hGPS_Mutex; /// mutex voor GPS-parsing
+TimerHandle_t         hKeyScan;
+TimerHandle_t         hBeeper;
+
+/// statisch geheugen voor de handles, zie CreateHandles(); niets komt van de heap
+#if APP_PROFILE == APP_PROFILE_DEMO
+static StaticSemaphore_t     LED_Sem_mem;
+#endif
+static StaticQueue_t         UART_Queue_mem;
+static uint8_t               UART_Queue_storage[QSIZE_UART * sizeof(char)];
+static StaticMessageBuffer_t GPS_MsgBuf_mem;
+static uint8_t               GPS_MsgBuf_storage[GPS_MSGBUF_SIZE + 1]; // + 1: eis van xMessageBufferCreateStatic()
+static StaticMessageBuffer_t TLM_MsgBuf_mem;
+static uint8_t               TLM_MsgBuf_storage[TLM_MSGBUF_SIZE + 1];
+#if APP_PROFILE == APP_PROFILE_DEMO
+static StaticEventGroup_t    KEY_Event_mem;
+#endif
+static StaticTimer_t         Timer1_mem;
+static StaticTimer_t         KeyScan_mem;
+static StaticTimer_t         Beeper_mem;
 
 
 
+/**
+ * Statisch geheugen per taak: TASK_STACK() maakt de stack (in bytes, afgerond op 8) en de TCB aan,
+ * TASK_MEM() vult daarmee de attr-members in. osThreadNew() gebruikt dan xTaskCreateStatic() en
+ * neemt niets van de heap; de map-file toont het exacte geheugen per taak (Tools/memreport.py).
+ */
+#define TASK_STACK(task, bytes) static uint64_t task##_stack[((bytes) + 7) / 8]; static StaticTask_t task##_tcb;
+#define TASK_MEM(task)          .attr.stack_mem = task##_stack, .attr.stack_size = sizeof(task##_stack), \
+                                .attr.cb_mem = &task##_tcb,     .attr.cb_size = sizeof(StaticTask_t)
+
+TASK_STACK(UART_keys_IRQ,   600)
+TASK_STACK(UART_menu,       600)
+TASK_STACK(GPS_getNMEA,     600)
+TASK_STACK(GPS_parser,      1024)
+TASK_STACK(NRF_Driver,      1000)
+TASK_STACK(GPS_Errorcalc,   1200) // FPU-context, LCD/debug-regels en DisplayTaskData()
+TASK_STACK(Telemetry_task,  450)
+TASK_STACK(Logger_task,     1500) // FatFs, MSC-transfers en snprintf van de bestandsnaam
+TASK_STACK(Supervisor_task, 450)
+
+#if APP_PROFILE == APP_PROFILE_DEMO // lesvoorbeelden, niet in de production build
+TASK_STACK(ARM_keys_IRQ,    600)
+TASK_STACK(ARM_keys_task,   600)
+TASK_STACK(Student_task1,   600)
+TASK_STACK(LED_Task1,       450)
+TASK_STACK(LED_Task2,       450)
+TASK_STACK(LED_Task3,       450)
+TASK_STACK(LED_Task4,       450)
+#endif
+
+
 /** tasks[] is een array van structures met alleen de argumenten om een taak aan te maken.
  *
  * - **NB:**<br>
@@ -71,38 +136,51 @@ SemaphoreHandle_t     hGPS_Mutex; /// mutex voor GPS-parsing
  */
 TASKDATA tasks[] =
 {
-	// function      arg   name                        stacksize (* 4 = 32bit)     priority
+	// function      arg   name                        stack + TCB (TASK_STACK)  priority
 	// ----------------------------------------------------------------------------------------------------------------------------
+#if APP_PROFILE == APP_PROFILE_DEMO // de keypad-scanner (keyscan.c) roept de shortcuts zelf aan
 	// in ARM_keys.c
-	{ ARM_keys_IRQ, NULL, .attr.name = "ARM_keys_IRQ", .attr.stack_size = 600, .attr.priority = osPriorityNormal1 },
-	{ ARM_keys_task,NULL, .attr.name = "ARM_keys_task",.attr.stack_size = 600, .attr.priority = osPriorityNormal2 },
+	{ ARM_keys_IRQ, NULL, .attr.name = "ARM_keys_IRQ", TASK_MEM(ARM_keys_IRQ),   .attr.priority = osPriorityNormal1 },
+	{ ARM_keys_task,NULL, .attr.name = "ARM_keys_task",TASK_MEM(ARM_keys_task),  .attr.priority = osPriorityNormal2 },
+#endif
 
 	// UART_keys.c
-	{ UART_keys_IRQ,NULL, .attr.name = "UART_keys_IRQ",.attr.stack_size = 600, .attr.priority = osPriorityBelowNormal5 },
-	{ UART_menu,    NULL, .attr.name = "UART_menu",    .attr.stack_size = 600, .attr.priority = osPriorityBelowNormal6 },
+	{ UART_keys_IRQ,NULL, .attr.name = "UART_keys_IRQ",TASK_MEM(UART_keys_IRQ),  .attr.priority = osPriorityBelowNormal5 },
+	{ UART_menu,    NULL, .attr.name = "UART_menu",    TASK_MEM(UART_menu),      .attr.priority = osPriorityBelowNormal6 },
 
 	// gps.c
-	{ GPS_getNMEA,  NULL, .attr.name = "GPS_getNMEA",  .attr.stack_size = 600, .attr.priority = osPriorityNormal2 },
+	{ GPS_getNMEA,  NULL, .attr.name = "GPS_getNMEA",  TASK_MEM(GPS_getNMEA),    .attr.priority = osPriorityNormal2 },
 
+#if APP_PROFILE == APP_PROFILE_DEMO
 	// student.c
-	{ Student_task1,NULL, .attr.name = "Student_task1",.attr.stack_size = 600, .attr.priority = osPriorityBelowNormal7 },
+	{ Student_task1,NULL, .attr.name = "Student_task1",TASK_MEM(Student_task1),  .attr.priority = osPriorityBelowNormal7 },
 
 	// ledjes.c
 	// NOTE: ledtasks 1 & 2 moeten dezelfde priority hebben, anders 'sterft' de taak met de laagste priority
 	//       wat wel kan: afdwingen dat taken aan de beurt komen door notifications, zie ledasks 3 & 4
-	{ LED_Task1,    NULL, .attr.name = "LED_Task1",    .attr.stack_size = 450, .attr.priority = osPriorityBelowNormal4 },
-	{ LED_Task2,    NULL, .attr.name = "LED_Task2",    .attr.stack_size = 450, .attr.priority = osPriorityBelowNormal4 },
-	{ LED_Task3,    NULL, .attr.name = "LED_Task3",    .attr.stack_size = 450, .attr.priority = osPriorityBelowNormal5 },
-	{ LED_Task4,    NULL, .attr.name = "LED_Task4",    .attr.stack_size = 450, .attr.priority = osPriorityBelowNormal4 },
+	{ LED_Task1,    NULL, .attr.name = "LED_Task1",    TASK_MEM(LED_Task1),      .attr.priority = osPriorityBelowNormal4 },
+	{ LED_Task2,    NULL, .attr.name = "LED_Task2",    TASK_MEM(LED_Task2),      .attr.priority = osPriorityBelowNormal4 },
+	{ LED_Task3,    NULL, .attr.name = "LED_Task3",    TASK_MEM(LED_Task3),      .attr.priority = osPriorityBelowNormal5 },
+	{ LED_Task4,    NULL, .attr.name = "LED_Task4",    TASK_MEM(LED_Task4),      .attr.priority = osPriorityBelowNormal4 },
+#endif
 
 	// GPS parsing
-	{ GPS_parser,    NULL, .attr.name ="GPS_parser",    .attr.stack_size = 1024, .attr.priority = osPriorityBelowNormal4 },
-	{ NRF_Driver,    NULL, .attr.name ="NRF_driver",    .attr.stack_size = 1000, .attr.priority = osPriorityNormal3 },
-	{ GPS_Errorcalc,    NULL, .attr.name ="GPS_Errorcalc",    .attr.stack_size = 1200, .attr.priority = osPriorityBelowNormal4 },
+	{ GPS_parser,    NULL, .attr.name ="GPS_parser",    TASK_MEM(GPS_parser),    .attr.priority = osPriorityBelowNormal4 },
+	{ NRF_Driver,    NULL, .attr.name ="NRF_driver",    TASK_MEM(NRF_Driver),    .attr.priority = osPriorityNormal3 },
+	{ GPS_Errorcalc,    NULL, .attr.name ="GPS_Errorcalc",    TASK_MEM(GPS_Errorcalc), .attr.priority = osPriorityBelowNormal4 },
+
+	// telemetry.c
+	{ Telemetry_task,NULL, .attr.name = "Telemetry",   TASK_MEM(Telemetry_task), .attr.priority = osPriorityBelowNormal3 },
+
+	// logger.c: onder de GPS- en NRF-taken, een trage stick houdt de correcties niet op
+	{ Logger_task,  NULL, .attr.name = "Logger",       TASK_MEM(Logger_task),    .attr.priority = osPriorityBelowNormal2 },
+
+	// supervisor.c: boven alle bewaakte taken, anders ziet hij een verhongerde taak niet
+	{ Supervisor_task,NULL,.attr.name = "Supervisor",  TASK_MEM(Supervisor_task),.attr.priority = osPriorityHigh },
 
 
 	// deze laatste niet wissen, wordt gebruik als 'terminator' in for-loops
-	{ NULL,         NULL, .attr.name = NULL,           .attr.stack_size = 0,       .attr.priority = 0 }
+	{ NULL,         NULL, .attr.name = NULL,           .attr.stack_size = 0,     .attr.priority = 0 }
 };
 
 
@@ -159,23 +237,10 @@ Michiel Scager (update: april 2023)\r\n";
 */
 void DisplayMenu(void)
 {
-	char *menu =
-"\r\n\
-Menu:===============================================================\r\n\
-key: function\r\n\
- 0 : [on/off] ALL TEST OUTPUT\r\n\
- 1 : [on/off] LEDS output\r\n\
- 2 : [on/off] ARM_keys output\r\n\
- 3 : [on/off] UART_keys output\r\n\
- 4 : [on/off] STUDENT output\r\n\
- 5 : [on/off] GPS output\r\n\
- d : change DELAY time (default 200), eg. 'd,50'\r\n\
- p : change TASK PRIORITY, eg. 'p,7,20' sets priority of task 7 to 20\r\n\
- t : display TASK DATA (number, priority, stack usage, status)\r\n\
- s : start/stop TASK, eg. s,7 starts or stops task 7\r\n\
-=====================================================================\r\n";
-
-    UART_puts(menu);
+	UART_puts("\r\nMenu:===============================================================\r\n");
+	UART_puts("command: function\r\n");
+	CMD_help(); // de commando's staan in cmd_table[] (UART_keys.c)
+	UART_puts("=====================================================================\r\n");
 }
 
 
@@ -192,48 +257,59 @@ key: function\r\n\
 /**
 * @brief Fatale OS-error opgetreden tijdens startup of runtime, doorgaan is
 * zinloos.
-* Het OS wordt tot stoppen gebracht, er wordt output gegenereerd waar mogelijk,
-* dus op UART en LCD.
+* Er wordt output gegenereerd waar mogelijk, dus op UART en LCD; daarna wordt de
+* melding bewaard in het fault-record (fault.c) en herstart het board meteen. De
+* volgende boot toont de melding.
 * @param msg Foutmelding
 * @return void
 */
 void error_HaltOS(char *msg)
 {
+	UART_text_hook = NULL; // melding altijd als tekst, ook in binaire telemetrie-mode
 	LCD_puts(msg);
-	UART_puts(msg); UART_puts(". Application halted\r\n");
+	UART_puts(msg); UART_puts(". Application halted, restarting\r\n");
 
 	BUZZER_put(1000);
-	vTaskSuspendAll(); // stop alle tasks
-
-	while (TRUE)
-	{
-	}
+	FAULT_halt(msg, (uint32_t)__builtin_return_address(0));
 }
 
 
 /**
-* @brief Creates alle handles voor deze applicatie
+* @brief Creates alle handles voor deze applicatie, met statisch geheugen (de ...Static()-varianten):
+* de grootte staat vast bij het linken en de heap raakt niet gefragmenteerd.
 * @return void
 */
 void CreateHandles(void)
 {
-	if (!(hLED_Sem = xSemaphoreCreateMutex()))
+#if APP_PROFILE == APP_PROFILE_DEMO
+	if (!(hLED_Sem = xSemaphoreCreateMutexStatic(&LED_Sem_mem)))
 		error_HaltOS("Error hLED_Sem");
+#endif
 
-	if (!(hUART_Queue = xQueueCreate(QSIZE_UART, sizeof(unsigned int))))
+	if (!(hUART_Queue = xQueueCreateStatic(QSIZE_UART, sizeof(char), UART_Queue_storage, &UART_Queue_mem))) // de ISR zet 1 char per keer
 		error_HaltOS("Error hUART_Q");
 
-	if (!(hGPS_Queue = xQueueCreate(GPS_MAXLEN, sizeof(unsigned char))))
-		error_HaltOS("Error hGPS_Q");
+	if (!(hGPS_MsgBuf = xMessageBufferCreateStatic(GPS_MSGBUF_SIZE, GPS_MsgBuf_storage, &GPS_MsgBuf_mem)))
+		error_HaltOS("Error hGPS_MsgBuf");
+
+	if (!(hTLM_MsgBuf = xMessageBufferCreateStatic(TLM_MSGBUF_SIZE, TLM_MsgBuf_storage, &TLM_MsgBuf_mem)))
+		error_HaltOS("Error hTLM_MsgBuf");
 
-	if (!(hKEY_Event = xEventGroupCreate()))
+#if APP_PROFILE == APP_PROFILE_DEMO
+	if (!(hKEY_Event = xEventGroupCreateStatic(&KEY_Event_mem)))
 		error_HaltOS("Error hLCD_Event");
+#endif
 
-	if (!(hTimer1 = xTimerCreate("Timer_1", pdMS_TO_TICKS(TIMER1_DELAY), pdTRUE, 0, (TimerCallbackFunction_t)Timer1_Handler)))
+	if (!(hTimer1 = xTimerCreateStatic("Timer_1", pdMS_TO_TICKS(TIMER1_DELAY), pdTRUE, 0, (TimerCallbackFunction_t)Timer1_Handler, &Timer1_mem)))
 		error_HaltOS("Error hTimer1");
 
-	if (!(hGPS_Mutex = xSemaphoreCreateMutex()))
-		error_HaltOS("Error hGPS_Mutex");
+	// de keypad-interrupt start deze timer, de callback stopt hem weer als alle toetsen los zijn
+	if (!(hKeyScan = xTimerCreateStatic("KeyScan", pdMS_TO_TICKS(KEYSCAN_MS), pdTRUE, 0, (TimerCallbackFunction_t)KEYSCAN_tick, &KeyScan_mem)))
+		error_HaltOS("Error hKeyScan");
+
+	// BEEP_play() start deze timer, de callback zet hem per stap van het patroon opnieuw
+	if (!(hBeeper = xTimerCreateStatic("Beeper", 1, pdFALSE, 0, (TimerCallbackFunction_t)BEEP_tick, &Beeper_mem)))
+		error_HaltOS("Error hBeeper");
 
 	UART_puts("\n\rAll handles created successfully.");
 
@@ -243,13 +319,14 @@ void CreateHandles(void)
 }
 
 /**
-* @brief Vangt de FreeRTOS software-interrupt op en toggelt een ledje
+* @brief Vangt de FreeRTOS software-interrupt op en werkt de status-LEDs bij; dit is de
+* enige plek die het LED-schuifregister schrijft.
 * @param hTimer1 De handle van de timer
 * @return void
 */
 void Timer1_Handler(void)
 {
-	// HAL_GPIO_TogglePin(GPIOD, LEDBLUE);   // turns led on/off
+	LEDSTAT_tick();
 }
 
 
@@ -393,23 +470,24 @@ void DisplayTaskData(void)
 
 	for (task_nr=1; ptd->func != NULL; ptd++, task_nr++)
 	{
-		highwatermark = uxTaskGetStackHighWaterMark(ptd->hTask); 	// amount of free bytes
-		free = (highwatermark * 100) / ptd->attr.stack_size; 		// in percentage
-		totalalloc += ptd->attr.stack_size;
+		highwatermark = uxTaskGetStackHighWaterMark(ptd->hTask); 	// amount of free words
+		free = (highwatermark * 4 * 100) / ptd->attr.stack_size; 	// in percentage, stack_size is in bytes
+		totalalloc += ptd->attr.stack_size + ptd->attr.cb_size;
 
 		vTaskGetInfo (ptd->hTask, &xTaskDetails, pdTRUE, eInvalid); // get task status
 
 		UART_puts("\r\n\t[");        UART_putint(task_nr); UART_puts("] ");
 		UART_puts(ptd->attr.name);
 		UART_puts("\t priority: ");  UART_putint(ptd->attr.priority);
-		UART_puts("\t stacksize: "); UART_putint(ptd->attr.stack_size * 4);
+		UART_puts("\t stacksize: "); UART_putint(ptd->attr.stack_size);
 		UART_puts("\t free: ");  UART_putint(highwatermark*4);
 		UART_puts("\t used: ");      UART_putint(100 - free); UART_puts("%");
 		UART_puts("\t status: ");    UART_puts(xTaskDetails.eCurrentState == eSuspended ? "suspended": "running");
 	}
-	UART_puts("\r\n\tTotal heap: "); UART_putint(configTOTAL_HEAP_SIZE);
-	UART_puts("    Allocated task stack: "); UART_putint(totalalloc * 4);
-	UART_puts("    Free heap space: "); UART_putint(configTOTAL_HEAP_SIZE - (totalalloc * 4));
+	UART_puts("\r\n\tStatic task memory (stacks + TCBs): "); UART_putint(totalalloc);
+	UART_puts("    Heap: ");             UART_putint(configTOTAL_HEAP_SIZE);
+	UART_puts("    free: ");             UART_putint(xPortGetFreeHeapSize());
+	UART_puts("    lowest: ");           UART_putint(xPortGetMinimumEverFreeHeapSize());
 	UART_puts("\r\n");
 }
 
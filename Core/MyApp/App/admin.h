@@ -23,11 +23,22 @@
 #define TRUE  	   1
 #define FALSE      0
 
-/// set queue op 10 elementen
-#define QSIZE_UART 10
-
-/// set software timer 500 msecs
-#define TIMER1_DELAY 500
+/// build profiles: DEMO bevat de lesvoorbeelden (LED-taken, Student_task1, de ARM-key
+/// ledjes-animatie), PRODUCTION alleen de GPS-, correctie-, radio-, console- en
+/// supervisor-taken. De Build Configuration Production zet -DAPP_PROFILE=APP_PROFILE_PRODUCTION.
+#define APP_PROFILE_DEMO       1
+#define APP_PROFILE_PRODUCTION 2
+#ifndef APP_PROFILE
+#define APP_PROFILE APP_PROFILE_DEMO
+#endif
+
+/// set queue op 32 chars, genoeg voor een regel die een test-rig in 1 keer stuurt
+#define QSIZE_UART 32
+/// langste commandoregel, incl. '\0'
+#define UART_LINELEN 96
+
+/// set software timer 125 msecs: de tick van de status-LEDs (ledstatus.c), 8 ticks per patroon
+#define TIMER1_DELAY 125
 
 #define GPS_MAXLEN 79+4 /// $+CR+LF+'\0'
 /** The carriage return [CR] and the line feed [LF] combination terminate the sentence.
@@ -36,6 +47,15 @@
 * The data field block, including delimiters is limited to 74 characters or less.
 */
 
+/// messagebuffer voor 8 hele NMEA-zinnen (elk bericht kost ook een size_t lengte); een GSV-burst is 6-9 zinnen
+#define GPS_MSGBUF_SIZE (8 * ((GPS_MAXLEN) + sizeof(size_t)))
+
+/// notification bits for the GPS tasks, sent with xTaskNotify(.., eSetBits)
+/// bit 1: a new GNRMC fix is available, see fill_GNRMC()
+#define GPS_NOTIFY_FIX    0x01
+/// bit 2: the operating mode changed, see GPS_mode_event()
+#define GPS_NOTIFY_MODE   0x02
+
 /// struct voor taak-gegevens, waaronder de argumenten om een taak aan te maken
 typedef struct TaskData
 {
@@ -50,16 +70,24 @@ typedef struct TaskData
 /// alle handles
 /// handle voor UART-queue
 extern QueueHandle_t 	  hUART_Queue;
-/// handle voor GPS-queue
-extern QueueHandle_t 	  hGPS_Queue;
+/// handle voor GPS-messagebuffer, hele NMEA-zinnen van de UART4-interrupt
+extern MessageBufferHandle_t hGPS_MsgBuf;
+/// handle voor telemetrie-messagebuffer, binaire records naar Telemetry_task
+extern MessageBufferHandle_t hTLM_MsgBuf;
+#if APP_PROFILE == APP_PROFILE_DEMO
 /// handle voor LED-mutex
 extern SemaphoreHandle_t  hLED_Sem;
-/// handle voor ARM-keys-event
+#endif
+#if APP_PROFILE == APP_PROFILE_DEMO
+/// handle voor ARM-keys-event, van de keypad-scanner naar ARM_keys_IRQ
 extern EventGroupHandle_t hKEY_Event;
+#endif
 /// handle voor software timer
 extern TimerHandle_t      hTimer1;
-/// handle voor GPS parser Mutex
-extern SemaphoreHandle_t  hGPS_Mutex;
+/// handle voor de keypad-scanner (keyscan.c), loopt alleen zolang een toets ingedrukt is
+extern TimerHandle_t      hKeyScan;
+/// handle voor de buzzer-patronen (beeper.c), one-shot, loopt alleen tijdens een patroon
+extern TimerHandle_t      hBeeper;
 
 
 /// debug naar uart output, zie uart_keys.c
@@ -99,6 +127,7 @@ extern void DisplayMenu    (void);
 extern void error_HaltOS   (char *);
 
 // tasks.c
+extern TASKDATA     tasks[];
 extern void         DisplayTaskData (void);
 extern void         CreateTasks     (void);
 extern osThreadId_t GetTaskhandle   (char *);
@@ -108,15 +137,20 @@ extern void         StartStopTask   (int);
 // handles.c
 extern void         CreateHandles   (void);
 
+#if APP_PROFILE == APP_PROFILE_DEMO
 // LEDS.c
 extern void LED_Task1   (void *);
 extern void LED_Task2   (void *);
 extern void LED_Task3   (void *);
 extern void LED_Task4   (void *);
+extern unsigned int os_delay;
+#endif
 
+#if APP_PROFILE == APP_PROFILE_DEMO
 // ARM_keys.c
 extern void ARM_keys_IRQ (void *);
 extern void ARM_keys_task(void *);
+#endif
 
 // UART_keys.c
 extern void UART_keys_poll(void *);
@@ -124,10 +158,16 @@ extern void UART_keys_IRQ (void *);
 extern void UART_menu     (void *);
 
 // gps.c
-extern void GPS_getNMEA (void *);
+extern void GPS_getNMEA     (void *);
+extern void GPS_rx_byte_ISR (char, BaseType_t *);
+extern void GPS_rx_bytes    (const uint8_t *, uint32_t);
+extern void GPS_rx_select   (int);
+extern void GPS_rx_report   (void);
 
+#if APP_PROFILE == APP_PROFILE_DEMO
 // student.c
 extern void Student_task1 (void *);
+#endif
 
 // timer.c
 extern void Timer1_Handler(void);
@@ -138,4 +178,7 @@ extern void GPS_parser(void *);
 // NRF_driver.c
 extern void NRF_Driver(void *);
 
+// freertos.c
+extern uint32_t GetCPULoad(void);
+
 
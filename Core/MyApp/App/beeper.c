@@ -0,0 +1,154 @@
+/*
+ * beeper.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Buzzer alerts, see beeper.h. A pattern is a list of steps (tone, duration); the
+ * timer callback sets the tone of a step and reloads the one-shot timer with its
+ * duration, so between steps nothing runs. The queue is a ring of pattern numbers,
+ * guarded by masking interrupts for a few instructions, so BEEP_play() is O(1) from
+ * tasks and ISRs alike.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "beeper.h"
+
+typedef struct
+{
+	uint16_t hz;   // 0 = silence
+	uint16_t ms;   // 0 = end of the pattern
+} BEEP_STEP;
+
+static const BEEP_STEP beep_key[]    = { {2000,  30}, {0, 0} };
+static const BEEP_STEP beep_fix[]    = { {1200, 150}, {0, 60}, {800, 300}, {0, 0} };
+static const BEEP_STEP beep_radio[]  = { {1500,  60}, {0, 60}, {1500, 60}, {0, 60}, {1500, 60}, {0, 0} };
+static const BEEP_STEP beep_survey[] = { {1000, 100}, {1500, 100}, {2000, 200}, {0, 0} };
+
+static const BEEP_STEP *const patterns[eBEEP_COUNT] =
+{
+	[eBEEP_KEY]         = beep_key,
+	[eBEEP_FIX_LOST]    = beep_fix,
+	[eBEEP_RADIO_FAIL]  = beep_radio,
+	[eBEEP_SURVEY_DONE] = beep_survey,
+};
+
+static uint8_t          queue[BEEP_QUEUE_LEN];
+static uint32_t         q_head, q_count;  // guarded by the interrupt mask
+static int              busy = FALSE;     // the timer runs; guarded by the interrupt mask
+static const BEEP_STEP *step;             // timer callback only
+static uint32_t         played, dropped;
+
+
+/**
+ * @brief The timer command could not be queued (timer queue full): the sequencer
+ * will not run, so drop what is queued and let the next BEEP_play() start it again.
+ */
+static void beep_abort(void)
+{
+	UBaseType_t mask;
+
+	mask = taskENTER_CRITICAL_FROM_ISR();
+	dropped += q_count;
+	q_count  = 0;
+	busy     = FALSE;
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+
+/**
+ * @brief Queues a pattern; starts the sequencer if it is idle. Safe from any task
+ * or ISR (priority at or below configMAX_SYSCALL_INTERRUPT_PRIORITY).
+ */
+void BEEP_play(BEEP_PATTERN p)
+{
+	UBaseType_t mask;
+	BaseType_t  xHigherPriorityTaskWoken = pdFALSE;
+	BaseType_t  ok;
+	int         start = FALSE;
+
+	if (p >= eBEEP_COUNT || !hBeeper)
+		return;
+
+	mask = taskENTER_CRITICAL_FROM_ISR(); // only raises BASEPRI, so also fine in a task
+	if (q_count < BEEP_QUEUE_LEN)
+	{
+		queue[(q_head + q_count++) % BEEP_QUEUE_LEN] = p;
+		if (!busy)
+			busy = start = TRUE;
+	}
+	else
+		dropped++;
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+
+	if (!start)
+		return;
+
+	// the callback takes the pattern from the queue on the next tick
+	if (xPortIsInsideInterrupt())
+	{
+		ok = xTimerChangePeriodFromISR(hBeeper, 1, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	}
+	else
+		ok = xTimerChangePeriod(hBeeper, 1, 0);
+
+	if (ok != pdPASS)
+		beep_abort();
+}
+
+
+/**
+ * @brief Callback of hBeeper (one-shot): plays the next step, or the first step of
+ * the next queued pattern, or silences the buzzer if the queue is empty.
+ */
+void BEEP_tick(void)
+{
+	UBaseType_t mask;
+
+	if (step && step->ms)
+		step++;
+	if (!step || !step->ms)
+	{
+		mask = taskENTER_CRITICAL_FROM_ISR();
+		if (q_count)
+		{
+			step = patterns[queue[q_head]];
+			q_head = (q_head + 1) % BEEP_QUEUE_LEN;
+			q_count--;
+			played++;
+		}
+		else
+		{
+			step = NULL;
+			busy = FALSE;
+		}
+		taskEXIT_CRITICAL_FROM_ISR(mask);
+	}
+
+	if (!step)
+	{
+		BUZZER_tone(0);
+		return;
+	}
+	BUZZER_tone(step->hz);
+	if (xTimerChangePeriod(hBeeper, pdMS_TO_TICKS(step->ms), 0) != pdPASS)
+	{
+		BUZZER_tone(0);
+		step = NULL;
+		beep_abort();
+	}
+}
+
+
+/**
+ * @brief Displays the counters of the sequencer.
+ */
+void BEEP_report(void)
+{
+	UART_puts("\r\nbeeper: played ");  UART_putint(played);
+	UART_puts(", dropped (queue full, timer) "); UART_putint(dropped);
+	UART_puts(busy ? ", playing\r\n" : ", idle\r\n");
+}
@@ -0,0 +1,33 @@
+/*
+ * beeper.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Buzzer alerts: short tone patterns, queued and played by the callback of software
+ * timer hBeeper (admin.c) on the TIM3 PWM tone of buzzer.c. BEEP_play() only queues,
+ * so any task or ISR can raise an alert without waiting for the sound.
+ */
+
+#ifndef MYAPP_APP_BEEPER_H_
+#define MYAPP_APP_BEEPER_H_
+
+#include <stdint.h>
+
+/// patterns waiting behind the one that plays; more are dropped
+#define BEEP_QUEUE_LEN  4
+
+typedef enum
+{
+	eBEEP_KEY = 0,     // key click
+	eBEEP_FIX_LOST,    // broadcasting without a fix: two falling tones
+	eBEEP_RADIO_FAIL,  // corrections no longer acknowledged: three short beeps
+	eBEEP_SURVEY_DONE, // reference known: three rising tones
+	eBEEP_COUNT
+} BEEP_PATTERN;
+
+extern void BEEP_play  (BEEP_PATTERN p);
+extern void BEEP_tick  (void);
+extern void BEEP_report(void);
+
+#endif /* MYAPP_APP_BEEPER_H_ */
@@ -0,0 +1,207 @@
+/*
+ * config.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Configuration store, see config.h. The CONFIG flash region (sector 11, 128 KB, see
+ * the linker script) is used as a log of fixed-size slots: a save programs the next
+ * erased slot, the load takes the last slot with a valid magic, version, size and CRC.
+ * Only when the sector is full it is erased, so the erase (1-2 s, in which the CPU
+ * cannot read flash) is rare and a failed save never destroys the previous copy.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "config.h"
+#include <stddef.h> // offsetof
+#include <math.h>
+
+/// the CONFIG region of the linker script
+extern uint32_t _sconfig[], _econfig[];
+
+#define CONFIG_SECTOR  FLASH_SECTOR_11
+#define CONFIG_SLOT    ((sizeof(APP_CONFIG) + 3) & ~3U) // bytes per slot, whole words
+#define CONFIG_NSLOTS  (((uint32_t)_econfig - (uint32_t)_sconfig) / CONFIG_SLOT)
+#define CONFIG_SLOTPTR(n) ((const uint32_t *)((uint32_t)_sconfig + (n) * CONFIG_SLOT))
+
+APP_CONFIG cfg;
+
+static const APP_CONFIG cfg_defaults =
+{
+	.magic     = CONFIG_MAGIC,
+	.version   = CONFIG_VERSION,
+	.size      = sizeof(APP_CONFIG),
+	.radio     = NRF_RADIO_CFG_DEFAULTS,
+	.survey    = SURVEY_CFG_DEFAULTS,
+	.ref_index = 0,
+	.refs      =
+	{
+		{52.084619172, 5.168584982, NAN},
+		{52.000100, 4.000100, NAN},
+		{52.000200, 4.000200, NAN},
+		{52.000300, 4.000300, NAN}
+	}
+};
+
+static CONFIG_SOURCE cfg_source;
+static int32_t       cfg_slot = -1; // slot cfg was loaded from or saved to, -1 = none
+
+
+/**
+ * @brief CRC-32 (IEEE, reflected, poly 0xedb88320), bitwise; only used at boot and save.
+ */
+static uint32_t config_crc32(const void *data, uint32_t len)
+{
+	const uint8_t *p = data;
+	uint32_t       crc = 0xffffffffUL;
+	int            i;
+
+	while (len--)
+	{
+		crc ^= *p++;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 1 ? (crc >> 1) ^ 0xedb88320UL : crc >> 1);
+	}
+	return ~crc;
+}
+
+
+/**
+ * @brief Checks a slot: right magic, version and size, and a matching CRC.
+ */
+static int config_valid(const APP_CONFIG *c)
+{
+	return (c->magic   == CONFIG_MAGIC   &&
+	        c->version == CONFIG_VERSION &&
+	        c->size    == sizeof(APP_CONFIG) &&
+	        c->crc     == config_crc32(c, offsetof(APP_CONFIG, crc)));
+}
+
+
+/**
+ * @brief TRUE if slot n is still erased (all 0xff), so it can be programmed.
+ */
+static int config_erased(uint32_t n)
+{
+	const uint32_t *p = CONFIG_SLOTPTR(n);
+	uint32_t        i;
+
+	for (i = 0; i < CONFIG_SLOT / 4; i++)
+		if (p[i] != 0xffffffffUL)
+			return FALSE;
+	return TRUE;
+}
+
+
+/**
+ * @brief Loads cfg from the last valid slot, or the defaults. Call once at boot,
+ * before the tasks are created.
+ */
+void config_load(void)
+{
+	uint32_t n;
+
+	cfg        = cfg_defaults;
+	cfg_source = eCFG_DEFAULTS;
+	cfg_slot   = -1;
+
+	for (n = 0; n < CONFIG_NSLOTS && !config_erased(n); n++)
+		if (config_valid((const APP_CONFIG *)CONFIG_SLOTPTR(n)))
+			cfg_slot = n;
+
+	if (cfg_slot >= 0)
+	{
+		memcpy(&cfg, CONFIG_SLOTPTR(cfg_slot), sizeof(APP_CONFIG));
+		cfg_source = eCFG_FLASH;
+	}
+}
+
+
+/**
+ * @brief Writes cfg to the next erased slot; erases the sector first when it is full.
+ * @return TRUE if the slot reads back identical
+ */
+int config_save(void)
+{
+	FLASH_EraseInitTypeDef erase = { .TypeErase = FLASH_TYPEERASE_SECTORS, .Sector = CONFIG_SECTOR,
+	                                 .NbSectors = 1, .VoltageRange = FLASH_VOLTAGE_RANGE_3 };
+	uint32_t  buf[CONFIG_SLOT / 4];
+	uint32_t  n, i, sector_error;
+	int       ok = TRUE;
+
+	// a snapshot, so the CRC matches what is programmed
+	memset(buf, 0, sizeof(buf));
+	taskENTER_CRITICAL();
+	memcpy(buf, &cfg, sizeof(APP_CONFIG));
+	taskEXIT_CRITICAL();
+	((APP_CONFIG *)buf)->magic   = CONFIG_MAGIC;
+	((APP_CONFIG *)buf)->version = CONFIG_VERSION;
+	((APP_CONFIG *)buf)->size    = sizeof(APP_CONFIG);
+	((APP_CONFIG *)buf)->crc     = config_crc32(buf, offsetof(APP_CONFIG, crc));
+
+	for (n = cfg_slot + 1; n < CONFIG_NSLOTS && !config_erased(n); n++)
+		;
+
+	HAL_FLASH_Unlock();
+	__HAL_FLASH_CLEAR_FLAG(FLASH_FLAG_EOP | FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR |
+	                       FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR);
+
+	if (n >= CONFIG_NSLOTS) // full: start over
+	{
+		n = 0;
+		if (HAL_FLASHEx_Erase(&erase, &sector_error) != HAL_OK)
+			ok = FALSE;
+	}
+
+	for (i = 0; ok && i < CONFIG_SLOT / 4; i++)
+		if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, (uint32_t)CONFIG_SLOTPTR(n) + 4 * i, buf[i]) != HAL_OK)
+			ok = FALSE;
+
+	HAL_FLASH_Lock();
+
+	if (ok && memcmp(CONFIG_SLOTPTR(n), buf, CONFIG_SLOT) == 0)
+	{
+		cfg.crc    = ((APP_CONFIG *)buf)->crc;
+		cfg_slot   = n;
+		cfg_source = eCFG_FLASH;
+		return TRUE;
+	}
+	cfg_slot = n; // a half-programmed slot is skipped by the next save and by config_load
+	return FALSE;
+}
+
+
+/**
+ * @brief Restores the defaults in RAM (not in flash, use config_save) and applies the
+ * radio settings. The reference position is used from the next boot on.
+ */
+void config_defaults(void)
+{
+	taskENTER_CRITICAL();
+	cfg = cfg_defaults;
+	taskEXIT_CRITICAL();
+	cfg_source = eCFG_DEFAULTS;
+	NRF_setRadio();
+}
+
+
+/**
+ * @brief Displays where the configuration came from and the flash usage.
+ */
+void config_report(void)
+{
+	UART_puts("\r\nConfiguration");
+	UART_puts("\r\n\t source: ");  UART_puts(cfg_source == eCFG_FLASH ? "flash" : "defaults");
+	UART_puts("\t version: ");     UART_putint(CONFIG_VERSION);
+	UART_puts("\t size: ");        UART_putint(sizeof(APP_CONFIG));
+	UART_puts("\r\n\t slot: ");
+	if (cfg_slot < 0)
+		UART_puts("-");
+	else
+		UART_putint(cfg_slot);
+	UART_puts(" of ");             UART_putint(CONFIG_NSLOTS);
+	UART_puts("\t ref: ");         UART_putint(cfg.ref_index);
+	UART_puts("\r\n");
+}
@@ -0,0 +1,53 @@
+/*
+ * config.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Runtime configuration: radio, survey-in and the reference positions. Loaded once
+ * at boot (config_load) from the CONFIG flash region into cfg, or the defaults if
+ * there is no valid copy. Tasks read cfg directly, without locks: a field only
+ * changes from the console (set, ref, defaults) and config_save() only reads it.
+ */
+
+#ifndef MYAPP_APP_CONFIG_H_
+#define MYAPP_APP_CONFIG_H_
+
+#include <stdint.h>
+#include "NRF_driver.h"
+#include "GPS_parser.h"
+
+/// 'DGPS'; a block without it is erased flash or something else
+#define CONFIG_MAGIC   0x53504744UL
+/// increment when APP_CONFIG changes; a stored block of another version is ignored (defaults)
+#define CONFIG_VERSION 2
+/// number of stored reference positions
+#define CONFIG_NREFS   4
+
+typedef struct
+{
+	uint32_t              magic;
+	uint16_t              version;
+	uint16_t              size;             // sizeof(APP_CONFIG)
+	NRF_RADIO_CFG         radio;
+	SURVEY_CFG            survey;
+	uint8_t               ref_index;        // reference used at boot, 0..CONFIG_NREFS-1
+	GPS_decimal_degrees_t refs[CONFIG_NREFS];
+	uint32_t              crc;              // CRC-32 over everything before it
+} APP_CONFIG;
+
+/// where cfg came from
+typedef enum
+{
+	eCFG_DEFAULTS = 0, // no valid block in flash
+	eCFG_FLASH         // a block from flash
+} CONFIG_SOURCE;
+
+extern APP_CONFIG cfg;
+
+extern void config_load    (void);
+extern int  config_save    (void);
+extern void config_defaults(void);
+extern void config_report  (void);
+
+#endif /* MYAPP_APP_CONFIG_H_ */
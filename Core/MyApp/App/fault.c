@@ -0,0 +1,274 @@
+/*
+ * fault.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Post-mortem capture, see fault.h. The fault handlers are defined here instead of in
+ * stm32f4xx_it.c (code generation of these handlers is off in the .ioc): they have to
+ * be naked to find the exception frame before the compiler touches the stack.
+ *
+ * The trace ring is filled by traceTASK_SWITCHED_IN (FreeRTOSConfig.h) and lives in
+ * the record itself, so after a reset it shows the last tasks that ran.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "fault.h"
+
+static FAULT_RECORD fault_record __attribute__((section(".noinit")));
+static FAULT_RECORD fault_last;     // the record as found at boot, cause FAULT_NONE if none
+
+static const char *fault_names[] = { "none", "HardFault", "MemManage", "BusFault", "UsageFault", "assert", "halt", "stack overflow" };
+
+
+/**
+ * @brief Common part of all causes: uptime, running task, count. Called with
+ * interrupts disabled.
+ */
+static void fault_fill(FAULT_CAUSE cause, int in_isr)
+{
+	TaskHandle_t h;
+
+	fault_record.cause     = cause;
+	fault_record.uptime_ms = HAL_GetTick();
+	fault_record.count++;
+
+	strcpy(fault_record.task, "-");
+	if (!in_isr && xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED && (h = xTaskGetCurrentTaskHandle()))
+	{
+		strncpy(fault_record.task, pcTaskGetName(h), sizeof(fault_record.task) - 1);
+		fault_record.task[sizeof(fault_record.task) - 1] = '\0';
+	}
+}
+
+
+/**
+ * @brief Copies the tail of s, so a long path keeps its file name.
+ */
+static void fault_text(const char *s)
+{
+	size_t len = strlen(s);
+
+	if (len >= sizeof(fault_record.text))
+		s += len - (sizeof(fault_record.text) - 1);
+	strcpy(fault_record.text, s);
+}
+
+
+/**
+ * @brief C part of the fault handlers.
+ * @param frame The exception frame (r0-r3, r12, lr, pc, xpsr)
+ * @param exc_return LR at exception entry
+ */
+void fault_exception(uint32_t *frame, uint32_t exc_return) __attribute__((used, noreturn));
+void fault_exception(uint32_t *frame, uint32_t exc_return)
+{
+	uint32_t vector = SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk; // 3..6
+
+	__disable_irq();
+
+	memset(&fault_record.r0, 0, (uint8_t *)&fault_record.trace_pos - (uint8_t *)&fault_record.r0);
+	fault_fill((FAULT_CAUSE)(vector - 2), !(exc_return & 8)); // bit 3: 0 = fault in handler mode
+
+	// an overflowed stack can point anywhere; do not fault again in here
+	if (((uint32_t)frame >= SRAM1_BASE   && (uint32_t)frame <= SRAM1_BASE + 0x20000 - 32) ||
+	    ((uint32_t)frame >= CCMDATARAM_BASE && (uint32_t)frame <= CCMDATARAM_END - 31))
+	{
+		fault_record.r0  = frame[0];
+		fault_record.r1  = frame[1];
+		fault_record.r2  = frame[2];
+		fault_record.r3  = frame[3];
+		fault_record.r12 = frame[4];
+		fault_record.lr  = frame[5];
+		fault_record.pc  = frame[6];
+		fault_record.psr = frame[7];
+	}
+	fault_record.cfsr  = SCB->CFSR;
+	fault_record.hfsr  = SCB->HFSR;
+	fault_record.mmfar = SCB->MMFAR;
+	fault_record.bfar  = SCB->BFAR;
+
+	NVIC_SystemReset();
+}
+
+
+/**
+ * @brief HardFault, MemManage, BusFault and UsageFault: pass the frame of the stack
+ * that was in use (MSP or PSP, bit 2 of EXC_RETURN) to fault_exception().
+ */
+__attribute__((naked)) void HardFault_Handler(void)
+{
+	__asm volatile
+	(
+		" tst   lr, #4            \n"
+		" ite   eq                \n"
+		" mrseq r0, msp           \n"
+		" mrsne r0, psp           \n"
+		" mov   r1, lr            \n"
+		" b     fault_exception   \n"
+	);
+}
+
+void MemManage_Handler (void) __attribute__((naked, alias("HardFault_Handler")));
+void BusFault_Handler  (void) __attribute__((naked, alias("HardFault_Handler")));
+void UsageFault_Handler(void) __attribute__((naked, alias("HardFault_Handler")));
+
+
+/**
+ * @brief configASSERT failed.
+ */
+void FAULT_assert(const char *file, int line)
+{
+	__disable_irq();
+	memset(&fault_record.r0, 0, (uint8_t *)&fault_record.trace_pos - (uint8_t *)&fault_record.r0);
+	fault_fill(FAULT_ASSERT, (__get_IPSR() != 0));
+	fault_text(file);
+	fault_record.line = line;
+	NVIC_SystemReset();
+}
+
+
+/**
+ * @brief Error_Handler or error_HaltOS: the application cannot continue.
+ * @param pc Address of the caller, __builtin_return_address(0)
+ */
+void FAULT_halt(const char *text, uint32_t pc)
+{
+	__disable_irq();
+	memset(&fault_record.r0, 0, (uint8_t *)&fault_record.trace_pos - (uint8_t *)&fault_record.r0);
+	fault_fill(FAULT_HALT, (__get_IPSR() != 0));
+	fault_text(text);
+	fault_record.pc = pc;
+	NVIC_SystemReset();
+}
+
+
+/**
+ * @brief configCHECK_FOR_STACK_OVERFLOW (method 2): the stack pointer of xTask went past
+ * its stack, or the fill pattern at the end was overwritten. Called from the PendSV
+ * handler when the task is switched out; replaces the weak dummy of cmsis_os2.c.
+ */
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
+{
+	(void)xTask;
+	__disable_irq();
+	memset(&fault_record.r0, 0, (uint8_t *)&fault_record.trace_pos - (uint8_t *)&fault_record.r0);
+	fault_fill(FAULT_STACK, TRUE);
+	strncpy(fault_record.task, pcTaskName, sizeof(fault_record.task) - 1);
+	fault_record.task[sizeof(fault_record.task) - 1] = '\0';
+	NVIC_SystemReset();
+}
+
+
+/**
+ * @brief traceTASK_SWITCHED_IN: adds the task to the trace ring if it is another one
+ * than the last entry. Runs in the PendSV handler.
+ */
+void FAULT_trace_switch(void)
+{
+	const char  *name = pcTaskGetName(NULL);
+	FAULT_TRACE *last = &fault_record.trace[(fault_record.trace_pos + FAULT_TRACE_LEN - 1) % FAULT_TRACE_LEN];
+
+	if (!strncmp(last->task, name, sizeof(last->task)))
+		return;
+
+	last = &fault_record.trace[fault_record.trace_pos];
+	strncpy(last->task, name, sizeof(last->task));
+	last->tick = xTaskGetTickCountFromISR();
+	fault_record.trace_pos = (fault_record.trace_pos + 1) % FAULT_TRACE_LEN;
+}
+
+
+/**
+ * @brief Checks the record at boot and reports a fault from before the reset.
+ * Also enables the separate MemManage, BusFault and UsageFault exceptions, so the
+ * record shows the real cause instead of an escalated HardFault. Call before the
+ * scheduler starts.
+ */
+void FAULT_init(void)
+{
+	if ((RCC->CSR & (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF)) || fault_record.magic != FAULT_RECORD_MAGIC ||
+	    fault_record.trace_pos >= FAULT_TRACE_LEN)
+	{
+		memset(&fault_record, 0, sizeof(fault_record)); // RAM content is random after power-on
+		fault_record.magic = FAULT_RECORD_MAGIC;
+	}
+
+	fault_last = fault_record;
+	fault_record.cause = FAULT_NONE; // reported
+
+	SCB->SHCSR |= SCB_SHCSR_MEMFAULTENA_Msk | SCB_SHCSR_BUSFAULTENA_Msk | SCB_SHCSR_USGFAULTENA_Msk;
+
+	if (fault_last.cause != FAULT_NONE)
+		FAULT_report();
+}
+
+
+/**
+ * @brief Prints a hex word as 0x........
+ */
+static void fault_hex(const char *label, uint32_t v)
+{
+	int i;
+
+	UART_puts(label); UART_puts("=0x");
+	for (i = 28; i >= 0; i -= 4)
+		UART_putnum((v >> i) & 0x0f, 16);
+}
+
+
+/**
+ * @brief Displays the fault from before the last reset, compact.
+ */
+void FAULT_report(void)
+{
+	const FAULT_TRACE *t;
+	char               name[5];
+	uint32_t           i;
+
+	UART_puts("\r\nFault ");
+	if (fault_last.cause == FAULT_NONE || fault_last.cause > FAULT_STACK)
+	{
+		UART_puts("none, total since power-on: "); UART_putint(fault_last.count); UART_puts("\r\n");
+		return;
+	}
+
+	UART_putint(fault_last.count); UART_puts(": ");
+	UART_puts(fault_names[fault_last.cause]);
+	UART_puts(" in ");          UART_puts(fault_last.task);
+	UART_puts(" at ");          UART_putint(fault_last.uptime_ms); UART_puts(" ms");
+	if (fault_last.text[0])
+	{
+		UART_puts(", ");        UART_puts(fault_last.text);
+		if (fault_last.line)
+		{
+			UART_puts(":");     UART_putint(fault_last.line);
+		}
+	}
+
+	fault_hex("\r\n pc", fault_last.pc);   fault_hex(" lr", fault_last.lr);
+	fault_hex(" psr", fault_last.psr);
+	if (fault_last.cause <= FAULT_USAGE)
+	{
+		fault_hex("\r\n r0", fault_last.r0);   fault_hex(" r1", fault_last.r1);
+		fault_hex(" r2", fault_last.r2);       fault_hex(" r3", fault_last.r3);
+		fault_hex(" r12", fault_last.r12);
+		fault_hex("\r\n cfsr", fault_last.cfsr); fault_hex(" hfsr", fault_last.hfsr);
+		fault_hex(" mmfar", fault_last.mmfar);   fault_hex(" bfar", fault_last.bfar);
+	}
+
+	UART_puts("\r\n trace:");
+	name[4] = '\0';
+	for (i = 0; i < FAULT_TRACE_LEN; i++) // oldest first
+	{
+		t = &fault_last.trace[(fault_last.trace_pos + i) % FAULT_TRACE_LEN];
+		if (!t->task[0])
+			continue;
+		memcpy(name, t->task, 4);
+		UART_puts(" ");  UART_puts(name);
+		UART_puts("@");  UART_putint(t->tick);
+	}
+	UART_puts("\r\n");
+}
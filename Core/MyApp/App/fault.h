@@ -0,0 +1,61 @@
+/*
+ * fault.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Post-mortem capture: a fault exception, a failed configASSERT, a stack overflow,
+ * Error_Handler or error_HaltOS writes a FAULT_RECORD into no-init RAM and resets the board at once.
+ * The next boot prints the record (FAULT_init) and keeps a copy for 'fault'.
+ */
+
+#ifndef MYAPP_APP_FAULT_H_
+#define MYAPP_APP_FAULT_H_
+
+#include <stdint.h>
+
+/// task switches kept in the trace ring
+#define FAULT_TRACE_LEN  16
+#define FAULT_RECORD_MAGIC 0x544c5546UL // 'FULT'
+
+typedef enum
+{
+	FAULT_NONE = 0,
+	FAULT_HARD,        // HardFault (incl. escalated faults)
+	FAULT_MEMMANAGE,
+	FAULT_BUS,
+	FAULT_USAGE,
+	FAULT_ASSERT,      // configASSERT: text = file, line
+	FAULT_HALT,        // Error_Handler or error_HaltOS: text = message, pc = caller
+	FAULT_STACK        // configCHECK_FOR_STACK_OVERFLOW: task = the task that overflowed
+} FAULT_CAUSE;
+
+/// one entry of the trace ring: a task that was switched in
+typedef struct
+{
+	char     task[4];  // first 4 chars of the name, not terminated
+	uint32_t tick;
+} FAULT_TRACE;
+
+typedef struct
+{
+	uint32_t    magic;
+	uint32_t    count;               // faults since power-on
+	uint32_t    cause;               // FAULT_CAUSE, FAULT_NONE = nothing to report
+	uint32_t    r0, r1, r2, r3, r12, lr, pc, psr; // stacked by the exception
+	uint32_t    cfsr, hfsr, mmfar, bfar;
+	uint32_t    uptime_ms;
+	uint32_t    line;
+	char        text[24];
+	char        task[16];            // running task, "-" before the scheduler or in an ISR
+	uint32_t    trace_pos;           // next entry of trace[]
+	FAULT_TRACE trace[FAULT_TRACE_LEN];
+} FAULT_RECORD;
+
+extern void FAULT_init        (void);
+extern void FAULT_report      (void);
+extern void FAULT_trace_switch(void);
+extern void FAULT_assert      (const char *file, int line) __attribute__((noreturn));
+extern void FAULT_halt        (const char *text, uint32_t pc) __attribute__((noreturn));
+
+#endif /* MYAPP_APP_FAULT_H_ */
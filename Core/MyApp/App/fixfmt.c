@@ -0,0 +1,166 @@
+/*
+ * fixfmt.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Small fixed-point formatter for coordinates, errors and counters, see fixfmt.h.
+ * A value is split in a 32-bit integer part and a 32-bit scaled fraction; only that
+ * split uses (double) arithmetic, the digits are written with integer divides.
+ * The fraction times 10^decimals is generally not a double, so it is kept exactly as
+ * the rounded product plus its error (Dekker), and rounded half to even on that exact
+ * value, like printf. Plain double operations only: the newlib fma() of the target is
+ * not exact. Checked against glibc printf by Tools/hosttest/fixfmt_test.c.
+ */
+
+#include <math.h>
+#include "fixfmt.h"
+
+static const uint32_t pow10_u32[FIXFMT_MAXDEC + 1] =
+	{ 1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL, 1000000UL, 10000000UL, 100000000UL, 1000000000UL };
+
+
+/**
+ * @brief Exact product: x * y == *hi + *lo, with *hi the rounded product. Veltkamp
+ * split in 26-bit halves, so every partial product is exact.
+ */
+static void mul_exact(double x, double y, double *hi, double *lo)
+{
+	double c, xh, xl, yh, yl;
+
+	c  = 134217729.0 * x; // 2^27 + 1
+	xh = c - (c - x);
+	xl = x - xh;
+	c  = 134217729.0 * y;
+	yh = c - (c - y);
+	yl = y - yh;
+
+	*hi = x * y;
+	*lo = (((xh * yh - *hi) + xh * yl) + xl * yh) + xl * yl;
+}
+
+
+/**
+ * @brief Writes v in decimal.
+ */
+char *fmt_u32(char *buf, uint32_t v)
+{
+	char tmp[10];
+	int  n = 0;
+
+	do
+	{
+		tmp[n++] = '0' + v % 10;
+		v /= 10;
+	} while (v);
+
+	while (n)
+		*buf++ = tmp[--n];
+	*buf = '\0';
+	return buf;
+}
+
+
+/**
+ * @brief Writes v in decimal, with a sign if negative (or FIXFMT_PLUS).
+ */
+char *fmt_i32(char *buf, int32_t v, int flags)
+{
+	if (v < 0)
+	{
+		*buf++ = '-';
+		return fmt_u32(buf, 0UL - (uint32_t)v);
+	}
+	if (flags & FIXFMT_PLUS)
+		*buf++ = '+';
+	return fmt_u32(buf, (uint32_t)v);
+}
+
+
+/**
+ * @brief Copies s; returns the '\0' so labels and numbers can be chained.
+ */
+char *fmt_str(char *buf, const char *s)
+{
+	while (*s)
+		*buf++ = *s++;
+	*buf = '\0';
+	return buf;
+}
+
+
+/**
+ * @brief Writes v with a fixed number of decimals, as printf("%.<decimals>f").
+ * @param decimals 0..FIXFMT_MAXDEC
+ */
+char *fmt_double(char *buf, double v, int decimals, int flags)
+{
+	uint32_t ip, fp, scale;
+	double   a, f, err, d;
+	int      i;
+
+	if (decimals < 0)
+		decimals = 0;
+	if (decimals > FIXFMT_MAXDEC)
+		decimals = FIXFMT_MAXDEC;
+	scale = pow10_u32[decimals];
+
+	if (isnan(v))
+		return fmt_str(buf, "nan");
+
+	if (signbit(v))
+		*buf++ = '-';
+	else if (flags & FIXFMT_PLUS)
+		*buf++ = '+';
+
+	a = fabs(v);
+	if (!(a < 4294967295.0))
+		return fmt_str(buf, isinf(v) ? "inf" : "ovf");
+
+	// split; a - ip is exact, the scaled fraction is f + err exactly
+	ip = (uint32_t)a;
+	f  = a - ip;
+	if (f < 1e-30) // far below half a unit of the last decimal, and the split would underflow
+		f = err = 0.0;
+	else
+		mul_exact(f, scale, &f, &err);
+
+	fp = (uint32_t)f; // f < 2^30
+	d  = f - fp;      // exact
+	if (d == 0.0 && err < 0.0) // f rounded up to an integer
+	{
+		fp--;
+		d = 1.0;
+	}
+	d = (d - 0.5) + err; // sign is exact: d - 0.5 is exact when it matters (d >= 0.25)
+	if (d > 0.0 || (d == 0.0 && ((decimals ? fp : ip) & 1))) // round half to even
+		fp++;
+	if (fp >= scale) // 9.9996 -> "10.000"
+	{
+		fp -= scale;
+		ip++;
+	}
+
+	buf = fmt_u32(buf, ip);
+	if (!decimals)
+		return buf;
+
+	*buf++ = '.';
+	for (i = decimals - 1; i >= 0; i--)
+	{
+		buf[i] = '0' + fp % 10;
+		fp /= 10;
+	}
+	buf += decimals;
+	*buf = '\0';
+	return buf;
+}
+
+
+/**
+ * @brief fmt_double for a float, which is exact in double.
+ */
+char *fmt_float(char *buf, float v, int decimals, int flags)
+{
+	return fmt_double(buf, (double)v, decimals, flags);
+}
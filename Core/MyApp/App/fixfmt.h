@@ -0,0 +1,34 @@
+/*
+ * fixfmt.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_FIXFMT_H_
+#define MYAPP_APP_FIXFMT_H_
+
+#include <stdint.h>
+
+/// buffer size that holds any fixfmt result: sign, 10 integer digits, '.', 9 decimals, '\0'
+#define FIXFMT_MAXLEN   24
+/// most decimals fmt_float/fmt_double write
+#define FIXFMT_MAXDEC   9
+
+/// flags
+#define FIXFMT_PLUS     0x01 // '+' in front of positive values, like "%+"
+
+/**
+ * @brief Number to text without snprintf: integer arithmetic, no varargs, no locale,
+ * no heap and only a few words of stack. Output matches printf("%.<dec>f"); values
+ * whose integer part does not fit 32 bits are written as "ovf".
+ * All functions write a '\0'-terminated string to buf and return a pointer to the
+ * '\0', so results can be chained: p = fmt_float(p, x, 2, 0); *p++ = ' '; ...
+ */
+extern char *fmt_u32   (char *buf, uint32_t v);
+extern char *fmt_i32   (char *buf, int32_t v, int flags);
+extern char *fmt_float (char *buf, float v, int decimals, int flags);
+extern char *fmt_double(char *buf, double v, int decimals, int flags);
+extern char *fmt_str   (char *buf, const char *s);
+
+#endif /* MYAPP_APP_FIXFMT_H_ */
@@ -1,9 +1,11 @@
 /**
 * @file gps.c
-* @brief Behandelt de gps input-strings (NMEA-protocol) van UART1.<br>
-* <b>Demonstreert: xMessageBufferRead() </b><br>
-* Aan UART1 is een interrupt gekoppeld (zie main.c: HAL_UART_RxCpltCallback(),
-* die de inkomende string op een messagebuffer zet, die we hier uitlezen en verwerken.<br>
+* @brief Behandelt de gps input-strings (NMEA-protocol) van UART4.<br>
+* <b>Demonstreert: xMessageBufferSendFromISR(), xMessageBufferReceive() </b><br>
+* Aan UART4 is een interrupt gekoppeld (zie main.c: HAL_UART_RxCpltCallback(),
+* die via GPS_rx_byte_ISR() de inkomende zinnen op een messagebuffer zet, die we hier uitlezen en verwerken.<br>
+* Een GNSS-ontvanger op de USB-poort (CDC, zie GPS_usb.c) levert via GPS_rx_bytes() op dezelfde
+* messagebuffer; zolang die actief is wordt UART4 genegeerd.<br>
 * @author MSC
 *
 * @date 5/5/2023
@@ -12,42 +14,26 @@
 #include "main.h"
 #include "cmsis_os.h"
 #include "gps.h"
+#include "NMEA.h"
+#include "GPS_bus.h"
+#include "telemetry.h"
+#include "supervisor.h"
+#include "ledstatus.h"
+#include "GPS_usb.h"
+#include "logger.h"
+#include <math.h>
 
 
-GNRMC gnrmc; // global struct for GNRMC-messages
-
-static GNRMC bufferA;
-static GNRMC bufferB;
-
-static GNRMC *volatile frontendBuffer = &bufferA; 
-static GNRMC *volatile backendBuffer  = &bufferB; 
-
-/**
- * @brief Function that copies the latest GNRMC data into the provided destination struct.
- * 
- * @param dest pointer of type GNRMC that will be pointing to the latest GNRMC data
- * @return void
- */
-void GPS_getLatestGNRMC(GNRMC *dest)
-{
-	if(xSemaphoreTake(hGPS_Mutex, portMAX_DELAY) == pdTRUE)
-	{
-		*dest = *frontendBuffer;
-		xSemaphoreGive(hGPS_Mutex); // Release the mutex
-	}
-	else
-	{
-		error_HaltOS("Err:GPS_mutex");
-	}
-}
-
 /**
  * @brief Checks the GPS fix status and updates the green LED accordingly.
  * If the GPS status is 'A' (valid), the green LED is turned on, otherwise it is turned off.
+ * @param fix The epoch that was just decoded
  */
-void check_gpsfix()
+void check_gpsfix(GPS_FIX *fix)
 {
-	if(gnrmc.status == 'A') // If status is 'A' (valid)
+	LEDSTAT_fix(fix->status == 'A');
+
+	if(fix->status == 'A') // If status is 'A' (valid)
 	{
 		HAL_GPIO_WritePin(GPIOD, LEDGREEN, GPIO_PIN_SET); // Turn on green LED for GPS LOCK
 	}
@@ -57,185 +43,277 @@ void check_gpsfix()
 	}
 }
 
+
+/// laatste kwaliteitsgegevens, worden met de volgende RMC mee gepubliceerd
+static NMEA_GGA last_gga;
+static NMEA_GSA last_gsa;
+static NMEA_GST last_gst;
+
+
 /**
-* @brief De chars van de binnengekomen GNRMC-string worden in data omgezet, dwz in een
-* GNRMC-struct, mbv strtok(); De struct bevat nu alleen chars - je kunt er ook voor kiezen
-* om gelijk met doubles te werken, die je dan met atof(); omzet.
+* @brief Zet een gedecodeerde RMC-zin, samen met de laatste GGA/GSA/GST, om in een GPS_FIX
+* en publiceert die op de GPS-bus.
+* @param rmc De door NMEA_decode() gevulde RMC-struct
 * @return void
 */
-void fill_GNRMC(char *message)
+void fill_GNRMC(NMEA_RMC *rmc)
 {
 	// example: $GNRMC,164435.000,A,5205.9505,N,00507.0873,E,0.49,21.70,140423,,,A
-	//          id    , time     ,s,
+	GPS_FIX  fix;
+
+	memset(&fix, 0, sizeof(fix));
+	fix.time      = rmc->time;
+	fix.status    = (rmc->status ? rmc->status : 'V');
+	fix.latitude  = rmc->latitude;
+	fix.longitude = rmc->longitude;
+	fix.speed     = rmc->speed;
+	fix.course    = rmc->course;
+	fix.altitude  = (last_gga.quality ? last_gga.altitude : NAN);
+	fix.quality   = last_gga.quality;
+	fix.numsv     = last_gga.numsv;
+	fix.hdop      = last_gga.hdop;
+	fix.vdop      = last_gsa.vdop;
+	fix.pdop      = last_gsa.pdop;
+	fix.std_lat   = last_gst.std_lat;
+	fix.std_lon   = last_gst.std_lon;
+	fix.std_alt   = last_gst.std_alt;
 
-	osThreadId_t hTask;
-
-	// UART_puts("filling GNRMC\r\n");
+	if (Uart_debug_out & GPS_DEBUG_OUT)
+	{
+		char status[2] = { fix.status, '\0' }; // a string, so UART_text_hook sees it too
 
-	char *tok = ",";
-	char *s;
+		UART_puts("\r\n\t status: \t\t");  UART_puts(status);
+		UART_puts("\r\n\t satellites:\t");  UART_putint(fix.numsv);
+		UART_puts("\r\n\t hdop x100:\t");   UART_putint((int)(fix.hdop * 100));
+	}
 
-	GNRMC *localBuffer = backendBuffer;
+	// Check and update GPS fix status
+	check_gpsfix(&fix);
 
-	/* clear the struct pointed to by localBuffer (not the pointer variable itself) */
-	memset(localBuffer, 0, sizeof(GNRMC)); // clear the struct
+	// Publish and wake the subscribers; they block on their notification value instead of polling
+	fix.stamp = tlm_stamp();
+	fix.seq   = GPS_bus_publish(&fix);
+	tlm_fix(&fix);
+}
 
-	s = strtok(message, tok); // 0. header;
-	strcpy(localBuffer->head, s);
 
-	s = strtok(NULL, tok);    // 1. time; not used
+/// ontvangst-tellers, zie GPS_rx_report()
+static volatile uint32_t rx_sentences;  // zinnen op de messagebuffer gezet
+static volatile uint32_t rx_filtered;   // zinnen van een type dat we niet willen
+static volatile uint32_t rx_too_long;   // zinnen langer dan GPS_MAXLEN
+static volatile uint32_t rx_dropped;    // zinnen weggegooid, messagebuffer vol
+static volatile uint32_t rx_cs_errors;  // zinnen met een foute checksum
+static volatile uint32_t rx_muted;      // UART4-chars genegeerd omdat een USB-ontvanger actief is
 
-	s = strtok(NULL, tok);    // 2. valid;
-	localBuffer->status = s[0];
+/// toestand van de NMEA-framer; een per bron, zodat de zinnen van UART4 en USB niet mengen
+typedef struct
+{
+	char buff[GPS_MAXLEN]; // zin in opbouw
+	int  pos;
+	int  in_msg;           // zitten we in een zin (na een '$')?
+} GPS_FRAMER;
 
-	s = strtok(NULL, tok);    // 3. latitude;
-	strcpy(localBuffer->latitude, s);
+static GPS_FRAMER   uart_framer, usb_framer;
+static volatile int rx_usb = FALSE;    // de zinnen komen van de USB-ontvanger (GPS_usb.c)
 
-	s = strtok(NULL, tok);    // 4. N/S; not used
 
-	s = strtok(NULL, tok);    // 5. longitude;
-	if (s[0] == '0') // if leading '0' is present, remove it
-		memmove(s, s + 1, strlen(s)); // remove leading '0' if present
-	strcpy(localBuffer->longitude, s);
+/**
+* @brief Voegt een char toe aan de zin in opbouw van een framer.
+* @param f De framer van de bron
+* @param c De ontvangen char
+* @return De lengte van de zin (zonder CR) als c de zin afsluit en we die willen, anders 0
+*/
+static int gps_frame(GPS_FRAMER *f, char c)
+{
+	if (c == '$') // gotcha, new datastring started
+	{
+		f->pos = 0;
+		f->in_msg = TRUE; // from now on, chars are valid to receive
+	}
 
-	s = strtok(NULL, tok);    // 6. E/W; not used
+	if (f->in_msg == FALSE) // char only valid if started by $
+		return 0;
 
-	s = strtok(NULL, tok);    // 7. speed;
-	strcpy(localBuffer->speed, s);
+	if (f->pos >= GPS_MAXLEN - 1) // avoid overflow: no CR within the NMEA limit
+	{
+		f->in_msg = FALSE;
+		rx_too_long++;
+		return 0;
+	}
 
-	s = strtok(NULL, tok);    // 8. course;
-	strcpy(localBuffer->course, s);
+	f->buff[f->pos] = c;
 
-	if (Uart_debug_out & GPS_DEBUG_OUT)
+	// if pos==5, the message type (f.i. "$GPGSA) is complete; skip the rest if we don't want it
+	if (f->pos == 5 && !NMEA_lookup(f->buff))
 	{
-		UART_puts("\r\n\t GPS type: \t");  UART_puts(localBuffer->head);
-		UART_puts("\r\n\t status: \t\t");  UART_putchar(localBuffer->status);
-		UART_puts("\r\n\t latitude:\t\t"); UART_puts(localBuffer->latitude);
-		UART_puts("\r\n\t longitude:\t");  UART_puts(localBuffer->longitude);
-		UART_puts("\r\n\t speed:    \t");  UART_puts(localBuffer->speed);
-		UART_puts("\r\n\t course:   \t");  UART_puts(localBuffer->course);
+		f->in_msg = FALSE;
+		rx_filtered++;
+		return 0;
 	}
 
-	if(xSemaphoreTake(hGPS_Mutex, portMAX_DELAY) == pdTRUE)
+	if (c == '\r') // end of message encountered - all messages end with <CR-13><LF-10>
 	{
-		GNRMC *tempbuf = backendBuffer;
-		backendBuffer = frontendBuffer;
-		frontendBuffer = tempbuf;
-		xSemaphoreGive(hGPS_Mutex); // release the mutex after swapping buffers
+		f->in_msg = FALSE;
+		return (f->pos > 5 ? f->pos : 0); // shorter: the tag was never checked (line noise, "$GN\r")
 	}
+	f->pos++;
+	return 0;
+}
+
+
+/**
+* @brief Zet een hele zin op hGPS_MsgBuf. Alleen vanuit een ISR of met de interrupts
+* gemaskeerd: de messagebuffer mag maar 1 schrijver tegelijk hebben.
+*/
+static void gps_send(const char *msg, int len, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if (xMessageBufferSendFromISR(hGPS_MsgBuf, msg, len, pxHigherPriorityTaskWoken))
+		rx_sentences++;
 	else
+		rx_dropped++; // GPS_getNMEA() is a full buffer behind
+}
+
+
+/**
+* @brief NMEA-framer, aangeroepen vanuit HAL_UART_RxCpltCallback() voor elke char van UART4.
+* Bouwt een zin op van '$' tot en met CR; alleen gewenste zinnen worden in zijn geheel
+* op hGPS_MsgBuf gezet, zodat GPS_getNMEA() maar 1 keer per zin wakker wordt.
+* Zolang een USB-ontvanger de zinnen levert wordt UART4 genegeerd.
+* @param c De ontvangen char
+* @param pxHigherPriorityTaskWoken Wordt pdTRUE als de GPS-taak gewekt moet worden
+* @return void
+*/
+void GPS_rx_byte_ISR(char c, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	int len;
+
+	if (rx_usb)
 	{
-		error_HaltOS("Err:GPS_mutex");
+		rx_muted++;
+		return;
 	}
+	LOG_raw(LOG_RAW_UART, (uint8_t *)&c, 1);
+	if ((len = gps_frame(&uart_framer, c)))
+		gps_send(uart_framer.buff, len, pxHigherPriorityTaskWoken);
+}
 
-	// Check and update GPS fix status
-	check_gpsfix();
-	// // Notify the GPS_parser task that new data is available
-	// if (!(hTask = xTaskGetHandle("GPS_parser")))
-	// 			error_HaltOS("Err:ARM_hndle");
-	// xTaskNotifyGive(hTask);
-
-	//Notify the GPS_errorcalc task that new data is available
-	if (!(hTask = xTaskGetHandle("GPS_Errorcalc")))
-				error_HaltOS("Err:GPSError_hndle");
-	xTaskNotifyGive(hTask);
+
+/**
+* @brief Dezelfde framer voor een blok chars van de USB-ontvanger, vanuit de USB-host-taak.
+* Alleen het op de messagebuffer zetten gebeurt met de interrupts gemaskeerd, zodat het
+* niet botst met GPS_rx_byte_ISR().
+* @param data De ontvangen chars
+* @param n Het aantal
+* @return void
+*/
+void GPS_rx_bytes(const uint8_t *data, uint32_t n)
+{
+	BaseType_t  xHigherPriorityTaskWoken = pdFALSE;
+	UBaseType_t mask;
+	int         len;
+
+	LOG_raw(LOG_RAW_USB, data, n);
+	while (n--)
+	{
+		if (!(len = gps_frame(&usb_framer, *data++)))
+			continue;
+		mask = taskENTER_CRITICAL_FROM_ISR();
+		gps_send(usb_framer.buff, len, &xHigherPriorityTaskWoken);
+		taskEXIT_CRITICAL_FROM_ISR(mask);
+	}
+	if (xHigherPriorityTaskWoken != pdFALSE)
+		taskYIELD();
 }
 
 
 /**
-* @brief Leest de GPS-NMEA-strings die via de UART via interrupt-handler (HAL_UART_RxCpltCallback)
-* binnenkomen. * De handler zet elk inkomende character gelijk op een queue, die hier uitgelezen wordt.
-* Vervolgens wordt hiervan een GPS-message opgebouwd en verwerkt.
+* @brief Kiest de bron van de zinnen: de USB-ontvanger (usb TRUE) of UART4. Een halve
+* zin van de vorige bron wordt weggegooid.
+* @param usb TRUE zodra een USB-ontvanger actief is, FALSE na het loskoppelen
+* @return void
+*/
+void GPS_rx_select(int usb)
+{
+	usb_framer.in_msg  = FALSE;
+	uart_framer.in_msg = FALSE;
+	rx_usb = usb;
+}
+
+
+/**
+* @brief Leest de hele GPS-NMEA-zinnen die GPS_rx_byte_ISR() via de messagebuffer aanlevert,
+* controleert de checksum en verwerkt ze.
 * @return void
 */
 void GPS_getNMEA (void *argument)
 {
-    char  Q_char;   			// char to receive from queue
-	char  MSG_buff[GPS_MAXLEN]; // buffer for GPS-string
-	int   pos = 0;
-	int   cs;                   // checksum-flag
-	int   new_msg = FALSE;      // do we encounter a '$'-char?
-	int   msg_type = 0;         // do we want this message to be interpreted?
+	char     MSG_buff[GPS_MAXLEN]; // buffer for GPS-string
+	NMEA_MSG msg;                  // decoded sentence
+	size_t   len;
+	int      cs;                   // checksum-flag
 
 	UART_puts((char *)__func__); UART_puts("started\n\r");
 
 	while (TRUE)
 	{
-		xQueueReceive(hGPS_Queue, &Q_char, portMAX_DELAY); // get one char from the q
-
-		//UART_putchar(Q_buff);  // echo, for testing
+		SUP_alive(SUP_GPS_NMEA);
 
-		if (Q_char == '$') // gotcha, new datastring started
-		{
-			memset(MSG_buff, 0, sizeof(MSG_buff)); // clear buff
-			pos = 0;
-			new_msg = TRUE; // from now on, chars are valid to receive
-		}
-
-		if (new_msg == FALSE) // char only valid if started by $
+		// one wake-up per sentence; the CR is not included. Without GPS the timeout keeps the heartbeat going
+		len = xMessageBufferReceive(hGPS_MsgBuf, MSG_buff, sizeof(MSG_buff) - 1, pdMS_TO_TICKS(SUP_BEAT_MS));
+		if (!len)
 			continue;
+		MSG_buff[len] = '\0';         // close string
 
-		MSG_buff[pos] = Q_char; // copy char read from Q into the msg-buf
+		cs = checksum_valid(MSG_buff); // note, checksumchars (eg "*43") are removed from string
 
-		// if pos==5, the message type (f.i. "$GPGSA) is complete, so we now we can determine
-		// if we want the rest of the message... else we skip the rest characters
-		if (pos == 5)
+		if (Uart_debug_out & GPS_DEBUG_OUT) // output to uart if wanted
 		{
-			msg_type = 0; // reset
-
-			// next, we decide which message types we want to interpret
-			// and we set the message-type for later use...
-			if      (!strncmp(&MSG_buff[1], "GNRMC", 5)) msg_type = eGNRMC;
-			else if (!strncmp(&MSG_buff[1], "GPGSA", 5)) msg_type = eGPGSA;
-			else if (!strncmp(&MSG_buff[1], "GNGGA", 5)) msg_type = eGNGGA;
-
-			if (!msg_type) // not an interesting message type
-			{
-				new_msg = FALSE;
-				continue;
-			}
+			UART_puts(rx_usb ? "\r\nGPS (USB): " : "\r\nGPS (UART4): "); UART_puts(MSG_buff);
+			UART_puts( cs ? " [cs:OK]\r\n" : " [cs:ERR]\r\n");
 		}
 
-		// if we are here, we are reading the rest of the message into the msg_buff
-		////////////////////////////////////////////////////////////////////////////
-		if (pos >= GPS_MAXLEN - 1) // avoid overflow (should not happen, but still...)
+		if (!cs)
 		{
-			new_msg = FALSE; // ignore it
+			rx_cs_errors++;
 			continue;
 		}
 
-		if (MSG_buff[pos] == '\r') // end of message encountered - all messages end with <CR-13><LF-10>
+		switch(NMEA_decode(MSG_buff, &msg)) // extract data from msg into the struct of its schema
 		{
-			MSG_buff[pos] = '\0';          // close string
-			cs = checksum_valid(MSG_buff); // note, checksumchars (eg "*43") are removed from string
-
-			if (Uart_debug_out & GPS_DEBUG_OUT) // output to uart if wanted
-			{
-				UART_puts("\r\nGPS (UART4): "); UART_puts(MSG_buff);
-				UART_puts( cs ? " [cs:OK]\r\n" : " [cs:ERR]\r\n");
-			}
-
-			if (cs) // checksum okay, so interpret the message
-			{
-				switch(msg_type) // extract data from msg into right struct
-				{
-				case eGNRMC: fill_GNRMC(MSG_buff);
-						     // use the data...
-						     break;
-				case eGPGSA:
-				case eGNGGA: break;
-				default:     break;
-				}
-			}
-
-			new_msg = FALSE; // new message possible
-			continue;
+		case eNMEA_RMC: fill_GNRMC(&msg.u.RMC); // new epoch: publish
+						break;
+		case eNMEA_GGA: last_gga = msg.u.GGA;
+						break;
+		case eNMEA_GSA: last_gsa = msg.u.GSA;
+						break;
+		case eNMEA_GST: last_gst = msg.u.GST;
+						break;
+		case eNMEA_GSV:
+		case eNMEA_VTG: break; // decoded, not used yet
+		default:        break;
 		}
-		pos++; // proceed reading next char from the queue
 	}
 }
 
 
+/**
+* @brief Toont de ontvangst-tellers van de NMEA-framer op de UART.
+* @return void
+*/
+void GPS_rx_report(void)
+{
+	UART_puts(rx_usb ? "\r\nGPS receive (USB)" : "\r\nGPS receive (UART4)");
+	UART_puts("\r\n\t sentences: ");      UART_putint(rx_sentences);
+	UART_puts("\t filtered: ");             UART_putint(rx_filtered);
+	UART_puts("\t checksum errors: ");      UART_putint(rx_cs_errors);
+	UART_puts("\r\n\t dropped, buffer full: "); UART_putint(rx_dropped);
+	UART_puts("\t dropped, too long: ");    UART_putint(rx_too_long);
+	UART_puts("\r\n\t UART4 chars ignored while USB active: "); UART_putint(rx_muted);
+	UART_puts("\r\n");
+	GPS_usb_report();
+}
+
+
 // source: file:///C:/craigpeacock/NMEA-GPS
 int hex2int(char *c)
 {
@@ -0,0 +1,111 @@
+/*
+ * keyscan.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Keypad scanner, see keyscan.h. The scan runs in the timer service task (low
+ * priority); the interrupt handler does no GPIO work besides masking its own line.
+ * With all rows high any key raises Key_int (PB0, EXTI0); during the scan the rows
+ * are driven one by one (KEYS_read), afterwards all high again.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "ARM_keys.h"
+#include "keyscan.h"
+
+static uint32_t raw_last;     // last scan
+static uint32_t raw_ms;       // how long raw_last is unchanged
+static uint32_t key_down;     // debounced key, 0 = none
+static uint32_t held_ms;      // how long key_down is held
+static int      long_sent;
+
+
+/**
+ * @brief Called from EXTI0_IRQHandler: masks the keypad interrupt and starts the
+ * scanner. Bounces after this point do not interrupt again.
+ */
+void KEYSCAN_irq(void)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if (!hKeyScan) // before CreateHandles()
+		return;
+
+	EXTI->IMR &= ~Key_int_Pin;
+	xTimerStartFromISR(hKeyScan, &xHigherPriorityTaskWoken);
+	portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+
+/**
+ * @brief Hands an event to the mode manager; in the demo profile a press also goes to
+ * ARM_keys_IRQ (event group) for the LED and buzzer demonstration.
+ */
+static void keyscan_event(uint32_t key, KEY_EVENT ev)
+{
+	if (Uart_debug_out & ARMKEYS_DEBUG_OUT)
+	{
+		UART_puts("\r\n\tkey "); UART_putint(key);
+		UART_puts(ev == eKEY_PRESS ? " press" : ev == eKEY_REPEAT ? " repeat" : " long");
+	}
+
+#if APP_PROFILE == APP_PROFILE_DEMO
+	if (ev == eKEY_PRESS)
+		xEventGroupSetBits(hKEY_Event, key);
+#endif
+	arm_keysshortcuts(key, ev);
+}
+
+
+/**
+ * @brief Callback of hKeyScan, every KEYSCAN_MS while a key is down or bouncing.
+ */
+void KEYSCAN_tick(void)
+{
+	uint32_t raw = KEYS_read();
+
+	if (raw != raw_last)
+	{
+		raw_last = raw;
+		raw_ms   = 0;
+	}
+	else if (raw_ms < KEYSCAN_DEBOUNCE_MS)
+		raw_ms += KEYSCAN_MS;
+
+	if (raw_ms >= KEYSCAN_DEBOUNCE_MS && raw != key_down) // stable and changed
+	{
+		key_down  = raw;
+		held_ms   = 0;
+		long_sent = FALSE;
+		if (key_down)
+			keyscan_event(key_down, eKEY_PRESS);
+	}
+	else if (key_down)
+	{
+		held_ms += KEYSCAN_MS;
+		if (!long_sent && held_ms >= KEYSCAN_LONG_MS)
+		{
+			long_sent = TRUE;
+			keyscan_event(key_down, eKEY_LONG);
+		}
+		if (held_ms >= KEYSCAN_REPEAT_DELAY_MS && (held_ms - KEYSCAN_REPEAT_DELAY_MS) % KEYSCAN_REPEAT_MS == 0)
+			keyscan_event(key_down, eKEY_REPEAT);
+	}
+
+	KEYS_initISR(1); // all rows high: a key pulls Key_int up again
+
+	if (!key_down && !raw && raw_ms >= KEYSCAN_DEBOUNCE_MS) // released and settled: back to the interrupt
+	{
+		xTimerStop(hKeyScan, 0); // queued before any start from the interrupt below
+		EXTI->PR   = Key_int_Pin; // edges seen during the scan
+		EXTI->IMR |= Key_int_Pin;
+		if (HAL_GPIO_ReadPin(Key_int_GPIO_Port, Key_int_Pin) == GPIO_PIN_SET) // pressed before the unmask
+		{
+			EXTI->IMR &= ~Key_int_Pin;
+			xTimerStart(hKeyScan, 0);
+		}
+	}
+}
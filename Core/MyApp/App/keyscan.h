@@ -0,0 +1,40 @@
+/*
+ * keyscan.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * ARM keypad scanner. The EXTI interrupt of the keypad only starts software timer
+ * hKeyScan; its callback scans the matrix every KEYSCAN_MS while a key is down, with
+ * debounce, auto-repeat and long-press detection, and hands the events straight to
+ * arm_keysshortcuts() (GPS mode manager). When all keys are released the timer stops
+ * and the interrupt is armed again, so an idle keypad costs nothing.
+ */
+
+#ifndef MYAPP_APP_KEYSCAN_H_
+#define MYAPP_APP_KEYSCAN_H_
+
+#include <stdint.h>
+
+/// scan period while a key is down
+#define KEYSCAN_MS           10
+/// a key state must be stable this long to count
+#define KEYSCAN_DEBOUNCE_MS  30
+/// held this long: one KEY_LONG event
+#define KEYSCAN_LONG_MS      1000
+/// auto-repeat: first KEY_REPEAT after this long, then every KEYSCAN_REPEAT_MS
+#define KEYSCAN_REPEAT_DELAY_MS 500
+#define KEYSCAN_REPEAT_MS    150
+
+/// key events, passed with the key number (1-16) to arm_keysshortcuts()
+typedef enum
+{
+	eKEY_PRESS = 0,  // debounced press
+	eKEY_REPEAT,     // still held, auto-repeat
+	eKEY_LONG        // held KEYSCAN_LONG_MS, once per press
+} KEY_EVENT;
+
+extern void KEYSCAN_irq (void);
+extern void KEYSCAN_tick(void);
+
+#endif /* MYAPP_APP_KEYSCAN_H_ */
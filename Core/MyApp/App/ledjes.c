@@ -31,6 +31,9 @@
 #include <admin.h>
 #include "main.h"
 #include "cmsis_os.h"
+#include "ledstatus.h"
+
+#if APP_PROFILE == APP_PROFILE_DEMO // lesvoorbeeld, niet in de production build
 
 /// default value 100MSEC, kan veranderd worden via Terminal (user interface)
 unsigned int os_delay = 100;
@@ -56,7 +59,7 @@ void LED_Task1 (void *argument)
 		leds = 128; // start at led nr. 8
 		for (i=0; i<8; i++, leds>>=1)
 		{
-        	LED_put(leds); // set leds
+        	LEDSTAT_show(leds); // set leds
            	osDelay(os_delay);
 
 	    	if (Uart_debug_out & LEDS_DEBUG_OUT)
@@ -85,7 +88,7 @@ void LED_Task2 (void *argument)
 		leds = 1;
 		for (i=0; i<8; i++, leds<<=1)
 		{
-        	LED_put(leds); // set leds
+        	LEDSTAT_show(leds); // set leds
           	osDelay(os_delay);
 
 	    	if (Uart_debug_out & LEDS_DEBUG_OUT)
@@ -125,7 +128,7 @@ void LED_Task3 (void *argument)
 	    	else if (i==2)  leds = 2+64;
 	    	else 			leds = 1+128;
 
-	    	LED_put(leds);     // set leds
+	    	LEDSTAT_show(leds);     // set leds
 	    	osDelay(os_delay); // snelheid bepalen, kan veranderd worden via user interface
 
 	    	if (Uart_debug_out & LEDS_DEBUG_OUT)
@@ -172,7 +175,7 @@ void LED_Task4 (void *argument)
 	    	else if (i==2)  leds = 4+32;
 	    	else 			leds = 8+16;
 
-	    	LED_put(leds);     // set leds
+	    	LEDSTAT_show(leds);     // set leds
 	    	osDelay(os_delay); // snelheid bepalen, waarde os_delay kan veranderd worden via user interface
 
 	    	if (Uart_debug_out & LEDS_DEBUG_OUT)
@@ -188,3 +191,4 @@ void LED_Task4 (void *argument)
 	}
 }
 
+#endif
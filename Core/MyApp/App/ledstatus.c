@@ -0,0 +1,128 @@
+/*
+ * ledstatus.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Status LEDs, see ledstatus.h. A pattern is a byte: bit n is the LED state in tick n
+ * of the 1 s cycle. The inputs are read without locks: each is a single word written
+ * by one task, and a stale value only shows for one tick.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "GPS_mode.h"
+#include "GPS_parser.h"
+#include "NRF_power.h"
+#include "ledstatus.h"
+
+#define PAT_OFF   0x00
+#define PAT_ON    0xff
+#define PAT_SLOW  0x0f  // 0.5 s on, 0.5 s off
+#define PAT_FAST  0x55  // 4 Hz
+
+static volatile TickType_t fix_tick;       // last LEDSTAT_fix()
+static volatile int        fix_valid;
+static volatile TickType_t show_tick;      // last LEDSTAT_show()
+static volatile uint8_t    show_leds;
+static volatile int        show_set = FALSE;
+static uint8_t             leds_last;        // what the shift register holds, LED_init() cleared it
+static uint8_t             phase;            // tick in the cycle, 0-7
+
+
+/**
+ * @brief The fix of the latest epoch, called by the GPS task for every RMC.
+ */
+void LEDSTAT_fix(int valid)
+{
+	fix_valid = valid;
+	fix_tick  = xTaskGetTickCount();
+}
+
+
+/**
+ * @brief Shows a byte on the LEDs instead of the status for LEDSTAT_HOLD_MS (demo
+ * tasks, ARM keys). Only stores it; the timer callback writes the shift register.
+ */
+void LEDSTAT_show(uint8_t leds)
+{
+	show_leds = leds;
+	show_tick = xTaskGetTickCount();
+	show_set  = TRUE;
+}
+
+
+/**
+ * @brief The LEDs of the 4-LED survey bar: one per 25 %, the next one blinks.
+ */
+static uint8_t survey_bar(uint8_t on)
+{
+	uint32_t pct = GPS_survey_progress();
+	uint8_t  bar = 0, bit = 0x04;
+
+	for (; pct >= 25 && bit & LEDSTAT_SURVEY; pct -= 25, bit <<= 1)
+		bar |= bit;
+	if (on && bit & LEDSTAT_SURVEY)
+		bar |= bit;
+	return bar;
+}
+
+
+/**
+ * @brief Status byte for the current tick.
+ */
+static uint8_t leds_status(void)
+{
+	uint8_t    leds = 0, pat;
+	TickType_t now = xTaskGetTickCount();
+
+	#define LIT(p) (((p) >> phase) & 1)
+
+	switch (GPS_mode_get())
+	{
+	case eMODE_SURVEY_IN:         pat = PAT_SLOW; leds |= survey_bar(LIT(PAT_SLOW)); break;
+	case eMODE_REFERENCE_LOCKED:
+	case eMODE_BROADCASTING:      pat = PAT_ON;   leds |= LEDSTAT_SURVEY; break;
+	case eMODE_DEGRADED:          pat = PAT_FAST; leds |= LEDSTAT_SURVEY; break;
+	default:                      pat = PAT_OFF;  break;
+	}
+	if (LIT(pat))
+		leds |= LEDSTAT_MODE;
+
+	if ((now - fix_tick) * portTICK_PERIOD_MS < LEDSTAT_FIX_MS && (fix_valid || LIT(PAT_FAST)))
+		leds |= LEDSTAT_FIX;
+
+	switch (NRF_power_link())
+	{
+	case eNRF_LINK_OK:   leds |= LEDSTAT_RADIO; break;
+	case eNRF_LINK_FAIL: leds |= (LIT(PAT_FAST) ? LEDSTAT_RADIO : 0); break;
+	default:             break;
+	}
+
+	#undef LIT
+	return leds;
+}
+
+
+/**
+ * @brief Callback of software timer 1, every LEDSTAT_TICK_MS: the shown byte while it
+ * is recent, else the status; the shift register is written only on a change.
+ */
+void LEDSTAT_tick(void)
+{
+	uint8_t leds;
+
+	phase = (phase + 1) & 7;
+
+	if (show_set && (xTaskGetTickCount() - show_tick) * portTICK_PERIOD_MS < LEDSTAT_HOLD_MS)
+		leds = show_leds;
+	else
+		leds = leds_status();
+
+	if (leds != leds_last)
+	{
+		LED_put(leds);
+		leds_last = leds;
+	}
+}
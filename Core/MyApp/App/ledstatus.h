@@ -0,0 +1,35 @@
+/*
+ * ledstatus.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Status LEDs: the 8 LEDs of the shift register show the GPS mode, the fix, the
+ * survey-in progress and the radio link as blink patterns. Everything runs in the
+ * callback of software timer 1 (admin.c), so no task writes to the LEDs and no mutex
+ * is needed; the shift register is only written when the pattern changes.
+ */
+
+#ifndef MYAPP_APP_LEDSTATUS_H_
+#define MYAPP_APP_LEDSTATUS_H_
+
+#include <stdint.h>
+
+/// timer 1 period (admin.h); a pattern is 8 ticks, 1 s
+#define LEDSTAT_TICK_MS   TIMER1_DELAY
+/// a byte from LEDSTAT_show() stays on the LEDs this long
+#define LEDSTAT_HOLD_MS   1000
+/// no fix report for this long: the fix LED goes off
+#define LEDSTAT_FIX_MS    3000
+
+/// LED bits, left is bit 0
+#define LEDSTAT_MODE      0x01  // off: idle, slow: survey-in, on: reference/broadcasting, fast: degraded
+#define LEDSTAT_FIX       0x02  // on: valid fix, fast: no fix, off: no receiver data
+#define LEDSTAT_SURVEY    0x3c  // 4-LED progress bar of the survey-in, all on once a reference is known
+#define LEDSTAT_RADIO     0xc0  // on: corrections acknowledged, fast: no ACK, off: not transmitting
+
+extern void LEDSTAT_tick(void);
+extern void LEDSTAT_fix (int valid);
+extern void LEDSTAT_show(uint8_t leds);
+
+#endif /* MYAPP_APP_LEDSTATUS_H_ */
@@ -0,0 +1,50 @@
+/*
+ * logdisk.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Storage backends of the logger (logger.c). A backend only sees whole blocks of
+ * LOG_BLOCK bytes and is called from Logger_task alone, so it may block. The RAM disk
+ * has no RTOS or HAL dependency and also builds on a Linux host.
+ */
+
+#ifndef MYAPP_APP_LOGDISK_H_
+#define MYAPP_APP_LOGDISK_H_
+
+#include <stdint.h>
+
+/// one write: 8 sectors of 512 bytes
+#define LOG_SECTOR     512
+#define LOG_BLOCK      (8 * LOG_SECTOR)
+
+typedef struct
+{
+	const char *name;
+	uint32_t    flush_ms;                 // a partly filled block is written after this long
+	int  (*open) (void);                  // new recording; FALSE if there is no medium
+	int  (*write)(const uint8_t *block);  // one LOG_BLOCK; FALSE on an error
+	void (*close)(void);
+} LOG_DISK;
+
+/// RAM disk: a ring of the last LOGDISK_RAM_BLOCKS blocks; nothing to lose on a power
+/// cut, so a block is only written early when LOG_REC_HDR.dt would overflow
+#define LOGDISK_RAM_BLOCKS   8
+#define LOGDISK_RAM_FLUSH_MS 60000
+
+extern const LOG_DISK logdisk_ram;
+extern const uint8_t *logdisk_ram_block(uint32_t i); // i-th oldest block, NULL if none
+
+/// USB stick (logdisk_fatfs.c): a file per recording
+#include "usbh_core.h"
+
+/// f_sync after this many blocks; a stick pulled out loses at most these
+#define LOGDISK_SYNC_BLOCKS   8
+/// a partly filled block goes to the stick after this long
+#define LOGDISK_FATFS_FLUSH_MS 2000
+
+extern const LOG_DISK logdisk_fatfs;
+extern void logdisk_fatfs_event(USBH_HandleTypeDef *phost, uint8_t id); // from USBH_UserProcess
+extern int  logdisk_fatfs_mounted(void);                                // Logger_task only
+
+#endif /* MYAPP_APP_LOGDISK_H_ */
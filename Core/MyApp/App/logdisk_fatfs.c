@@ -0,0 +1,138 @@
+/*
+ * logdisk_fatfs.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * USB stick backend of the logger, see logdisk.h, on FatFs (FATFS/App, USB Disk: drive
+ * USBHPath) and the USB host MSC class. Every recording is a new file LOGnnnn.GLG in the
+ * root; writes are whole LOG_BLOCK blocks at multiples of LOG_BLOCK, so FatFs passes
+ * them to the stick as multi-sector writes without its own sector buffer.
+ *
+ * The board has one USB host port: with a GNSS receiver on it (GPS_usb.c) the logger
+ * uses the RAM disk.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "fatfs.h"
+#include "usbh_msc.h"
+#include "logger.h"
+#include "logdisk.h"
+
+static volatile int      attached = FALSE; // an MSC unit is active, USB host thread
+static volatile uint32_t attaches;         // MSC units that became active
+static uint32_t          tried;            // attaches at the last f_mount, Logger_task only
+static int               mounted = FALSE;  // Logger_task only
+static uint32_t          written;          // blocks in the open file
+
+
+/**
+ * @brief Called from USBH_UserProcess(): notes a stick that came or went and wakes
+ * Logger_task, which does the mount. FatFs is not reentrant, so only Logger_task calls it.
+ * @param phost The host handle
+ * @param id HOST_USER_* event
+ */
+void logdisk_fatfs_event(USBH_HandleTypeDef *phost, uint8_t id)
+{
+	switch (id)
+	{
+	case HOST_USER_CLASS_ACTIVE:
+		if (phost->pActiveClass != USBH_MSC_CLASS) // a GNSS receiver (GPS_usb.c)
+			break;
+		attaches++;
+		attached = TRUE;
+		LOG_medium();
+		break;
+
+	case HOST_USER_DISCONNECTION:
+		if (!attached)
+			break;
+		attached = FALSE; // a write in progress fails and Logger_task ends the recording
+		LOG_medium();
+		break;
+
+	default:
+		break;
+	}
+}
+
+
+/**
+ * @brief Called by Logger_task every pass: mounts a stick that came (once, a stick
+ * without FAT16/FAT32 is reported and left alone) and unmounts one that went.
+ * @return TRUE if a stick is mounted
+ */
+int logdisk_fatfs_mounted(void)
+{
+	uint32_t n = attaches;
+
+	if (mounted && (!attached || n != tried))
+	{
+		f_mount(NULL, USBHPath, 0); // an open file is invalid from here on
+		mounted = FALSE;
+	}
+	if (attached && n != tried)
+	{
+		tried   = n;
+		mounted = (f_mount(&USBHFatFS, USBHPath, 1) == FR_OK);
+		if (!mounted)
+			UART_puts("\r\nLogger: USB stick has no FAT16/FAT32 file system\r\n");
+	}
+	return mounted;
+}
+
+
+/**
+ * @brief Creates the first free LOGnnnn.GLG.
+ */
+static int fatfs_open(void)
+{
+	char    name[16];
+	int     i;
+	FRESULT res;
+
+	if (!mounted)
+		return FALSE;
+
+	for (i = 0; i < 10000; i++)
+	{
+		snprintf(name, sizeof(name), "%sLOG%04d.GLG", USBHPath, i);
+		res = f_open(&USBHFile, name, FA_WRITE | FA_CREATE_NEW);
+		if (res == FR_OK)
+		{
+			written = 0;
+			return TRUE;
+		}
+		if (res != FR_EXIST)
+			break;
+	}
+	return FALSE;
+}
+
+
+/**
+ * @brief Appends a block; f_sync every LOGDISK_SYNC_BLOCKS, so the directory entry
+ * stays close to the data.
+ */
+static int fatfs_write(const uint8_t *block)
+{
+	UINT bw;
+
+	if (!mounted || f_write(&USBHFile, block, LOG_BLOCK, &bw) != FR_OK || bw != LOG_BLOCK)
+		return FALSE;
+	if (++written % LOGDISK_SYNC_BLOCKS == 0 && f_sync(&USBHFile) != FR_OK)
+		return FALSE;
+	return TRUE;
+}
+
+
+static void fatfs_close(void)
+{
+	if (mounted)
+		f_close(&USBHFile);
+}
+
+
+const LOG_DISK logdisk_fatfs = { "USB stick", LOGDISK_FATFS_FLUSH_MS, fatfs_open, fatfs_write, fatfs_close };
@@ -0,0 +1,63 @@
+/*
+ * logdisk_ram.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * RAM disk backend of the logger, see logdisk.h: a ring of the last LOGDISK_RAM_BLOCKS
+ * blocks in CCM RAM (32 KB, otherwise unused). It needs no medium, so the logger always
+ * has somewhere to write; on a Linux host it stands in for the stick when testing
+ * logger.c and Tools/log_replay.py. Plain C on purpose: no RTOS or HAL headers.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "logdisk.h"
+
+static uint8_t  ram_disk[LOGDISK_RAM_BLOCKS][LOG_BLOCK] __attribute__((section(".ccmram"), aligned(4)));
+static uint32_t ram_next;   // slot of the next write
+static uint32_t ram_count;  // blocks held, at most LOGDISK_RAM_BLOCKS
+
+
+/**
+ * @brief New recording: forgets the blocks of the previous one.
+ */
+static int ram_open(void)
+{
+	ram_next  = 0;
+	ram_count = 0;
+	return 1;
+}
+
+
+/**
+ * @brief Stores a block, overwriting the oldest when the ring is full.
+ */
+static int ram_write(const uint8_t *block)
+{
+	memcpy(ram_disk[ram_next], block, LOG_BLOCK);
+	ram_next = (ram_next + 1) % LOGDISK_RAM_BLOCKS;
+	if (ram_count < LOGDISK_RAM_BLOCKS)
+		ram_count++;
+	return 1;
+}
+
+
+static void ram_close(void)
+{
+}
+
+
+/**
+ * @brief The i-th oldest block of the recording, for 'log dump' and host tests.
+ * @return The block, NULL if i is past the last one
+ */
+const uint8_t *logdisk_ram_block(uint32_t i)
+{
+	if (i >= ram_count)
+		return NULL;
+	return ram_disk[(ram_next + LOGDISK_RAM_BLOCKS - ram_count + i) % LOGDISK_RAM_BLOCKS];
+}
+
+
+const LOG_DISK logdisk_ram = { "RAM disk", LOGDISK_RAM_FLUSH_MS, ram_open, ram_write, ram_close };
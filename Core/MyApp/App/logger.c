@@ -0,0 +1,383 @@
+/*
+ * logger.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Logger, see logger.h. A block is FREE, FILLING (producers append to it) or FULL
+ * (waiting for Logger_task). The blocks are filled in turn, block seq in blocks[seq & 1],
+ * so the task writes them in order. Producers mask interrupts only for the copy of one
+ * record, never wait for the disk, and drop the record (counted) when both blocks are
+ * still full; the correction path therefore never waits for a slow stick.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "logger.h"
+#include "logdisk.h"
+
+#define LOG_FREE     0
+#define LOG_FILLING  1
+#define LOG_FULL     2
+
+static uint8_t           blocks[2][LOG_BLOCK] __attribute__((aligned(4)));
+static volatile uint8_t  state[2];           // LOG_FREE/FILLING/FULL
+static int               cur = -1;           // block being filled, -1 if none
+static LOG_REC_HDR      *last_raw;           // last record of cur if it holds raw bytes
+static uint32_t          next_seq;
+static volatile int      log_on   = FALSE;   // records are accepted
+static volatile int      log_want = TRUE;    // LOG_run()
+static TaskHandle_t      hLogger;
+static const LOG_DISK   *disk;               // backend of the recording, set by Logger_task only
+static uint32_t          wr;                 // next block to write, Logger_task only
+
+static volatile uint32_t log_records, log_dropped, log_blocks, log_errors, log_write_max;
+
+
+/**
+ * @brief Closes the block being filled, Logger_task writes it. Interrupts masked.
+ * @return TRUE if there was a block
+ */
+static int log_close(void)
+{
+	if (cur < 0)
+		return FALSE;
+	state[cur] = LOG_FULL;
+	cur        = -1;
+	last_raw   = NULL;
+	return TRUE;
+}
+
+
+/**
+ * @brief Starts the next block if it is free. Interrupts masked.
+ */
+static int log_open(uint32_t now)
+{
+	int            i   = next_seq & 1;
+	LOG_BLOCK_HDR *hdr = (LOG_BLOCK_HDR *)blocks[i];
+
+	if (state[i] != LOG_FREE)
+		return FALSE;
+
+	hdr->magic   = LOG_MAGIC;
+	hdr->version = LOG_VERSION;
+	hdr->sectors = LOG_BLOCK / LOG_SECTOR;
+	hdr->used    = sizeof(LOG_BLOCK_HDR);
+	hdr->seq     = next_seq++;
+	hdr->tick    = now;
+	state[i] = LOG_FILLING;
+	cur      = i;
+	return TRUE;
+}
+
+
+/**
+ * @brief Appends one record (len <= 255). Raw bytes of the same source extend the last
+ * record while it is the last one in the block. Interrupts masked.
+ * @param kick Set to TRUE when a block was closed, the caller wakes Logger_task
+ */
+static void log_put(uint8_t type, const void *data, uint32_t len, int *kick)
+{
+	uint32_t       now = xTaskGetTickCountFromISR() * portTICK_PERIOD_MS;
+	LOG_BLOCK_HDR *hdr;
+	LOG_REC_HDR   *rec;
+
+	if (!log_on)
+		return;
+
+	hdr = (cur >= 0 ? (LOG_BLOCK_HDR *)blocks[cur] : NULL);
+	if (hdr && last_raw && last_raw->type == type && last_raw->len + len <= 255 && hdr->used + len <= LOG_BLOCK)
+	{
+		memcpy(blocks[cur] + hdr->used, data, len);
+		last_raw->len += len;
+		hdr->used     += len;
+		return;
+	}
+
+	if (hdr && (hdr->used + sizeof(LOG_REC_HDR) + len > LOG_BLOCK || now - hdr->tick > 0xffff)) // full, or dt would overflow
+	{
+		*kick |= log_close();
+		hdr = NULL;
+	}
+	if (!hdr)
+	{
+		if (!log_open(now))
+		{
+			log_dropped++; // both blocks wait for the disk
+			return;
+		}
+		hdr = (LOG_BLOCK_HDR *)blocks[cur];
+	}
+
+	rec = (LOG_REC_HDR *)(blocks[cur] + hdr->used);
+	rec->type = type;
+	rec->len  = len;
+	rec->dt   = now - hdr->tick;
+	memcpy(rec + 1, data, len);
+	hdr->used += sizeof(LOG_REC_HDR) + len;
+	last_raw   = (type == LOG_CORRECTION ? NULL : rec);
+	log_records++;
+}
+
+
+/**
+ * @brief Wakes Logger_task to write a full block, from a task or an ISR.
+ */
+static void log_kick(void)
+{
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+	if (xPortIsInsideInterrupt())
+	{
+		vTaskNotifyGiveFromISR(hLogger, &xHigherPriorityTaskWoken);
+		portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+	}
+	else
+		xTaskNotifyGive(hLogger);
+}
+
+
+/**
+ * @brief Records raw GNSS bytes, from the UART4 ISR (1 char) or the USB host task
+ * (a transfer). Never blocks.
+ */
+void LOG_raw(LOG_TYPE type, const uint8_t *data, uint32_t n)
+{
+	UBaseType_t mask;
+	uint32_t    len;
+	int         kick = FALSE;
+
+	if (!log_on)
+		return;
+
+	while (n)
+	{
+		len = (n > 255 ? 255 : n); // LOG_REC_HDR.len
+		mask = taskENTER_CRITICAL_FROM_ISR();
+		log_put(type, data, len, &kick);
+		taskEXIT_CRITICAL_FROM_ISR(mask);
+		data += len;
+		n    -= len;
+	}
+	if (kick)
+		log_kick();
+}
+
+
+/**
+ * @brief Records a correction as it was broadcast, with the transmit result.
+ */
+void LOG_correction(const NRF_CORRECTION *corr, uint8_t status)
+{
+	LOG_CORR_REC rec;
+	UBaseType_t  mask;
+	int          kick = FALSE;
+
+	if (!log_on)
+		return;
+
+	rec.corr   = *corr;
+	rec.status = status;
+	mask = taskENTER_CRITICAL_FROM_ISR();
+	log_put(LOG_CORRECTION, &rec, sizeof(rec), &kick);
+	taskEXIT_CRITICAL_FROM_ISR(mask);
+	if (kick)
+		log_kick();
+}
+
+
+/**
+ * @brief Starts (on TRUE) or stops the recording; Logger_task carries it out, a stop
+ * writes the last block first.
+ */
+void LOG_run(int on)
+{
+	log_want = on;
+	if (hLogger)
+		xTaskNotifyGive(hLogger);
+}
+
+
+/**
+ * @brief A backend medium came or went (USB host thread): Logger_task looks at once.
+ */
+void LOG_medium(void)
+{
+	if (hLogger)
+		xTaskNotifyGive(hLogger);
+}
+
+
+/**
+ * @brief TRUE while a recording is open (also while the last blocks of a stop are written).
+ */
+int LOG_running(void)
+{
+	return (disk != NULL);
+}
+
+
+/**
+ * @brief Opens a new recording: the stick if there is one, else the RAM disk.
+ */
+static void log_start(void)
+{
+	disk = &logdisk_fatfs;
+	if (!disk->open())
+	{
+		disk = &logdisk_ram;
+		if (!disk->open())
+		{
+			disk = NULL;
+			return;
+		}
+	}
+
+	taskENTER_CRITICAL();
+	next_seq = 0;
+	wr       = 0;
+	log_on   = TRUE;
+	taskEXIT_CRITICAL();
+
+	UART_puts("\r\nLogger: recording to "); UART_puts((char *)disk->name); UART_puts("\r\n");
+}
+
+
+/**
+ * @brief Writes the full blocks in order; after a failed write the rest is discarded.
+ * @return FALSE if a write failed
+ */
+static int log_drain(void)
+{
+	TickType_t t0;
+	uint32_t   ms;
+	int        ok = TRUE;
+
+	while (state[wr] == LOG_FULL)
+	{
+		t0 = xTaskGetTickCount();
+		if (ok && disk->write(blocks[wr]))
+			log_blocks++;
+		else
+		{
+			log_errors++;
+			ok = FALSE;
+		}
+		ms = (xTaskGetTickCount() - t0) * portTICK_PERIOD_MS;
+		if (ms > log_write_max)
+			log_write_max = ms;
+
+		memset(blocks[wr], 0, LOG_BLOCK); // the tail of the next use must be zero
+		state[wr] = LOG_FREE;
+		wr ^= 1;
+	}
+	return ok;
+}
+
+
+/**
+ * @brief Writes full blocks to the backend, closes a block after LOG_DISK.flush_ms and
+ * handles LOG_run(). A failed write ends the recording, so does a stick that came
+ * during a RAM recording or went during its own; a new one starts right away on
+ * whatever backend is there.
+ * @param *argument Not used
+ */
+void Logger_task(void *argument)
+{
+	uint32_t now;
+	int      stop, stick, moved;
+	int      had_stick = FALSE;
+
+	hLogger = xTaskGetCurrentTaskHandle();
+	UART_puts((char *)__func__); UART_puts(" started\r\n");
+
+	while (TRUE)
+	{
+		ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_POLL_MS));
+
+		stick     = logdisk_fatfs_mounted();
+		moved     = (stick && !had_stick && disk == &logdisk_ram) || (!stick && disk == &logdisk_fatfs);
+		had_stick = stick;
+
+		if (log_want && !disk)
+			log_start();
+		if (!disk)
+			continue;
+
+		now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+		taskENTER_CRITICAL();
+		if (!log_want)
+			log_on = FALSE;
+		if (cur >= 0 && (!log_want || now - ((LOG_BLOCK_HDR *)blocks[cur])->tick >= disk->flush_ms))
+			log_close();
+		taskEXIT_CRITICAL();
+
+		stop = !log_drain() || !log_want || moved;
+		if (!stop)
+			continue;
+
+		taskENTER_CRITICAL();
+		log_on = FALSE;
+		log_close();
+		taskEXIT_CRITICAL();
+		log_drain();
+
+		disk->close();
+		UART_puts("\r\nLogger: recording on "); UART_puts((char *)disk->name); UART_puts(" closed\r\n");
+		disk = NULL;
+		if (log_want)
+			log_start(); // no gap in the recording
+	}
+}
+
+
+/**
+ * @brief Prints the RAM disk as hex: per block a line '=', then lines ':' of 32 bytes,
+ * up to LOG_BLOCK_HDR.used. Tools/log_replay.py reads a capture of it. Call only
+ * while no recording runs (LOG_running() FALSE).
+ */
+void LOG_dump(void)
+{
+	static const char hex[] = "0123456789abcdef";
+	const uint8_t    *block;
+	char              line[2 + 64 + 3];
+	uint32_t          i, pos, n, k;
+
+	for (i = 0; (block = logdisk_ram_block(i)); i++)
+	{
+		UART_puts("\r\n=\r\n");
+		for (pos = 0; pos < ((LOG_BLOCK_HDR *)block)->used; pos += 32)
+		{
+			n = ((LOG_BLOCK_HDR *)block)->used - pos;
+			if (n > 32)
+				n = 32;
+			line[0] = ':';
+			for (k = 0; k < n; k++)
+			{
+				line[1 + 2 * k] = hex[block[pos + k] >> 4];
+				line[2 + 2 * k] = hex[block[pos + k] & 0x0f];
+			}
+			strcpy(&line[1 + 2 * n], "\r\n");
+			UART_puts(line);
+		}
+	}
+	UART_puts("\r\n");
+}
+
+
+/**
+ * @brief Displays the logger state and counters.
+ */
+void LOG_report(void)
+{
+	UART_puts("\r\nLogger: ");
+	UART_puts(log_on ? (char *)disk->name : "off");
+	UART_puts("\r\n\t blocks written: "); UART_putint(log_blocks);
+	UART_puts(" of ");                    UART_putint(LOG_BLOCK);
+	UART_puts(" bytes\t records: ");      UART_putint(log_records);
+	UART_puts("\r\n\t dropped, blocks full: "); UART_putint(log_dropped);
+	UART_puts("\t write errors: ");       UART_putint(log_errors);
+	UART_puts("\t slowest write: ");      UART_putint(log_write_max); UART_puts(" ms\r\n");
+}
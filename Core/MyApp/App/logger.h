@@ -0,0 +1,80 @@
+/*
+ * logger.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Recorder of the raw GNSS byte stream (UART4 or the USB receiver) and of every
+ * broadcast correction. Producers append records to one of two LOG_BLOCK buffers,
+ * never blocking; Logger_task writes a full block to the disk backend (logdisk.h) in
+ * one call, so every write is a whole number of sectors at a sector-aligned offset.
+ *
+ * Recording: a sequence of LOG_BLOCK blocks, each LOG_BLOCK_HDR + records + zeros, so
+ * a reader can seek to any block (index by seq/tick) without parsing the ones before.
+ * Decoder and replay: Tools/log_replay.py; host test: Tools/hosttest/logger_test.c.
+ *
+ * Backends: the RAM disk (logdisk_ram.c, always there) keeps the last blocks in CCM
+ * RAM, console 'log dump' (LOG_dump); with a USB stick on the host port each recording is
+ * a file on the stick (logdisk_fatfs.c, FatFs and the USB host MSC class). A stick that
+ * is plugged in during a RAM recording takes over at once: the RAM recording is closed
+ * (and stays there for 'log dump') and a new one starts on the stick. When the stick is
+ * pulled out the recording continues on the RAM disk.
+ */
+
+#ifndef MYAPP_APP_LOGGER_H_
+#define MYAPP_APP_LOGGER_H_
+
+#include <stdint.h>
+#include "NRF_driver.h"
+#include "logdisk.h"
+
+/// Logger_task checks for a partly filled block to flush (LOG_DISK.flush_ms) this often
+#define LOG_POLL_MS    500
+
+#define LOG_MAGIC      0x474f4c47UL // 'GLOG'
+#define LOG_VERSION    1
+
+/// record types
+typedef enum
+{
+	LOG_RAW_UART = 1, // GNSS bytes from UART4, as received
+	LOG_RAW_USB,      // GNSS bytes from the USB receiver (GPS_usb.c)
+	LOG_CORRECTION    // LOG_CORR_REC, every transmission
+} LOG_TYPE;
+
+/// start of every block, little-endian
+typedef struct __attribute__((packed))
+{
+	uint32_t magic;     // LOG_MAGIC
+	uint8_t  version;   // LOG_VERSION
+	uint8_t  sectors;   // LOG_BLOCK / LOG_SECTOR
+	uint16_t used;      // header + records; the rest of the block is zero
+	uint32_t seq;       // block number in this recording
+	uint32_t tick;      // ms since boot of the first record
+} LOG_BLOCK_HDR;
+
+/// start of every record; raw bytes of one source are appended to the last record
+/// while it is the last one in the block, so dt is the time of its first byte
+typedef struct __attribute__((packed))
+{
+	uint8_t  type;      // LOG_TYPE
+	uint8_t  len;       // payload bytes
+	uint16_t dt;        // ms since LOG_BLOCK_HDR.tick
+} LOG_REC_HDR;
+
+typedef struct __attribute__((packed))
+{
+	NRF_CORRECTION corr;   // as sent
+	uint8_t        status; // nrf24_transmit(): 0 = ACK
+} LOG_CORR_REC;
+
+extern void LOG_raw       (LOG_TYPE type, const uint8_t *data, uint32_t n);
+extern void LOG_correction(const NRF_CORRECTION *corr, uint8_t status);
+extern void LOG_run       (int on);
+extern void LOG_medium    (void);
+extern int  LOG_running   (void);
+extern void LOG_report    (void);
+extern void LOG_dump      (void);
+extern void Logger_task   (void *);
+
+#endif /* MYAPP_APP_LOGGER_H_ */
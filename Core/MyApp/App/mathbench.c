@@ -0,0 +1,252 @@
+/*
+ * mathbench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Math benchmark, see mathbench.h. One epoch is what the correction chain does with
+ * a fix: decode the two NMEA coordinates, take the east/north offset from the
+ * reference in m, update the weighted running mean and round it to the integer mm
+ * of the correction packet. The track is 64 epochs of a receiver standing still at
+ * the dummy position of GPS_Errorcalc.c, with 1-2 m wander and HDOP 0.7-1.6.
+ *
+ * Cycles come from DWT->CYCCNT with the scheduler suspended; interrupts still run,
+ * hence the best of BENCH_RUNS. The deviation is the largest difference of the
+ * per-epoch offset, in mm, from the double variant.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "GPS_parser.h"
+#include "mathbench.h"
+#include <math.h>
+
+#define BENCH_EPOCHS (sizeof(bench_track) / sizeof(bench_track[0]))
+
+/// the reference: the dummy position of GPS_Errorcalc.c
+#define BENCH_REF_LAT  52.236455
+#define BENCH_REF_LON  5.168583
+
+static const struct
+{
+	char    lat[11];   // ddmm.mmmmm, N
+	char    lon[12];   // dddmm.mmmmm, E
+	uint8_t hdop10;    // HDOP * 10
+} bench_track[] =
+{
+	{ "5214.18725", "00510.11516",  7 }, { "5214.18747", "00510.11531", 12 },
+	{ "5214.18709", "00510.11494", 10 }, { "5214.18731", "00510.11503",  8 },
+	{ "5214.18732", "00510.11541",  7 }, { "5214.18736", "00510.11523", 10 },
+	{ "5214.18719", "00510.11491",  7 }, { "5214.18703", "00510.11477", 10 },
+	{ "5214.18741", "00510.11497", 11 }, { "5214.18720", "00510.11516", 16 },
+	{ "5214.18708", "00510.11568",  9 }, { "5214.18730", "00510.11585", 10 },
+	{ "5214.18714", "00510.11605",  8 }, { "5214.18691", "00510.11577", 14 },
+	{ "5214.18686", "00510.11540", 12 }, { "5214.18649", "00510.11551", 12 },
+	{ "5214.18647", "00510.11598", 10 }, { "5214.18669", "00510.11601", 14 },
+	{ "5214.18697", "00510.11556", 11 }, { "5214.18694", "00510.11543", 15 },
+	{ "5214.18670", "00510.11564",  9 }, { "5214.18694", "00510.11544",  8 },
+	{ "5214.18700", "00510.11500", 12 }, { "5214.18694", "00510.11524", 14 },
+	{ "5214.18679", "00510.11505",  8 }, { "5214.18704", "00510.11493",  8 },
+	{ "5214.18734", "00510.11511", 16 }, { "5214.18769", "00510.11508", 11 },
+	{ "5214.18757", "00510.11444", 12 }, { "5214.18775", "00510.11454",  9 },
+	{ "5214.18753", "00510.11436", 10 }, { "5214.18752", "00510.11426", 10 },
+	{ "5214.18716", "00510.11475", 14 }, { "5214.18736", "00510.11494", 15 },
+	{ "5214.18733", "00510.11511", 13 }, { "5214.18743", "00510.11491", 13 },
+	{ "5214.18770", "00510.11488", 13 }, { "5214.18777", "00510.11484",  9 },
+	{ "5214.18788", "00510.11523",  7 }, { "5214.18757", "00510.11524", 11 },
+	{ "5214.18752", "00510.11539", 15 }, { "5214.18733", "00510.11564",  9 },
+	{ "5214.18725", "00510.11523", 16 }, { "5214.18708", "00510.11479", 14 },
+	{ "5214.18737", "00510.11449", 15 }, { "5214.18721", "00510.11474",  8 },
+	{ "5214.18703", "00510.11480", 10 }, { "5214.18718", "00510.11491",  9 },
+	{ "5214.18738", "00510.11518",  8 }, { "5214.18748", "00510.11517",  8 },
+	{ "5214.18771", "00510.11501",  8 }, { "5214.18786", "00510.11471",  9 },
+	{ "5214.18749", "00510.11416", 16 }, { "5214.18740", "00510.11437", 14 },
+	{ "5214.18761", "00510.11442", 14 }, { "5214.18754", "00510.11463", 12 },
+	{ "5214.18750", "00510.11432",  9 }, { "5214.18735", "00510.11437", 15 },
+	{ "5214.18716", "00510.11479",  7 }, { "5214.18718", "00510.11455",  8 },
+	{ "5214.18714", "00510.11437", 12 }, { "5214.18731", "00510.11427", 10 },
+	{ "5214.18699", "00510.11424", 12 }, { "5214.18685", "00510.11399", 10 },
+};
+
+/// one variant: offsets e/n in mm per epoch, for the comparison
+typedef void (*BENCH_FUNC)(int32_t *e_mm, int32_t *n_mm);
+
+static volatile int32_t bench_sink; // keeps the compiler from dropping the mean
+static GPS_ENU_REF      bench_enu;
+
+
+/**
+ * @brief (d)ddmm.mmmmm to degrees in double, as NMEA.c does it.
+ */
+static double bench_deg(const char *s)
+{
+	uint32_t ip = 0, fp = 0, n = 0, div = 1;
+
+	while (*s >= '0' && *s <= '9')
+		ip = ip * 10 + (*s++ - '0');
+	if (*s == '.')
+		for (s++; *s >= '0' && *s <= '9'; n++, div *= 10)
+			fp = fp * 10 + (*s++ - '0');
+
+	return (double)(ip / 100) + ((double)(ip % 100) + (double)fp / (double)div) / 60.0;
+}
+
+
+/**
+ * @brief (d)ddmm.mmmmm to nanodegrees, integer only.
+ */
+static int64_t bench_ndeg(const char *s)
+{
+	uint32_t ip = 0, fp = 0, div = 1;
+
+	while (*s >= '0' && *s <= '9')
+		ip = ip * 10 + (*s++ - '0');
+	if (*s == '.')
+		for (s++; *s >= '0' && *s <= '9'; div *= 10)
+			fp = fp * 10 + (*s++ - '0');
+
+	return (int64_t)(ip / 100) * 1000000000LL +
+	       ((int64_t)((ip % 100) * div + fp) * 1000000000LL) / (60 * (int64_t)div);
+}
+
+
+/**
+ * @brief Double throughout: the math before the float32 rework.
+ */
+static void bench_double(int32_t *e_mm, int32_t *n_mm)
+{
+	const double kn = bench_enu.m_per_deg_lat, ke = bench_enu.m_per_deg_lon;
+	double sw = 0.0, se = 0.0, sn = 0.0, e, n, w;
+	size_t i;
+
+	for (i = 0; i < BENCH_EPOCHS; i++)
+	{
+		n = (bench_deg(bench_track[i].lat) - BENCH_REF_LAT) * kn;
+		e = (bench_deg(bench_track[i].lon) - BENCH_REF_LON) * ke;
+		w = 100.0 / (bench_track[i].hdop10 * bench_track[i].hdop10);
+		sw += w;
+		se += w * e;
+		sn += w * n;
+		bench_sink = (int32_t)lrint(se / sw * 1000.0) + (int32_t)lrint(sn / sw * 1000.0);
+		if (e_mm)
+		{
+			e_mm[i] = (int32_t)lrint(e * 1000.0);
+			n_mm[i] = (int32_t)lrint(n * 1000.0);
+		}
+	}
+}
+
+
+/**
+ * @brief Float32 on the FPU after the double offset from the reference: GPS_enu().
+ */
+static void bench_float(int32_t *e_mm, int32_t *n_mm)
+{
+	float  sw = 0.0f, se = 0.0f, sn = 0.0f, e, n, u, w;
+	size_t i;
+
+	for (i = 0; i < BENCH_EPOCHS; i++)
+	{
+		GPS_enu(&bench_enu, bench_deg(bench_track[i].lat), bench_deg(bench_track[i].lon), NAN, &e, &n, &u);
+		w = 100.0f / (float)(bench_track[i].hdop10 * bench_track[i].hdop10);
+		sw += w;
+		se += w * e;
+		sn += w * n;
+		bench_sink = (int32_t)lrintf(se / sw * 1000.0f) + (int32_t)lrintf(sn / sw * 1000.0f);
+		if (e_mm)
+		{
+			e_mm[i] = (int32_t)lrintf(e * 1000.0f);
+			n_mm[i] = (int32_t)lrintf(n * 1000.0f);
+		}
+	}
+}
+
+
+/**
+ * @brief Fixed point: nanodegrees, scale factors in mm per nanodegree Q32, mean in mm
+ * with integer weights.
+ */
+static void bench_fixed(int32_t *e_mm, int32_t *n_mm)
+{
+	const int64_t ref_n = llround(BENCH_REF_LAT * 1e9), ref_e = llround(BENCH_REF_LON * 1e9);
+	const int64_t kn = llroundf(bench_enu.m_per_deg_lat * 4294.967296f); // * 1e-6 mm/ndeg * 2^32
+	const int64_t ke = llroundf(bench_enu.m_per_deg_lon * 4294.967296f);
+	int64_t se = 0, sn = 0;
+	int32_t sw = 0, e, n, w;
+	size_t  i;
+
+	for (i = 0; i < BENCH_EPOCHS; i++)
+	{
+		n = (int32_t)(((bench_ndeg(bench_track[i].lat) - ref_n) * kn + (1LL << 31)) >> 32);
+		e = (int32_t)(((bench_ndeg(bench_track[i].lon) - ref_e) * ke + (1LL << 31)) >> 32);
+		w = 10000 / (bench_track[i].hdop10 * bench_track[i].hdop10);
+		sw += w;
+		se += (int64_t)w * e;
+		sn += (int64_t)w * n;
+		bench_sink = (int32_t)(se / sw) + (int32_t)(sn / sw);
+		if (e_mm)
+		{
+			e_mm[i] = e;
+			n_mm[i] = n;
+		}
+	}
+}
+
+
+/**
+ * @brief Runs the three variants over the track and prints cycles per epoch and the
+ * deviation from double. Runs in the console task; takes about 1 ms.
+ */
+void BENCH_math(void)
+{
+	static const struct { BENCH_FUNC func; char *name; } variants[] =
+	{
+		{ bench_double, "double (library)" },
+		{ bench_float,  "float32 (FPU)   " },
+		{ bench_fixed,  "fixed point     " },
+	};
+	static int32_t ref_e[BENCH_EPOCHS], ref_n[BENCH_EPOCHS], e[BENCH_EPOCHS], n[BENCH_EPOCHS];
+	GPS_decimal_degrees_t ref = { BENCH_REF_LAT, BENCH_REF_LON, NAN };
+	uint32_t t0, cycles, best;
+	int32_t  dev;
+	size_t   v, r, i;
+
+	if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) // normally started by the CPU load sampling
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+	GPS_enu_init(&bench_enu, ref);
+	bench_double(ref_e, ref_n);
+
+	UART_puts("\r\nMath per epoch (2 coordinates, ENU offset, weighted mean, mm), ");
+	UART_putint(BENCH_EPOCHS); UART_puts(" epochs");
+	for (v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
+	{
+		best = UINT32_MAX;
+		for (r = 0; r < BENCH_RUNS; r++)
+		{
+			vTaskSuspendAll();
+			t0 = DWT->CYCCNT;
+			variants[v].func(NULL, NULL);
+			cycles = DWT->CYCCNT - t0;
+			xTaskResumeAll();
+			if (cycles < best)
+				best = cycles;
+		}
+
+		variants[v].func(e, n);
+		for (dev = 0, i = 0; i < BENCH_EPOCHS; i++)
+		{
+			dev = (abs(e[i] - ref_e[i]) > dev ? abs(e[i] - ref_e[i]) : dev);
+			dev = (abs(n[i] - ref_n[i]) > dev ? abs(n[i] - ref_n[i]) : dev);
+		}
+
+		UART_puts("\r\n\t "); UART_puts(variants[v].name);
+		UART_puts("  cycles: ");    UART_putint(best / BENCH_EPOCHS);
+		UART_puts("  us: ");        UART_putint(best / BENCH_EPOCHS / (SystemCoreClock / 1000000UL));
+		UART_puts("  max dev mm: "); UART_putint(dev);
+	}
+	UART_puts("\r\n");
+}
@@ -0,0 +1,20 @@
+/*
+ * mathbench.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Benchmark of the per-epoch correction math in three number formats: double (the
+ * Cortex-M4F FPU is single precision, so every double operation is a library call),
+ * float32 on the FPU (the production path, GPS_enu) and fixed point. Console: 'bench'.
+ */
+
+#ifndef MYAPP_APP_MATHBENCH_H_
+#define MYAPP_APP_MATHBENCH_H_
+
+/// runs per variant; the fastest counts (a run can be interrupted)
+#define BENCH_RUNS 3
+
+extern void BENCH_math(void);
+
+#endif /* MYAPP_APP_MATHBENCH_H_ */
@@ -0,0 +1,112 @@
+/*
+ * seqbuf.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Seqlock over a small ring of slots, see seqbuf.h. Only plain loads, stores and
+ * barriers are used, so the same code runs from tasks on the target and from
+ * threads on a host.
+ */
+
+#include <string.h>
+#include "seqbuf.h"
+
+#define SEQBUF_SLOT(sb, i) ((uint8_t *)(sb)->slots + (i) * (sb)->size)
+#define SEQBUF_BARRIER()   __sync_synchronize() // dmb on the Cortex-M4
+
+
+/**
+ * @brief Sequence number the next value will be published with; 0 means
+ * 'nothing published' and is skipped on wrap-around.
+ */
+static uint32_t seqbuf_next(SEQBUF *sb)
+{
+	uint32_t next = sb->seq + 1;
+
+	// on wrap-around restart in the slot after the published one
+	return (next == 0 ? sb->seq % SEQBUF_SLOTS + 1 : next);
+}
+
+
+/**
+ * @brief Starts writing the next value. Only one producer may use the container.
+ * @return Pointer to the slot to fill; it is published by seqbuf_commit()
+ */
+void *seqbuf_begin(SEQBUF *sb)
+{
+	uint32_t next = seqbuf_next(sb);
+	uint32_t i    = next % SEQBUF_SLOTS;
+
+	sb->ver[i] = 2 * next - 1; // odd: readers of this slot will retry
+	SEQBUF_BARRIER();
+	return SEQBUF_SLOT(sb, i);
+}
+
+
+/**
+ * @brief Publishes the slot handed out by seqbuf_begin().
+ * @return Sequence number of the published value
+ */
+uint32_t seqbuf_commit(SEQBUF *sb)
+{
+	uint32_t next = seqbuf_next(sb);
+
+	SEQBUF_BARRIER(); // slot contents before the version
+	sb->ver[next % SEQBUF_SLOTS] = 2 * next; // even and tied to the sequence number
+	SEQBUF_BARRIER(); // version before the publication
+	sb->seq = next;
+	return next;
+}
+
+
+/**
+ * @brief Copies the latest published value; retries when the producer overwrote
+ * the slot during the copy.
+ * @param dest Destination of at least sb->size bytes
+ * @return Sequence number of the copied value, 0 if nothing was published yet (dest untouched)
+ */
+uint32_t seqbuf_read(SEQBUF *sb, void *dest)
+{
+	uint32_t seq, i, ver;
+
+	while (1)
+	{
+		seq = sb->seq;
+		if (seq == 0)
+			return 0;
+
+		i   = seq % SEQBUF_SLOTS;
+		SEQBUF_BARRIER();
+		ver = sb->ver[i];
+		SEQBUF_BARRIER();
+
+		// the slot must still hold this sequence number: not being rewritten, not lapped
+		if (ver == 2 * seq)
+		{
+			memcpy(dest, SEQBUF_SLOT(sb, i), sb->size);
+			SEQBUF_BARRIER();
+			if (sb->ver[i] == ver)
+				return seq;
+		}
+		sb->retries++;
+	}
+}
+
+
+/**
+ * @brief Returns the sequence number of the latest published value, without copying.
+ */
+uint32_t seqbuf_seq(SEQBUF *sb)
+{
+	return sb->seq;
+}
+
+
+/**
+ * @brief Has a value been published since sequence number 'since'?
+ */
+int seqbuf_changed(SEQBUF *sb, uint32_t since)
+{
+	return sb->seq != since;
+}
@@ -0,0 +1,41 @@
+/*
+ * seqbuf.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ */
+
+#ifndef MYAPP_APP_SEQBUF_H_
+#define MYAPP_APP_SEQBUF_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/// Number of slots; the producer has to publish SEQBUF_SLOTS times during one read to force a retry
+#define SEQBUF_SLOTS 3
+
+/**
+ * @brief Lock-free 'latest value' container for one producer and any number of readers.
+ * Every slot has its own seqlock version (odd while being written). The producer
+ * fills the slot after the published one and publishes it with a single update of seq,
+ * so readers never block the producer and the producer never blocks on a reader.
+ */
+typedef struct
+{
+	volatile uint32_t seq;               // sequence number of the last published value, 0 = none yet
+	volatile uint32_t ver[SEQBUF_SLOTS]; // seqlock version per slot: 2*seq when stable, odd while written
+	void             *slots;             // storage of SEQBUF_SLOTS values
+	size_t            size;              // size of one value
+	volatile uint32_t retries;           // torn reads that had to be repeated
+} SEQBUF;
+
+/// Static initializer; storage must be an array of SEQBUF_SLOTS values
+#define SEQBUF_INIT(storage) { 0, {0}, (storage), sizeof((storage)[0]), 0 }
+
+extern void    *seqbuf_begin  (SEQBUF *sb);
+extern uint32_t seqbuf_commit (SEQBUF *sb);
+extern uint32_t seqbuf_read   (SEQBUF *sb, void *dest);
+extern uint32_t seqbuf_seq    (SEQBUF *sb);
+extern int      seqbuf_changed(SEQBUF *sb, uint32_t since);
+
+#endif /* MYAPP_APP_SEQBUF_H_ */
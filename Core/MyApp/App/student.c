@@ -10,6 +10,8 @@
 #include "main.h"
 #include "cmsis_os.h"
 
+#if APP_PROFILE == APP_PROFILE_DEMO // lesvoorbeeld, niet in de production build
+
 
 /**
 * @brief Oefentask voor studenten
@@ -33,3 +35,5 @@ void Student_task1 (void *argument)
     	}
 	}
 }
+
+#endif
@@ -0,0 +1,180 @@
+/*
+ * supervisor.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Task supervisor, see supervisor.h. The supervised tasks block at most SUP_BEAT_MS
+ * and call SUP_alive() every pass of their loop, so a healthy task is never late even
+ * without GPS or corrections. The supervisor runs at high priority: a task starved
+ * by a busy loop at a higher priority is caught as well. A task the user stopped from
+ * the menu ('s') is not supervised while it is suspended.
+ *
+ * The IWDG runs on the LSI and cannot be stopped once started; it is set up with
+ * registers, the HAL IWDG module is not used in this project. It is frozen while the
+ * core is halted by the debugger.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "supervisor.h"
+
+/// deadlines: no heartbeat for this long counts as hung. Larger than SUP_BEAT_MS plus
+/// a flash sector erase (config save, up to 2 s in which no task runs).
+static const struct
+{
+	char     *name;        // as in tasks[]
+	uint32_t  deadline_ms;
+} sup_tasks[SUP_COUNT] =
+{
+	[SUP_GPS_NMEA]  = { "GPS_getNMEA",   5000 },
+	[SUP_ERRORCALC] = { "GPS_Errorcalc", 5000 },
+	[SUP_NRF]       = { "NRF_driver",    5000 },
+};
+
+static volatile TickType_t sup_beat[SUP_COUNT];  // tick of the last heartbeat
+
+/// survives the watchdog reset; cleared at power-on
+static SUP_RECORD sup_record __attribute__((section(".noinit")));
+static SUP_RECORD sup_last;         // the record as found at boot
+static int        sup_wdog_reset;   // TRUE: this boot followed an IWDG reset
+
+
+/**
+ * @brief Heartbeat of a supervised task.
+ */
+void SUP_alive(SUP_ID id)
+{
+	sup_beat[id] = xTaskGetTickCount();
+}
+
+
+/**
+ * @brief Checks why the board was reset, then clears the reset flags.
+ */
+static void sup_reset_cause(void)
+{
+	uint32_t csr = RCC->CSR;
+
+	RCC->CSR |= RCC_CSR_RMVF;
+
+	if ((csr & (RCC_CSR_PORRSTF | RCC_CSR_BORRSTF)) || sup_record.magic != SUP_RECORD_MAGIC)
+	{
+		memset(&sup_record, 0, sizeof(sup_record)); // RAM content is random after power-on
+		sup_record.magic = SUP_RECORD_MAGIC;
+		sup_record.id    = SUP_COUNT;
+	}
+
+	sup_wdog_reset = ((csr & RCC_CSR_IWDGRSTF) != 0);
+	if (sup_wdog_reset)
+		sup_record.resets++;
+
+	sup_last = sup_record;
+	sup_record.id = SUP_COUNT; // reported; a new entry is made at the next miss
+}
+
+
+/**
+ * @brief Starts the IWDG with a timeout of SUP_IWDG_MS.
+ */
+static void sup_iwdg_start(void)
+{
+	DBGMCU->APB1FZ |= DBGMCU_APB1_FZ_DBG_IWDG_STOP; // a breakpoint does not reset the board
+
+	IWDG->KR  = 0xCCCC;                 // start; the LSI starts with it
+	IWDG->KR  = 0x5555;                 // unlock PR and RLR
+	IWDG->PR  = IWDG_PR_PR_2;           // /64: 2 ms per count at 32 kHz
+	IWDG->RLR = SUP_IWDG_MS / 2 - 1;
+	while (IWDG->SR)                    // wait until both are written
+		;
+	IWDG->KR  = 0xAAAA;                 // reload
+}
+
+
+/**
+ * @brief Supervisor task: checks the heartbeats every SUP_PERIOD_MS and feeds the
+ * IWDG as long as all supervised tasks are on time.
+ * @param *argument Not used
+ */
+void Supervisor_task(void *argument)
+{
+	TickType_t   now;
+	osThreadId_t hTask;
+	int          id, failed = FALSE;
+
+	sup_reset_cause();
+
+	now = xTaskGetTickCount();
+	for (id = 0; id < SUP_COUNT; id++)
+		sup_beat[id] = now; // the deadline starts at boot
+
+	sup_iwdg_start();
+
+	UART_puts((char *)__func__); UART_puts(" started\r\n");
+	if (sup_wdog_reset)
+		SUP_report();
+
+	while (TRUE)
+	{
+		osDelay(SUP_PERIOD_MS);
+		now = xTaskGetTickCount();
+
+		for (id = 0; id < SUP_COUNT && !failed; id++)
+		{
+			hTask = GetTaskhandle(sup_tasks[id].name);
+			if (!hTask || eTaskGetState(hTask) == eSuspended) // not started, or stopped from the menu
+			{
+				sup_beat[id] = now;
+				continue;
+			}
+
+			if (now - sup_beat[id] > pdMS_TO_TICKS(sup_tasks[id].deadline_ms))
+			{
+				sup_record.id        = id;
+				sup_record.late_ms   = (now - sup_beat[id]) * portTICK_PERIOD_MS;
+				sup_record.uptime_ms = now * portTICK_PERIOD_MS;
+				failed = TRUE;
+
+				UART_puts("\r\nSupervisor: "); UART_puts(sup_tasks[id].name);
+				UART_puts(" missed its deadline, reset by watchdog\r\n");
+			}
+		}
+
+		if (!failed)
+			IWDG->KR = 0xAAAA; // feed
+	}
+}
+
+
+/**
+ * @brief Displays the heartbeats and the cause of the last watchdog reset.
+ */
+void SUP_report(void)
+{
+	TickType_t now = xTaskGetTickCount();
+	int        id;
+
+	UART_puts("\r\nSupervisor (IWDG ");     UART_putint(SUP_IWDG_MS); UART_puts(" ms)");
+	for (id = 0; id < SUP_COUNT; id++)
+	{
+		UART_puts("\r\n\t ");               UART_puts(sup_tasks[id].name);
+		UART_puts("\t last beat: ");        UART_putint((now - sup_beat[id]) * portTICK_PERIOD_MS);
+		UART_puts(" ms ago, deadline: ");   UART_putint(sup_tasks[id].deadline_ms); UART_puts(" ms");
+	}
+
+	UART_puts("\r\n\t watchdog resets: ");  UART_putint(sup_last.resets);
+	if (sup_wdog_reset)
+	{
+		UART_puts("\r\n\t last boot: watchdog reset, ");
+		if (sup_last.id < SUP_COUNT)
+		{
+			UART_puts(sup_tasks[sup_last.id].name);
+			UART_puts(" late ");            UART_putint(sup_last.late_ms);
+			UART_puts(" ms at uptime ");    UART_putint(sup_last.uptime_ms); UART_puts(" ms");
+		}
+		else
+			UART_puts("no task late (system halted)");
+	}
+	UART_puts("\r\n");
+}
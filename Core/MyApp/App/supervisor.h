@@ -0,0 +1,50 @@
+/*
+ * supervisor.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Task supervisor: the correction chain (GPS_getNMEA, GPS_Errorcalc, NRF_Driver)
+ * reports a heartbeat with SUP_alive(); the supervisor feeds the independent
+ * watchdog (IWDG) only while every heartbeat is within its deadline. A task that
+ * misses its deadline is recorded in no-init RAM, then the IWDG resets the board.
+ */
+
+#ifndef MYAPP_APP_SUPERVISOR_H_
+#define MYAPP_APP_SUPERVISOR_H_
+
+#include <stdint.h>
+
+/// supervisor period; the IWDG is fed at most this often
+#define SUP_PERIOD_MS  250
+/// longest a supervised task may block without a heartbeat; its deadline is larger
+#define SUP_BEAT_MS    1000
+/// IWDG timeout: LSI (~32 kHz) / 64, reload SUP_IWDG_MS / 2; survives a flash sector erase
+#define SUP_IWDG_MS    4000
+
+/// supervised tasks, index in the deadline table of supervisor.c
+typedef enum
+{
+	SUP_GPS_NMEA = 0,
+	SUP_ERRORCALC,
+	SUP_NRF,
+	SUP_COUNT
+} SUP_ID;
+
+/// why the last reset happened, kept in no-init RAM over the reset
+typedef struct
+{
+	uint32_t magic;     // SUP_RECORD_MAGIC if the rest is valid
+	uint32_t resets;    // IWDG resets since power-on
+	uint32_t id;        // SUP_ID of the task that was late
+	uint32_t late_ms;   // time since its last heartbeat
+	uint32_t uptime_ms; // ms since boot when it was detected
+} SUP_RECORD;
+
+#define SUP_RECORD_MAGIC 0x57444f47UL // 'WDOG'
+
+extern void Supervisor_task(void *);
+extern void SUP_alive (SUP_ID id);
+extern void SUP_report(void);
+
+#endif /* MYAPP_APP_SUPERVISOR_H_ */
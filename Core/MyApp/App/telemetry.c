@@ -0,0 +1,288 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Binary telemetry, see telemetry.h. Producers only copy a small packed record
+ * into hTLM_MsgBuf (never blocking, a full buffer drops the record and counts it);
+ * the low-priority Telemetry_task adds the CRC, COBS-encodes the frame and sends
+ * it to UART2 with a single transmit. While the binary mode is on, console text
+ * from UART_puts() is sent as TLM_TEXT records, so the stream stays decodable and
+ * the menu keeps working.
+ */
+
+#include <admin.h>
+#include "main.h"
+#include "cmsis_os.h"
+#include "telemetry.h"
+#include <math.h>
+
+#define TLM_TIM TIM2  // 32-bit timer, not used by CubeMX: the latency clock
+
+int tlm_binary = FALSE;
+
+static volatile uint8_t  tlm_seq;     // frame counter
+static volatile uint32_t tlm_frames;  // frames sent
+static volatile uint32_t tlm_dropped; // records lost, buffer full
+static volatile uint32_t tlm_bytes;   // bytes sent, incl. framing
+
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xffff), bitwise; records are short.
+ */
+static uint16_t tlm_crc16(const uint8_t *p, uint16_t len)
+{
+	uint16_t crc = 0xffff;
+	int      i;
+
+	while (len--)
+	{
+		crc ^= (uint16_t)*p++ << 8;
+		for (i = 0; i < 8; i++)
+			crc = (crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1);
+	}
+	return crc;
+}
+
+
+/**
+ * @brief COBS-encodes len bytes (len < 254) and adds the 0x00 delimiter.
+ * @return Length of the frame in out, at most len + 2
+ */
+static uint16_t tlm_cobs(const uint8_t *in, uint16_t len, uint8_t *out)
+{
+	uint16_t code_pos = 0, o = 1;
+	uint8_t  code = 1;
+
+	while (len--)
+	{
+		if (*in)
+		{
+			out[o++] = *in;
+			code++;
+		}
+		else
+		{
+			out[code_pos] = code;
+			code_pos = o++;
+			code = 1;
+		}
+		in++;
+	}
+	out[code_pos] = code;
+	out[o++] = 0x00;
+	return o;
+}
+
+
+/**
+ * @brief Queues one record for the telemetry task. Never blocks; does nothing
+ * while the binary mode is off. Call from tasks only, not from an ISR.
+ */
+void tlm_send(TLM_TYPE type, const void *payload, uint16_t len)
+{
+	uint8_t rec[2 + TLM_MAXPAYLOAD];
+	size_t  sent;
+
+	if (!tlm_binary || !hTLM_MsgBuf)
+		return;
+	if (len > TLM_MAXPAYLOAD)
+		len = TLM_MAXPAYLOAD;
+
+	rec[0] = type;
+	memcpy(&rec[2], payload, len);
+
+	// a message buffer allows one writer at a time; the seq is taken in the same section
+	vTaskSuspendAll();
+	rec[1] = tlm_seq;
+	if ((sent = xMessageBufferSend(hTLM_MsgBuf, rec, len + 2, 0)) != 0)
+		tlm_seq++;
+	xTaskResumeAll();
+
+	if (!sent)
+		tlm_dropped++;
+}
+
+
+/**
+ * @brief Console text as TLM_TEXT records, installed as UART_text_hook.
+ */
+static void tlm_text(const char *s)
+{
+	size_t len = strlen(s);
+	size_t n;
+
+	while (len)
+	{
+		n = (len > TLM_MAXPAYLOAD ? TLM_MAXPAYLOAD : len);
+		tlm_send(TLM_TEXT, s, n);
+		s   += n;
+		len -= n;
+	}
+}
+
+
+/**
+ * @brief Switches UART2 between the text console and the binary stream.
+ */
+void tlm_set_binary(int on)
+{
+	tlm_binary     = on;
+	UART_text_hook = (on ? tlm_text : NULL);
+}
+
+
+/**
+ * @brief Starts TIM2 as a free-running counter at TLM_CLOCK_HZ, the clock of tlm_stamp().
+ * Unlike DWT->CYCCNT it keeps counting in WFI, so a latency that spans tickless idle
+ * is measured in full. Called from main() before the scheduler starts.
+ */
+void tlm_clock_init(void)
+{
+	__HAL_RCC_TIM2_CLK_ENABLE();
+
+	// APB1 runs at HCLK/4, so the timer clock is twice PCLK1
+	TLM_TIM->CR1 = 0;
+	TLM_TIM->PSC = 2 * HAL_RCC_GetPCLK1Freq() / TLM_CLOCK_HZ - 1;
+	TLM_TIM->ARR = 0xffffffff;
+	TLM_TIM->CNT = 0;
+	TLM_TIM->EGR = TIM_EGR_UG; // load the prescaler
+	TLM_TIM->CR1 = TIM_CR1_CEN;
+}
+
+
+/**
+ * @brief Timestamp for tlm_latency(): the TIM2 latency clock, in us. Safe from any task or ISR.
+ */
+uint32_t tlm_stamp(void)
+{
+	return TLM_TIM->CNT;
+}
+
+
+/**
+ * @brief Sends a TLM_LATENCY record with the time since stamp.
+ */
+void tlm_latency(TLM_PROBE probe, uint32_t stamp)
+{
+	TLM_LATENCY_REC rec;
+
+	if (!tlm_binary)
+		return;
+
+	rec.probe = probe;
+	rec.us    = (TLM_TIM->CNT - stamp) / (TLM_CLOCK_HZ / 1000000UL);
+	tlm_send(TLM_LATENCY, &rec, sizeof(rec));
+}
+
+
+/**
+ * @brief Sends a TLM_FIX record of a published fix.
+ */
+void tlm_fix(const GPS_FIX *fix)
+{
+	TLM_FIX_REC rec;
+
+	if (!tlm_binary)
+		return;
+
+	rec.seq     = fix->seq;
+	rec.time    = fix->time;
+	rec.lat     = (int32_t)lrint(fix->latitude  * 1e7);
+	rec.lon     = (int32_t)lrint(fix->longitude * 1e7);
+	rec.alt     = (isnan(fix->altitude) ? INT32_MIN : (int32_t)lrintf(fix->altitude * 1000.0f));
+	rec.speed   = (uint16_t)lrintf(fix->speed * 100.0f);
+	rec.hdop    = (uint16_t)lrintf(fix->hdop  * 100.0f);
+	rec.std_lat = (fix->std_lat < 65.535f ? (uint16_t)lrintf(fix->std_lat * 1000.0f) : UINT16_MAX);
+	rec.std_lon = (fix->std_lon < 65.535f ? (uint16_t)lrintf(fix->std_lon * 1000.0f) : UINT16_MAX);
+	rec.quality = fix->quality;
+	rec.numsv   = fix->numsv;
+	rec.status  = fix->status;
+	rec.mode    = GPS_mode_get();
+	tlm_send(TLM_FIX, &rec, sizeof(rec));
+}
+
+
+/**
+ * @brief Sends the TLM_TASKS record: heap, load and the stack of every task in tasks[].
+ */
+static void tlm_tasks(void)
+{
+	uint8_t       rec[TLM_MAXPAYLOAD];
+	TLM_TASKS_REC hdr;
+	TLM_TASK_REC  t;
+	PTASKDATA     ptd = tasks;
+	uint16_t      len = sizeof(hdr);
+	uint8_t       nr;
+
+	for (nr = 1; ptd->func != NULL && len + sizeof(t) <= sizeof(rec); ptd++, nr++)
+	{
+		t.nr       = nr;
+		t.state    = (uint8_t)eTaskGetState(ptd->hTask);
+		t.priority = (uint8_t)ptd->attr.priority;
+		t.free     = (uint16_t)uxTaskGetStackHighWaterMark(ptd->hTask);
+		memcpy(&rec[len], &t, sizeof(t));
+		len += sizeof(t);
+	}
+
+	hdr.free_heap = xPortGetFreeHeapSize();
+	hdr.dropped   = (uint16_t)tlm_dropped;
+	hdr.cpu       = (uint8_t)GetCPULoad();
+	hdr.ntasks    = nr - 1;
+	memcpy(rec, &hdr, sizeof(hdr));
+	tlm_send(TLM_TASKS, rec, len);
+}
+
+
+/**
+ * @brief Telemetry task: frames the queued records and sends them to UART2.
+ * Sends TLM_TASKS every TLM_TASKS_MS while the binary mode is on.
+ * @param *argument Not used
+ */
+void Telemetry_task(void *argument)
+{
+	uint8_t    rec[2 + TLM_MAXPAYLOAD + 2];     // type, seq, payload, crc
+	uint8_t    frame[sizeof(rec) + 2];          // COBS: 1 overhead byte (< 254 bytes) + 0x00
+	TickType_t last = xTaskGetTickCount();
+	size_t     len;
+	uint16_t   crc;
+
+	UART_puts((char *)__func__); UART_puts(" started\r\n");
+
+	while (TRUE)
+	{
+		len = xMessageBufferReceive(hTLM_MsgBuf, rec, 2 + TLM_MAXPAYLOAD, pdMS_TO_TICKS(TLM_TASKS_MS));
+
+		if (len)
+		{
+			crc = tlm_crc16(rec, len);
+			rec[len++] = crc & 0xff;
+			rec[len++] = crc >> 8;
+			len = tlm_cobs(rec, len, frame);
+			UART_write(frame, len);
+			tlm_frames++;
+			tlm_bytes += len;
+		}
+
+		if (tlm_binary && xTaskGetTickCount() - last >= pdMS_TO_TICKS(TLM_TASKS_MS))
+		{
+			last = xTaskGetTickCount();
+			tlm_tasks();
+		}
+	}
+}
+
+
+/**
+ * @brief Displays the telemetry counters (as text, or as TLM_TEXT in binary mode).
+ */
+void tlm_report(void)
+{
+	UART_puts("\r\nTelemetry (UART2)");
+	UART_puts("\r\n\t mode: ");    UART_puts(tlm_binary ? "binary" : "text");
+	UART_puts("\t frames: ");      UART_putint(tlm_frames);
+	UART_puts("\t bytes: ");       UART_putint(tlm_bytes);
+	UART_puts("\t dropped: ");     UART_putint(tlm_dropped);
+	UART_puts("\r\n");
+}
@@ -0,0 +1,102 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Binary telemetry on UART2. Every record is one frame:
+ *   COBS( type | seq | payload | crc16 ) 0x00
+ * seq counts all frames (gaps = lost frames), crc16 is CRC-16/CCITT-FALSE over
+ * type..payload, little-endian. All payloads are packed little-endian structs.
+ * Decoder: Tools/tlm_decode.py.
+ */
+
+#ifndef MYAPP_APP_TELEMETRY_H_
+#define MYAPP_APP_TELEMETRY_H_
+
+#include <stdint.h>
+#include "GPS_bus.h"
+
+/// largest payload of one record
+#define TLM_MAXPAYLOAD  96
+/// bytes in the record buffer between the producers and the telemetry task
+#define TLM_MSGBUF_SIZE 768
+/// period of the TLM_TASKS record
+#define TLM_TASKS_MS    1000
+/// latency clock: TIM2, 32-bit and free-running (wraps after 71 minutes)
+#define TLM_CLOCK_HZ    1000000
+
+/// record types
+typedef enum
+{
+	TLM_FIX = 1,   // TLM_FIX_REC, every epoch
+	TLM_ERROR,     // NRF_CORRECTION as sent to the radio
+	TLM_RADIO,     // TLM_RADIO_REC, every transmission
+	TLM_TASKS,     // TLM_TASKS_REC + TLM_TASK_REC per task, every TLM_TASKS_MS
+	TLM_LATENCY,   // TLM_LATENCY_REC
+	TLM_TEXT       // console text while the binary mode is on
+} TLM_TYPE;
+
+/// latency probes
+typedef enum
+{
+	TLM_PROBE_FIX_TO_CORR = 1, // fix published -> correction ready (errorcalc)
+	TLM_PROBE_CORR_TO_TX       // correction ready -> radio transmit done
+} TLM_PROBE;
+
+typedef struct __attribute__((packed))
+{
+	uint32_t seq;        // GPS_FIX.seq
+	uint32_t time;       // ms since midnight (UTC)
+	int32_t  lat;        // 1e-7 degrees
+	int32_t  lon;        // 1e-7 degrees
+	int32_t  alt;        // mm, INT32_MIN if unknown
+	uint16_t speed;      // 0.01 knots
+	uint16_t hdop;       // 0.01
+	uint16_t std_lat;    // mm, 0 = no GST
+	uint16_t std_lon;    // mm
+	uint8_t  quality;
+	uint8_t  numsv;
+	char     status;     // A/V
+	uint8_t  mode;       // GPS_MODE
+} TLM_FIX_REC;
+
+typedef struct __attribute__((packed))
+{
+	uint16_t seq;        // NRF_CORRECTION.seq
+	uint8_t  status;     // nrf24_transmit(): 0 = OK
+} TLM_RADIO_REC;
+
+typedef struct __attribute__((packed))
+{
+	uint32_t free_heap;  // bytes
+	uint16_t dropped;    // records lost, buffer full
+	uint8_t  cpu;        // load in %
+	uint8_t  ntasks;     // number of TLM_TASK_REC that follow
+} TLM_TASKS_REC;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t  nr;         // number as in the menu (DisplayTaskData)
+	uint8_t  state;      // eTaskState
+	uint8_t  priority;
+	uint16_t free;       // stack high-water mark, words
+} TLM_TASK_REC;
+
+typedef struct __attribute__((packed))
+{
+	uint8_t  probe;      // TLM_PROBE
+	uint32_t us;         // elapsed time from the TIM2 latency clock, sleep included
+} TLM_LATENCY_REC;
+
+extern void     Telemetry_task(void *);
+extern int      tlm_binary;   // TRUE: UART2 carries frames, console text becomes TLM_TEXT
+extern void     tlm_set_binary(int on);
+extern void     tlm_clock_init(void);
+extern void     tlm_send   (TLM_TYPE type, const void *payload, uint16_t len);
+extern uint32_t tlm_stamp  (void);
+extern void     tlm_latency(TLM_PROBE probe, uint32_t stamp);
+extern void     tlm_fix    (const GPS_FIX *fix);
+extern void     tlm_report (void);
+
+#endif /* MYAPP_APP_TELEMETRY_H_ */
@@ -3,33 +3,75 @@ Author: 	J.F. van der Bent
 			W Pielage & E Helmond
 
 Date:		24-11-2021
-Revision:	5
+Revision:	6
 
     buzzer.c:
           HAL_ Buzzer-driver for ARM-board v5
 
     pin-info:
-           PC8 - Buzzer
+           PC8 - Buzzer, TIM3_CH3 (AF2)
 
+    The tone is a 50% PWM square wave from TIM3, so a running tone costs no CPU.
+    BUZZER_tone() only writes two registers and is safe from any task or ISR; the
+    patterns (beeper.c) are timed by a software timer. The .ioc still has PC8 as a
+    GPIO output, BUZZER_init() switches it to the timer.
 */
 
 #include "main.h"
 #include "buzzer.h"
 
+#define BUZZER_TIM      TIM3
+#define BUZZER_CNT_HZ   1000000UL   // counter clock after the prescaler
+
 void BUZZER_init(void)
 {
-		// kept in place for downward compatibility
+	GPIO_InitTypeDef GPIO_InitStruct = {0};
+
+	__HAL_RCC_TIM3_CLK_ENABLE();
+
+	// APB1 runs at HCLK/4, so the timer clock is twice PCLK1
+	BUZZER_TIM->CR1   = TIM_CR1_ARPE;
+	BUZZER_TIM->PSC   = 2 * HAL_RCC_GetPCLK1Freq() / BUZZER_CNT_HZ - 1;
+	BUZZER_TIM->ARR   = BUZZER_CNT_HZ / 1000 - 1;
+	BUZZER_TIM->CCR3  = 0;                                                  // silent
+	BUZZER_TIM->CCMR2 = TIM_CCMR2_OC3M_2 | TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3PE; // PWM mode 1, preloaded
+	BUZZER_TIM->EGR   = TIM_EGR_UG;
+	BUZZER_TIM->CCER  = TIM_CCER_CC3E;
+	BUZZER_TIM->CR1  |= TIM_CR1_CEN;
+
+	GPIO_InitStruct.Pin       = Buzzer_Pin;
+	GPIO_InitStruct.Mode      = GPIO_MODE_AF_PP;
+	GPIO_InitStruct.Pull      = GPIO_NOPULL;
+	GPIO_InitStruct.Speed     = GPIO_SPEED_FREQ_LOW;
+	GPIO_InitStruct.Alternate = GPIO_AF2_TIM3;
+	HAL_GPIO_Init(Buzzer_GPIO_Port, &GPIO_InitStruct);
 }
 
-void BUZZER_set(int counter)
+// Zet een toon aan (hz) of uit (0); de nieuwe waarde gaat in aan het eind van de
+// lopende periode, dus zonder klik
+void BUZZER_tone(unsigned int hz)
 {
-	while(counter--)
+	uint32_t period;
+
+	if (!hz)
 	{
-		HAL_GPIO_WritePin(Buzzer_GPIO_Port, Buzzer_Pin, GPIO_PIN_SET);
-		HAL_Delay(1);
-		HAL_GPIO_WritePin(Buzzer_GPIO_Port, Buzzer_Pin, GPIO_PIN_RESET);
-		HAL_Delay(1);
+		BUZZER_TIM->CCR3 = 0;
+		return;
 	}
+	period = BUZZER_CNT_HZ / hz;
+	if (period > 0x10000) // 16-bit timer: lowest tone about 16 Hz
+		period = 0x10000;
+	if (period < 2)
+		period = 2;
+	BUZZER_TIM->ARR  = period - 1;
+	BUZZER_TIM->CCR3 = period / 2;
+}
+
+void BUZZER_set(int counter)
+{
+	BUZZER_tone(500);
+	HAL_Delay(2 * counter);
+	BUZZER_tone(0);
 }
 
 void Buzzer_put(unsigned int counter)
@@ -40,17 +82,14 @@ void Buzzer_put(unsigned int counter)
 
 // Maak een piepje met meegegeven lengte
 // toevoeging om compatibel te blijven met ARM v4.2
+// Blokkeert (ongeveer time/4 ms) zonder tick-interrupt, alleen voor error_HaltOS;
+// tasks en ISR's gebruiken BEEP_play() (beeper.c)
 void BUZZER_put(unsigned int time)
 {
     volatile unsigned int i;
-    volatile unsigned int k=0;
-
-	while (k++<100)
-    {
-		HAL_GPIO_WritePin(Buzzer_GPIO_Port, Buzzer_Pin, GPIO_PIN_SET);
-		for (i=0;i<(time+k);i++);
-		HAL_GPIO_WritePin(Buzzer_GPIO_Port, Buzzer_Pin, GPIO_PIN_RESET);
-		for (i=0;(i<time+k);i++);
-	}
-}
+    unsigned int n = time * (SystemCoreClock / 24000); // ~6 cycles per pass
 
+	BUZZER_tone(2000);
+	for (i=0;i<n;i++);
+	BUZZER_tone(0);
+}
@@ -3,17 +3,18 @@ Author: 	J.F. van der Bent
 			W Pielage & E Helmond
 
 Date:		24-11-2021
-Revision:	5
+Revision:	6
 
     buzzer.c:
           HAL_ Buzzer-driver for ARM-board v5
 
     pin-info:
-           PC8 - Buzzer
+           PC8 - Buzzer, TIM3_CH3 (AF2)
 
 */
 
 void BUZZER_init(void);
+void BUZZER_tone(unsigned int);
 void BUZZER_set(int);
 void BUZZER_put(unsigned int);
 
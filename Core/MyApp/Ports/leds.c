@@ -18,6 +18,9 @@ After that, you can put an 8 bit value to the LEDs
 
 #include "main.h"
 
+/// SCK/RCK high time: 5 cycles at 168 MHz plus the bus write
+#define LED_PULSE() do { __NOP(); __NOP(); __NOP(); __NOP(); __NOP(); } while (0)
+
 
 /* LED Initialize
  * This function initializes the pins reset state
@@ -31,7 +34,15 @@ void LED_init(void)
 }
 
 /* LED put
- * This function puts an 8 bit value to the LEDs, where left is the LSB
+ * This function puts an 8 bit value to the LEDs, where left is the LSB.
+ * The pins have no SPI function. Timer-paced DMA could clock them: a TIM1 or TIM8
+ * request can start a DMA2 transfer (DMA1 cannot reach the AHB1 GPIO ports) from a
+ * table of BSRR words. But SER is on GPIOA and SCK/RCK on GPIOB, so that takes two
+ * streams on two requests of one timer and a table of about 34 words per byte. For
+ * at most 8 updates a second (ledstatus.c writes only on a change) the 74HC595 is
+ * clocked with direct BSRR writes instead: 26 stores, about 1 us, instead of 20 HAL
+ * calls. The NOPs in LED_PULSE() keep SCK/RCK high for the 74HC595 minimum pulse
+ * width (~25 ns at 3 V).
  */
 void LED_put(unsigned short led_byte)
 {
@@ -39,13 +50,14 @@ void LED_put(unsigned short led_byte)
 
      for(i=128; i>=1; i>>=1)
      {
-       	  HAL_GPIO_WritePin(P_LED_SER, LED_SER_Pin, (led_byte & i) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+          P_LED_SER->BSRR = (led_byte & i) ? LED_SER_Pin : (uint32_t)LED_SER_Pin << 16;
 
-          HAL_GPIO_WritePin(P_LED_SCK, LED_SCK_Pin, GPIO_PIN_SET);
-          HAL_GPIO_WritePin(P_LED_SCK, LED_SCK_Pin, GPIO_PIN_RESET);
+          P_LED_SCK->BSRR = LED_SCK_Pin;
+          LED_PULSE();
+          P_LED_SCK->BSRR = (uint32_t)LED_SCK_Pin << 16;
      }
 
-     HAL_GPIO_WritePin(P_LED_RCK, LED_RCK_Pin, GPIO_PIN_SET);
-     HAL_GPIO_WritePin(P_LED_RCK, LED_RCK_Pin, GPIO_PIN_RESET);
+     P_LED_RCK->BSRR = LED_RCK_Pin;
+     LED_PULSE();
+     P_LED_RCK->BSRR = (uint32_t)LED_RCK_Pin << 16;
 }
-
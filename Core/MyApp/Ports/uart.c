@@ -39,6 +39,9 @@ char string[100];
 int charcounter = 0;
 extern UART_HandleTypeDef huart2;
 
+// als gezet: alle tekst van UART_puts gaat via deze functie (bv. binaire telemetrie)
+void (*UART_text_hook)(const char *s) = NULL;
+
 void UART_init(void)
 {
 
@@ -55,10 +58,22 @@ void UART_puts(const char *s)
 {
 	volatile unsigned int i;
 
+	if (UART_text_hook)
+	{
+		UART_text_hook(s);
+		return;
+	}
+
 	for (i=0; s[i]; i++)
 		UART_putchar(s[i]);
 }
 
+// Stuurt een blok bytes in 1 keer uit op de UART (bv. een telemetrie-frame)
+void UART_write(const unsigned char *data, unsigned short len)
+{
+	HAL_UART_Transmit(&huart2, (uint8_t *)data, len, 100);
+}
+
 
 void UART_INT_init(void)
 {
@@ -98,9 +113,11 @@ void UART_putnum(unsigned int num, unsigned char deel)
 {
     static unsigned char chars[16] = "0123456789ABCDEF";
     unsigned int rest;
-    signed char c[16];
+    char c[17];
     signed int i=15;
 
+    c[16] = '\0';
+
     // Zet de integer om naar een string
     if(num==0)
     {
@@ -121,12 +138,8 @@ void UART_putnum(unsigned int num, unsigned char deel)
         }
     }
 
-    // Stuur de string uit
-    while(i<15)
-    {
-        i++;
-        UART_putchar(c[i]);
-    }
+    // Stuur de string uit, in 1 keer zodat de UART_text_hook hem ook ziet
+    UART_puts(&c[i+1]);
 }
 
 
@@ -37,6 +37,8 @@ signed int UART_printf(size_t length, const char *pFormat, ...);
 void UART_INT_init(void);
 void UART_putchar(unsigned char c);
 void UART_puts(const char *s);
+void UART_write(const unsigned char *data, unsigned short len);
+extern void (*UART_text_hook)(const char *s);
 void UART_putnum(unsigned int num, unsigned char deel);
 void UART_putint(unsigned int num);
 char UART_get(void);
@@ -44,7 +44,10 @@
 
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN Variables */
-
+static uint32_t ulCycLast;      // DWT->CYCCNT at the previous sample
+static uint64_t ullCycActive;   // core cycles executed, CYCCNT stands still during WFI
+static uint32_t ulTickLast;     // tick count at the previous GetCPULoad()
+static uint64_t ullCycLoadBase; // ullCycActive at the previous GetCPULoad()
 /* USER CODE END Variables */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -55,5 +58,72 @@
 /* Private application code --------------------------------------------------*/
 /* USER CODE BEGIN Application */
 
+/**
+  * @brief Accumulates the executed core cycles. Must run at least once per CYCCNT
+  * wrap (25 s at 168 MHz); the idle task calls it before every sleep.
+  */
+static void SampleCycles(void)
+{
+  uint32_t now;
+
+  if (!(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)) // first call: start the cycle counter
+  {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL  |= DWT_CTRL_CYCCNTENA_Msk;
+    ulCycLast   = 0;
+  }
+
+  now = DWT->CYCCNT;
+  ullCycActive += now - ulCycLast;
+  ulCycLast = now;
+}
+
+/**
+  * @brief Called by the idle task with interrupts disabled, just before WFI.
+  * Stops the 1 kHz HAL timebase, otherwise TIM1 wakes the MCU every ms.
+  */
+void PreSleepProcessing(uint32_t *ulExpectedIdleTime)
+{
+  (void)ulExpectedIdleTime; // 0 would skip the WFI of the port
+  SampleCycles();
+  HAL_SuspendTick();
+}
+
+/**
+  * @brief Called by the idle task after wake-up, restarts the HAL timebase.
+  */
+void PostSleepProcessing(uint32_t *ulExpectedIdleTime)
+{
+  (void)ulExpectedIdleTime;
+  HAL_ResumeTick();
+  SampleCycles();
+}
+
+/**
+  * @brief Returns the MCU load in percent since the previous call, measured as
+  * executed core cycles against elapsed time.
+  * @note With a debugger attached DBGMCU may keep the core clock running in sleep,
+  * the load then reads 100%.
+  */
+uint32_t GetCPULoad(void)
+{
+  uint64_t active, elapsed;
+  uint32_t now;
+
+  taskENTER_CRITICAL();
+  SampleCycles();
+  now = xTaskGetTickCount();
+  active  = ullCycActive - ullCycLoadBase;
+  elapsed = (uint64_t)(now - ulTickLast) * (SystemCoreClock / configTICK_RATE_HZ);
+  ullCycLoadBase = ullCycActive;
+  ulTickLast = now;
+  taskEXIT_CRITICAL();
+
+  if (!elapsed)
+    return 0;
+  return (uint32_t)((active * 100) / elapsed);
+}
+
 /* USER CODE END Application */
 
@@ -23,6 +23,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "main.h"
 #include "cmsis_os.h"
+#include "fatfs.h"
 #include "usb_host.h"
 
 /* Private includes ----------------------------------------------------------*/
@@ -30,10 +31,14 @@
 #include "admin.h"
 #include "NRF24.h"
 #include "NRF24_reg_addresses.h"
+#include "config.h"
+#include "fault.h"
+#include "telemetry.h"
 
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
+typedef StaticTask_t osStaticThreadDef_t;
 /* USER CODE BEGIN PTD */
 
 /* USER CODE END PTD */
@@ -57,9 +62,14 @@ UART_HandleTypeDef huart2;
 
 /* Definitions for defaultTask */
 osThreadId_t defaultTaskHandle;
+uint32_t defaultTaskBuffer[ 128 ];
+osStaticThreadDef_t defaultTaskControlBlock;
 const osThreadAttr_t defaultTask_attributes = {
   .name = "defaultTask",
-  .stack_size = 128 * 4,
+  .cb_mem = &defaultTaskControlBlock,
+  .cb_size = sizeof(defaultTaskControlBlock),
+  .stack_mem = &defaultTaskBuffer[0],
+  .stack_size = sizeof(defaultTaskBuffer),
   .priority = (osPriority_t) osPriorityNormal,
 };
 /* USER CODE BEGIN PV */
@@ -116,14 +126,18 @@ int main(void)
   MX_USART2_UART_Init();
   MX_UART4_Init();
   MX_SPI1_Init();
+  MX_FATFS_Init();
   /* USER CODE BEGIN 2 */
 
   LCD_init();
   KEYS_init();
   KEYS_initISR(1); // set all lines high once
   LED_init();
+  BUZZER_init(); // PC8 to TIM3 PWM
+  tlm_clock_init(); // TIM2 free-running at 1 MHz, the latency clock
 
   DisplayVersion();
+  FAULT_init(); // report a fault from before the last reset
   osDelay(500); // time to read version
 
   /* USER CODE END 2 */
@@ -550,8 +564,8 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 		/// Receive one byte in interrupt mode
 		HAL_UART_Receive_IT(&huart4, &uart4_char, 1);
 
-		/// Zet de byte op de GPS_queue
-		xQueueSendFromISR(hGPS_Queue, &uart4_char, &xHigherPriorityTaskWoken);
+		/// Zet de byte in de NMEA-framer, die hele zinnen op de GPS-messagebuffer zet
+		GPS_rx_byte_ISR(uart4_char, &xHigherPriorityTaskWoken);
 		if (xHigherPriorityTaskWoken != pdFALSE)
 			portYIELD_FROM_ISR(xHigherPriorityTaskWoken); // force context switch
 	}
@@ -574,6 +588,7 @@ void StartDefaultTask(void *argument)
   /* USER CODE BEGIN 5 */
 
 
+  config_load(); // runtime configuration from flash, before any task reads cfg
   CreateHandles();
   CreateTasks();
 
@@ -622,10 +637,7 @@ void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
-  __disable_irq();
-  while (1)
-  {
-  }
+  FAULT_halt("Error_Handler", (uint32_t)__builtin_return_address(0)); // record and reset
   /* USER CODE END Error_Handler_Debug */
 }
 #ifdef USE_FULL_ASSERT
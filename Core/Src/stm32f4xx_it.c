@@ -25,6 +25,7 @@
 /* USER CODE BEGIN Includes */
 #include "admin.h"
 #include "cmsis_os.h"
+#include "keyscan.h"
 
 /* USER CODE END Includes */
 
@@ -86,66 +87,6 @@ void NMI_Handler(void)
   /* USER CODE END NonMaskableInt_IRQn 1 */
 }
 
-/**
-  * @brief This function handles Hard fault interrupt.
-  */
-void HardFault_Handler(void)
-{
-  /* USER CODE BEGIN HardFault_IRQn 0 */
-
-  /* USER CODE END HardFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_HardFault_IRQn 0 */
-    /* USER CODE END W1_HardFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Memory management fault.
-  */
-void MemManage_Handler(void)
-{
-  /* USER CODE BEGIN MemoryManagement_IRQn 0 */
-
-  /* USER CODE END MemoryManagement_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_MemoryManagement_IRQn 0 */
-    /* USER CODE END W1_MemoryManagement_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Pre-fetch fault, memory access fault.
-  */
-void BusFault_Handler(void)
-{
-  /* USER CODE BEGIN BusFault_IRQn 0 */
-
-  /* USER CODE END BusFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_BusFault_IRQn 0 */
-    /* USER CODE END W1_BusFault_IRQn 0 */
-  }
-}
-
-/**
-  * @brief This function handles Undefined instruction or illegal state.
-  */
-void UsageFault_Handler(void)
-{
-  /* USER CODE BEGIN UsageFault_IRQn 0 */
-
-  /* USER CODE END UsageFault_IRQn 0 */
-  while (1)
-  {
-    /* USER CODE BEGIN W1_UsageFault_IRQn 0 */
-    /* USER CODE END W1_UsageFault_IRQn 0 */
-  }
-}
-
 /**
   * @brief This function handles Debug monitor.
   */
@@ -175,24 +116,12 @@ void EXTI0_IRQHandler(void)
   /** Deze interrupthandler wordt automatisch gegenereerd nadat de interrupt aangezet is
    * op de processor via .ioc. De inhoud van de handler moet je natuurlijk zelf nog coderen.
    * Hier vangt de handler de toetsen van het ARM-keyboard op. <br>
-   * Nadat een toets gedrukt is, wordt bepaald WELKE toets dat was met KEYS_read().
-   * Vervolgens wordt de key meegestuurd met een FreeRTOS event, die opgevangen wordt
-   * door de task ARM_keys_IRQ(). Daarna wordt, indien nodig, een context switch
-   * afgedwongen door portYIELD_FROM_ISR().
+   * De handler leest het keyboard niet zelf: KEYSCAN_irq() zet deze interrupt uit en
+   * start de keypad-scanner (keyscan.c), die met debounce bepaalt WELKE toets het is.
+   * Als alle toetsen weer los zijn zet de scanner de interrupt weer aan.
    *
    */
-  BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-  int        key;
-
-  HAL_GPIO_EXTI_IRQHandler(Key_int_Pin);
-
-  key = KEYS_read(); // determine which key is pressed...
-  xEventGroupSetBitsFromISR (hKEY_Event, key, &xHigherPriorityTaskWoken);
-
-  // KEYS_initISR(0); // set all lines lo if you want repeating keys
-  KEYS_initISR(1);    // set all lines hi for reading all 16 keys
-  if (xHigherPriorityTaskWoken != pdFALSE)
-	  portYIELD_FROM_ISR(xHigherPriorityTaskWoken); // force context switch
+  KEYSCAN_irq();
 
   /* USER CODE END EXTI0_IRQn 0 */
   HAL_GPIO_EXTI_IRQHandler(Key_int_Pin);
@@ -0,0 +1,36 @@
+/*
+ * fatfs.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * FatFs application glue, see fatfs.h.
+ */
+
+#include "fatfs.h"
+
+uint8_t retUSBH;
+char    USBHPath[4];
+FATFS   USBHFatFS;
+FIL     USBHFile;
+
+
+/**
+ * @brief Links the USB Disk driver; called from main() before the scheduler starts.
+ */
+void MX_FATFS_Init(void)
+{
+	retUSBH = FATFS_LinkDriver(&USBH_Driver, USBHPath);
+}
+
+
+/**
+ * @brief Time stamp of new and changed files. The board has no RTC and the GNSS fix
+ * carries no date (GPS_FIX.time is ms since midnight), so every file gets the fixed
+ * date of ffconf.h; the recording order is in the file number and LOG_BLOCK_HDR.seq.
+ * @return FAT date/time: bit 31:25 year-1980, 24:21 month, 20:16 day, 15:0 time
+ */
+DWORD get_fattime(void)
+{
+	return ((DWORD)(_NORTC_YEAR - 1980) << 25) | ((DWORD)_NORTC_MON << 21) | ((DWORD)_NORTC_MDAY << 16);
+}
@@ -0,0 +1,25 @@
+/*
+ * fatfs.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * FatFs application glue, as CubeMX generates it for FATFS with a USB Disk: the USB
+ * stick is drive USBHPath, with one file system and one file object.
+ */
+
+#ifndef __fatfs_H
+#define __fatfs_H
+
+#include "ff.h"
+#include "ff_gen_drv.h"
+#include "usbh_diskio.h"
+
+extern uint8_t retUSBH;    // return value of FATFS_LinkDriver()
+extern char    USBHPath[4];
+extern FATFS   USBHFatFS;
+extern FIL     USBHFile;
+
+void MX_FATFS_Init(void);
+
+#endif /* __fatfs_H */
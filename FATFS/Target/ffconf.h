@@ -0,0 +1,31 @@
+/*
+ * ffconf.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Configuration of the FatFs module (Middlewares/Third_Party/FatFs/src/ff.c), in the
+ * place CubeMX keeps it. One volume: the USB stick of the logger.
+ */
+
+#ifndef _FFCONF
+#define _FFCONF 1
+
+#include "main.h"
+
+#define _VOLUMES        1     // logical drives: USBHPath "0:/"
+#define _MAX_SS         512   // sector size; a stick with larger sectors is not mounted
+#define _MIN_SS         512
+#define _FS_READONLY    0
+#define _USE_WRITE      1     // disk_write() in the diskio drivers
+#define _USE_IOCTL      1     // disk_ioctl() in the diskio drivers
+
+/// No RTOS lock (_FS_REENTRANT): every FatFs call comes from Logger_task
+#define _FS_REENTRANT   0
+
+/// Timestamp of new files without a clock (get_fattime() in fatfs.c)
+#define _NORTC_YEAR     2026
+#define _NORTC_MON      1
+#define _NORTC_MDAY     1
+
+#endif /* _FFCONF */
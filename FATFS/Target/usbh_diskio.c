@@ -0,0 +1,103 @@
+/*
+ * usbh_diskio.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * FatFs diskio driver of the USB stick, see usbh_diskio.h: sectors are the blocks of
+ * the MSC LUN, read and written by USBH_MSC_Read/Write in the calling task. The OTG FS
+ * core runs without DMA, so any buffer alignment will do. A failed transfer is
+ * translated from the sense data: no medium, write protected or an error.
+ */
+
+#include <string.h>
+#include "ff_gen_drv.h"
+#include "usbh_diskio.h"
+#include "usb_host.h"
+#include "usbh_msc.h"
+
+extern USBH_HandleTypeDef hUsbHostFS;
+
+
+static DSTATUS USBH_initialize(BYTE lun)
+{
+	return RES_OK; // the MSC class initialised the LUN before HOST_USER_CLASS_ACTIVE
+}
+
+
+static DSTATUS USBH_status(BYTE lun)
+{
+	return (USBH_MSC_UnitIsReady(&hUsbHostFS, lun) ? RES_OK : STA_NOINIT);
+}
+
+
+/**
+ * @brief Why a transfer failed, from the REQUEST SENSE data.
+ */
+static DRESULT USBH_error(BYTE lun)
+{
+	MSC_LUNTypeDef info;
+
+	if (USBH_MSC_GetLUNInfo(&hUsbHostFS, lun, &info) != USBH_OK)
+		return RES_NOTRDY;
+	switch (info.sense.asc)
+	{
+	case SCSI_ASC_MEDIUM_NOT_PRESENT:
+		return RES_NOTRDY;
+	case SCSI_ASC_WRITE_PROTECTED:
+		return RES_WRPRT;
+	default:
+		return RES_ERROR;
+	}
+}
+
+
+static DRESULT USBH_read(BYTE lun, BYTE *buff, DWORD sector, UINT count)
+{
+	if (USBH_MSC_Read(&hUsbHostFS, lun, sector, buff, count) == USBH_OK)
+		return RES_OK;
+	return USBH_error(lun);
+}
+
+
+static DRESULT USBH_write(BYTE lun, const BYTE *buff, DWORD sector, UINT count)
+{
+	if (USBH_MSC_Write(&hUsbHostFS, lun, sector, (BYTE *)buff, count) == USBH_OK)
+		return RES_OK;
+	return USBH_error(lun);
+}
+
+
+static DRESULT USBH_ioctl(BYTE lun, BYTE cmd, void *buff)
+{
+	MSC_LUNTypeDef info;
+
+	if (cmd == CTRL_SYNC)
+		return RES_OK; // every write has its CSW: the stick has the data
+	if (USBH_MSC_GetLUNInfo(&hUsbHostFS, lun, &info) != USBH_OK)
+		return RES_ERROR;
+	switch (cmd)
+	{
+	case GET_SECTOR_COUNT:
+		*(DWORD *)buff = info.capacity.block_nbr;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = info.capacity.block_size;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = info.capacity.block_size / _MAX_SS;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+
+const Diskio_drvTypeDef USBH_Driver =
+{
+	USBH_initialize,
+	USBH_status,
+	USBH_read,
+	USBH_write,
+	USBH_ioctl,
+};
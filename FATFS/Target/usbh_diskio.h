@@ -0,0 +1,17 @@
+/*
+ * usbh_diskio.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * FatFs diskio driver of a USB stick on the USB host port (MSC class).
+ */
+
+#ifndef __USBH_DISKIO_H
+#define __USBH_DISKIO_H
+
+#include "ff_gen_drv.h"
+
+extern const Diskio_drvTypeDef USBH_Driver;
+
+#endif /* __USBH_DISKIO_H */
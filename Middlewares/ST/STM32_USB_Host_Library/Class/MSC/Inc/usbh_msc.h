@@ -0,0 +1,91 @@
+/*
+ * usbh_msc.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * USB host Mass Storage class, Bulk-Only Transport with the SCSI transparent command
+ * set: the part of the ST MSC class API that the FatFs USB Disk driver
+ * (FATFS/Target/usbh_diskio.c) uses, with the same names. Compact on purpose: one LUN,
+ * no BOT reset recovery (a stick that loses its CSW is replugged). Generating the
+ * project with the MSC class in CubeMX puts the complete ST class in its place.
+ *
+ * The class initialises the LUN from the USB host thread and then reports
+ * HOST_USER_CLASS_ACTIVE; USBH_MSC_Read/Write run the transfer in the caller's task.
+ */
+
+#ifndef __USBH_MSC_H
+#define __USBH_MSC_H
+
+#include "usbh_core.h"
+#include "usbh_msc_bot.h"
+#include "usbh_msc_scsi.h"
+
+#define USB_MSC_CLASS            0x08U
+#define MSC_TRANSPARENT          0x06U  // subclass: SCSI transparent command set
+#define MSC_BOT                  0x50U  // protocol: Bulk-Only Transport
+
+#define MAX_SUPPORTED_LUN        1U
+/// a unit that stays NOT READY this long after plug-in is given up, ms
+#define MSC_READY_TIMEOUT_MS     10000U
+/// a read or write that takes longer than this per sector fails, ms
+#define MSC_RW_TIMEOUT_MS        10000U
+
+typedef enum
+{
+	MSC_INIT = 0,
+	MSC_IDLE,
+	MSC_TEST_UNIT_READY,
+	MSC_READ_CAPACITY10,
+	MSC_READ_INQUIRY,
+	MSC_REQUEST_SENSE,
+	MSC_READ,
+	MSC_WRITE,
+	MSC_UNRECOVERED_ERROR
+} MSC_StateTypeDef;
+
+typedef enum
+{
+	MSC_OK = 0,
+	MSC_NOT_READY,
+	MSC_ERROR
+} MSC_ErrorTypeDef;
+
+typedef struct
+{
+	MSC_StateTypeDef           state;
+	MSC_ErrorTypeDef           error;
+	SCSI_CapacityTypeDef       capacity;
+	SCSI_SenseTypeDef          sense;
+	SCSI_StdInquiryDataTypeDef inquiry;
+} MSC_LUNTypeDef;
+
+typedef struct
+{
+	uint8_t           max_lun;
+	uint8_t           lun_reply;   // GET MAX LUN data stage
+	uint8_t           InPipe;
+	uint8_t           OutPipe;
+	uint8_t           OutEp;
+	uint8_t           InEp;
+	uint16_t          OutEpSize;
+	uint16_t          InEpSize;
+	uint8_t           interface;
+	MSC_StateTypeDef  state;
+	BOT_HandleTypeDef hbot;
+	MSC_LUNTypeDef    unit[MAX_SUPPORTED_LUN];
+	uint16_t          current_lun;
+	uint32_t          timer;       // phost->Timer at the start of the LUN initialisation
+} MSC_HandleTypeDef;
+
+extern USBH_ClassTypeDef USBH_msc;
+#define USBH_MSC_CLASS    &USBH_msc
+
+uint8_t            USBH_MSC_IsReady(USBH_HandleTypeDef *phost);
+uint8_t            USBH_MSC_GetMaxLUN(USBH_HandleTypeDef *phost);
+uint8_t            USBH_MSC_UnitIsReady(USBH_HandleTypeDef *phost, uint8_t lun);
+USBH_StatusTypeDef USBH_MSC_GetLUNInfo(USBH_HandleTypeDef *phost, uint8_t lun, MSC_LUNTypeDef *info);
+USBH_StatusTypeDef USBH_MSC_Read(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length);
+USBH_StatusTypeDef USBH_MSC_Write(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length);
+
+#endif /* __USBH_MSC_H */
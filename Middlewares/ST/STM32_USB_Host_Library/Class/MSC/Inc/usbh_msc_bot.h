@@ -0,0 +1,95 @@
+/*
+ * usbh_msc_bot.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Bulk-Only Transport of the USB host MSC class (usbh_msc_bot.c): one command block
+ * wrapper (CBW), its data stage in packets of the endpoint size, and the command status
+ * wrapper (CSW). Same names as the ST MSC class, see usbh_msc.h.
+ */
+
+#ifndef __USBH_MSC_BOT_H
+#define __USBH_MSC_BOT_H
+
+#include "usbh_core.h"
+
+#define BOT_CBW_SIGNATURE        0x43425355U
+#define BOT_CSW_SIGNATURE        0x53425355U
+#define BOT_CBW_LENGTH           31U
+#define BOT_CSW_LENGTH           13U
+#define BOT_CBW_CB_LENGTH        16U
+
+/// class requests (BOT 3.1, 3.2)
+#define USB_REQ_BOT_RESET        0xFFU
+#define USB_REQ_GET_MAX_LUN      0xFEU
+
+typedef enum
+{
+	BOT_CMD_IDLE = 0,
+	BOT_CMD_SEND,              // a SCSI command fills the CBW
+	BOT_CMD_WAIT               // BOT_Process runs it
+} BOT_CMDStateTypeDef;
+
+typedef enum
+{
+	BOT_SEND_CBW = 1,
+	BOT_SEND_CBW_WAIT,
+	BOT_DATA_IN,
+	BOT_DATA_IN_WAIT,
+	BOT_DATA_OUT,
+	BOT_DATA_OUT_WAIT,
+	BOT_RECEIVE_CSW,
+	BOT_RECEIVE_CSW_WAIT,
+	BOT_ERROR_IN,              // clear the IN halt, then read the CSW (BOT 6.7.2)
+	BOT_ERROR_OUT,             // clear the OUT halt, then read the CSW (BOT 6.7.3)
+	BOT_UNRECOVERED_ERROR      // no valid CSW: the stick needs a replug
+} BOT_StateTypeDef;
+
+typedef union
+{
+	struct
+	{
+		uint32_t Signature;
+		uint32_t Tag;
+		uint32_t DataTransferLength;
+		uint8_t  Flags;            // USB_EP_DIR_IN for a data stage to the host
+		uint8_t  LUN;
+		uint8_t  CBLength;
+		uint8_t  CB[BOT_CBW_CB_LENGTH];
+	} field;
+	uint8_t data[BOT_CBW_LENGTH + 1];
+} BOT_CBWTypeDef;
+
+typedef union
+{
+	struct
+	{
+		uint32_t Signature;
+		uint32_t Tag;
+		uint32_t DataResidue;
+		uint8_t  Status;           // BOT_CSW_CMD_PASSED, _FAILED, _PHASE_ERROR
+	} field;
+	uint8_t data[16];
+} BOT_CSWTypeDef;
+
+#define BOT_CSW_CMD_PASSED       0x00U
+#define BOT_CSW_CMD_FAILED       0x01U
+#define BOT_CSW_PHASE_ERROR      0x02U
+
+typedef struct
+{
+	uint32_t            data[16];  // data stage of the short commands (INQUIRY, READ CAPACITY, REQUEST SENSE)
+	BOT_StateTypeDef    state;
+	BOT_CMDStateTypeDef cmd_state;
+	BOT_CBWTypeDef      cbw;
+	BOT_CSWTypeDef      csw;
+	uint8_t            *pbuf;      // next packet of the data stage
+	uint32_t            remaining; // bytes of the data stage still to transfer
+} BOT_HandleTypeDef;
+
+USBH_StatusTypeDef USBH_MSC_BOT_REQ_GetMaxLUN(USBH_HandleTypeDef *phost, uint8_t *Maxlun);
+USBH_StatusTypeDef USBH_MSC_BOT_Init(USBH_HandleTypeDef *phost);
+USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun);
+
+#endif /* __USBH_MSC_BOT_H */
@@ -0,0 +1,67 @@
+/*
+ * usbh_msc_scsi.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * SCSI transparent command set over BOT (usbh_msc_scsi.c): the commands a stick needs
+ * to be mounted and written. Each call returns USBH_BUSY until the command is done.
+ */
+
+#ifndef __USBH_MSC_SCSI_H
+#define __USBH_MSC_SCSI_H
+
+#include "usbh_core.h"
+
+#define SCSI_TEST_UNIT_READY     0x00U
+#define SCSI_REQUEST_SENSE       0x03U
+#define SCSI_INQUIRY             0x12U
+#define SCSI_READ_CAPACITY10     0x25U
+#define SCSI_READ10              0x28U
+#define SCSI_WRITE10             0x2AU
+
+#define SCSI_SENSE_KEY_NO_SENSE          0x00U
+#define SCSI_SENSE_KEY_NOT_READY         0x02U
+#define SCSI_SENSE_KEY_MEDIUM_ERROR      0x03U
+#define SCSI_SENSE_KEY_ILLEGAL_REQUEST   0x05U
+#define SCSI_SENSE_KEY_UNIT_ATTENTION    0x06U
+#define SCSI_SENSE_KEY_DATA_PROTECT      0x07U
+
+#define SCSI_ASC_WRITE_PROTECTED         0x27U
+#define SCSI_ASC_MEDIUM_NOT_PRESENT      0x3AU
+
+#define DATA_LEN_INQUIRY         36U
+#define DATA_LEN_READ_CAPACITY10 8U
+#define DATA_LEN_REQUEST_SENSE   18U
+
+typedef struct
+{
+	uint32_t block_nbr;
+	uint16_t block_size;
+} SCSI_CapacityTypeDef;
+
+typedef struct
+{
+	uint8_t key;
+	uint8_t asc;
+	uint8_t ascq;
+} SCSI_SenseTypeDef;
+
+typedef struct
+{
+	uint8_t PeripheralQualifier;
+	uint8_t DeviceType;
+	uint8_t RemovableMedia;
+	char    vendor_id[9];
+	char    product_id[17];
+	char    revision_id[5];
+} SCSI_StdInquiryDataTypeDef;
+
+USBH_StatusTypeDef USBH_MSC_SCSI_TestUnitReady(USBH_HandleTypeDef *phost, uint8_t lun);
+USBH_StatusTypeDef USBH_MSC_SCSI_ReadCapacity(USBH_HandleTypeDef *phost, uint8_t lun, SCSI_CapacityTypeDef *capacity);
+USBH_StatusTypeDef USBH_MSC_SCSI_Inquiry(USBH_HandleTypeDef *phost, uint8_t lun, SCSI_StdInquiryDataTypeDef *inquiry);
+USBH_StatusTypeDef USBH_MSC_SCSI_RequestSense(USBH_HandleTypeDef *phost, uint8_t lun, SCSI_SenseTypeDef *sense_data);
+USBH_StatusTypeDef USBH_MSC_SCSI_Write(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length);
+USBH_StatusTypeDef USBH_MSC_SCSI_Read(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length);
+
+#endif /* __USBH_MSC_SCSI_H */
@@ -0,0 +1,386 @@
+/*
+ * usbh_msc.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * USB host Mass Storage class, see usbh_msc.h.
+ *
+ * After GET MAX LUN the USB host thread initialises the LUN (INQUIRY, TEST UNIT READY
+ * until the stick is ready, READ CAPACITY) and reports HOST_USER_CLASS_ACTIVE.
+ * USBH_MSC_Read/Write then run READ(10)/WRITE(10) to completion in the calling task;
+ * the thread only wakes on their URB events. The handle is static, not USBH_malloc'ed
+ * like the CDC class does: a transfer in another task may still look at it when the
+ * thread handles the disconnection, so only the pipes go with DeInit.
+ */
+
+#include <string.h>
+#include "usbh_msc.h"
+
+static USBH_StatusTypeDef USBH_MSC_InterfaceInit(USBH_HandleTypeDef *phost);
+static USBH_StatusTypeDef USBH_MSC_InterfaceDeInit(USBH_HandleTypeDef *phost);
+static USBH_StatusTypeDef USBH_MSC_ClassRequest(USBH_HandleTypeDef *phost);
+static USBH_StatusTypeDef USBH_MSC_Process(USBH_HandleTypeDef *phost);
+static USBH_StatusTypeDef USBH_MSC_SOFProcess(USBH_HandleTypeDef *phost);
+
+static MSC_HandleTypeDef MSC_handle;
+
+USBH_ClassTypeDef USBH_msc =
+{
+	"MSC",
+	USB_MSC_CLASS,
+	USBH_MSC_InterfaceInit,
+	USBH_MSC_InterfaceDeInit,
+	USBH_MSC_ClassRequest,
+	USBH_MSC_Process,
+	USBH_MSC_SOFProcess,
+	&MSC_handle,
+};
+
+
+/**
+ * @brief TRUE while a stick is enumerated as MSC device.
+ */
+static int MSC_active(USBH_HandleTypeDef *phost)
+{
+	return (phost->device.is_connected != 0U && phost->gState == HOST_CLASS && phost->pActiveClass == &USBH_msc);
+}
+
+
+static USBH_StatusTypeDef USBH_MSC_InterfaceInit(USBH_HandleTypeDef *phost)
+{
+	MSC_HandleTypeDef      *MSC_Handle = &MSC_handle;
+	USBH_InterfaceDescTypeDef *itf;
+	uint8_t                 interface, i;
+
+	interface = USBH_FindInterface(phost, phost->pActiveClass->ClassCode, MSC_TRANSPARENT, MSC_BOT);
+	if (interface == 0xFFU || interface >= USBH_MAX_NUM_INTERFACES)
+	{
+		USBH_DbgLog("Cannot Find the interface for %s class.", phost->pActiveClass->Name);
+		return USBH_FAIL;
+	}
+	if (USBH_SelectInterface(phost, interface) != USBH_OK)
+		return USBH_FAIL;
+
+	memset(MSC_Handle, 0, sizeof(*MSC_Handle));
+	phost->pActiveClass->pData = MSC_Handle;
+	itf = &phost->device.CfgDesc.Itf_Desc[interface];
+	MSC_Handle->interface = itf->bInterfaceNumber;
+
+	for (i = 0U; i < 2U; i++)
+	{
+		if (itf->Ep_Desc[i].bEndpointAddress & USB_EP_DIR_IN)
+		{
+			MSC_Handle->InEp     = itf->Ep_Desc[i].bEndpointAddress;
+			MSC_Handle->InEpSize = itf->Ep_Desc[i].wMaxPacketSize;
+		}
+		else
+		{
+			MSC_Handle->OutEp     = itf->Ep_Desc[i].bEndpointAddress;
+			MSC_Handle->OutEpSize = itf->Ep_Desc[i].wMaxPacketSize;
+		}
+	}
+
+	MSC_Handle->state = MSC_INIT;
+	(void)USBH_MSC_BOT_Init(phost);
+
+	MSC_Handle->OutPipe = USBH_AllocPipe(phost, MSC_Handle->OutEp);
+	MSC_Handle->InPipe  = USBH_AllocPipe(phost, MSC_Handle->InEp);
+	(void)USBH_OpenPipe(phost, MSC_Handle->OutPipe, MSC_Handle->OutEp, phost->device.address,
+	                    phost->device.speed, USB_EP_TYPE_BULK, MSC_Handle->OutEpSize);
+	(void)USBH_OpenPipe(phost, MSC_Handle->InPipe, MSC_Handle->InEp, phost->device.address,
+	                    phost->device.speed, USB_EP_TYPE_BULK, MSC_Handle->InEpSize);
+	(void)USBH_LL_SetToggle(phost, MSC_Handle->InPipe, 0U);
+	(void)USBH_LL_SetToggle(phost, MSC_Handle->OutPipe, 0U);
+	return USBH_OK;
+}
+
+
+static USBH_StatusTypeDef USBH_MSC_InterfaceDeInit(USBH_HandleTypeDef *phost)
+{
+	MSC_HandleTypeDef *MSC_Handle = &MSC_handle;
+
+	if (MSC_Handle->OutPipe != 0U)
+	{
+		(void)USBH_ClosePipe(phost, MSC_Handle->OutPipe);
+		(void)USBH_FreePipe(phost, MSC_Handle->OutPipe);
+		MSC_Handle->OutPipe = 0U;
+	}
+	if (MSC_Handle->InPipe != 0U)
+	{
+		(void)USBH_ClosePipe(phost, MSC_Handle->InPipe);
+		(void)USBH_FreePipe(phost, MSC_Handle->InPipe);
+		MSC_Handle->InPipe = 0U;
+	}
+	MSC_Handle->state = MSC_INIT;
+	return USBH_OK;
+}
+
+
+/**
+ * @brief GET MAX LUN; a STALL means one LUN (BOT 3.2).
+ */
+static USBH_StatusTypeDef USBH_MSC_ClassRequest(USBH_HandleTypeDef *phost)
+{
+	MSC_HandleTypeDef *MSC_Handle = &MSC_handle;
+	USBH_StatusTypeDef status;
+	uint8_t            i;
+
+	status = USBH_MSC_BOT_REQ_GetMaxLUN(phost, &MSC_Handle->lun_reply);
+	if (status == USBH_NOT_SUPPORTED)
+	{
+		MSC_Handle->lun_reply = 0U;
+		status = USBH_OK;
+	}
+	if (status == USBH_OK)
+	{
+		MSC_Handle->max_lun = (MSC_Handle->lun_reply + 1U > MAX_SUPPORTED_LUN ? MAX_SUPPORTED_LUN : MSC_Handle->lun_reply + 1U);
+		for (i = 0U; i < MAX_SUPPORTED_LUN; i++)
+		{
+			MSC_Handle->unit[i].state = MSC_INIT;
+			MSC_Handle->unit[i].error = MSC_NOT_READY;
+		}
+	}
+	return status;
+}
+
+
+/**
+ * @brief Next LUN state after a SCSI command: next if it passed, REQUEST SENSE if it
+ * failed, MSC_UNRECOVERED_ERROR without a valid CSW.
+ */
+static void MSC_next(MSC_LUNTypeDef *unit, USBH_StatusTypeDef scsi, MSC_StateTypeDef next)
+{
+	if (scsi == USBH_OK)
+		unit->state = next;
+	else if (scsi == USBH_FAIL)
+		unit->state = MSC_REQUEST_SENSE;
+	else if (scsi != USBH_BUSY)
+	{
+		unit->state = MSC_UNRECOVERED_ERROR;
+		unit->error = MSC_ERROR;
+	}
+}
+
+
+/**
+ * @brief LUN initialisation, in the USB host thread. Once every LUN is done the class
+ * is MSC_IDLE and transfers belong to USBH_MSC_Read/Write.
+ */
+static USBH_StatusTypeDef USBH_MSC_Process(USBH_HandleTypeDef *phost)
+{
+	MSC_HandleTypeDef *MSC_Handle = &MSC_handle;
+	MSC_LUNTypeDef    *unit;
+	USBH_StatusTypeDef scsi;
+	uint8_t            lun = (uint8_t)MSC_Handle->current_lun;
+
+	if (MSC_Handle->state != MSC_INIT)
+		return USBH_OK;
+
+	if (lun >= MSC_Handle->max_lun)
+	{
+		MSC_Handle->current_lun = 0U;
+		MSC_Handle->state       = MSC_IDLE;
+		phost->pUser(phost, HOST_USER_CLASS_ACTIVE);
+		return USBH_OK;
+	}
+
+	unit = &MSC_Handle->unit[lun];
+	switch (unit->state)
+	{
+	case MSC_INIT:
+		MSC_Handle->timer = phost->Timer;
+		unit->state = MSC_READ_INQUIRY;
+		break;
+
+	case MSC_READ_INQUIRY:
+		scsi = USBH_MSC_SCSI_Inquiry(phost, lun, &unit->inquiry);
+		MSC_next(unit, scsi, MSC_TEST_UNIT_READY);
+		break;
+
+	case MSC_TEST_UNIT_READY:
+		scsi = USBH_MSC_SCSI_TestUnitReady(phost, lun);
+		MSC_next(unit, scsi, MSC_READ_CAPACITY10);
+		break;
+
+	case MSC_READ_CAPACITY10:
+		scsi = USBH_MSC_SCSI_ReadCapacity(phost, lun, &unit->capacity);
+		MSC_next(unit, scsi, MSC_IDLE);
+		if (unit->state == MSC_IDLE)
+		{
+			unit->error = MSC_OK;
+			MSC_Handle->current_lun++;
+		}
+		break;
+
+	case MSC_REQUEST_SENSE:
+		scsi = USBH_MSC_SCSI_RequestSense(phost, lun, &unit->sense);
+		if (scsi == USBH_OK)
+		{
+			// a stick reports NOT READY or UNIT ATTENTION for a while after plug-in
+			if ((unit->sense.key == SCSI_SENSE_KEY_NOT_READY || unit->sense.key == SCSI_SENSE_KEY_UNIT_ATTENTION) &&
+			    phost->Timer - MSC_Handle->timer < MSC_READY_TIMEOUT_MS)
+				unit->state = MSC_TEST_UNIT_READY;
+			else
+			{
+				unit->state = MSC_IDLE;
+				unit->error = MSC_ERROR;
+				MSC_Handle->current_lun++;
+			}
+		}
+		else if (scsi != USBH_BUSY)
+		{
+			unit->state = MSC_UNRECOVERED_ERROR;
+			unit->error = MSC_ERROR;
+		}
+		break;
+
+	case MSC_UNRECOVERED_ERROR:
+	default:
+		MSC_Handle->current_lun++;
+		break;
+	}
+
+#if (USBH_USE_OS == 1U)
+	switch (MSC_Handle->hbot.state)
+	{
+	case BOT_SEND_CBW_WAIT:
+	case BOT_DATA_IN_WAIT:
+	case BOT_DATA_OUT_WAIT:
+	case BOT_RECEIVE_CSW_WAIT:
+		break; // the URB change wakes the thread
+	default:
+		USBH_OS_PutMessage(phost, USBH_CLASS_EVENT, 0U, 0U);
+		break;
+	}
+#endif
+	return USBH_OK;
+}
+
+
+static USBH_StatusTypeDef USBH_MSC_SOFProcess(USBH_HandleTypeDef *phost)
+{
+	return USBH_OK;
+}
+
+
+/**
+ * @brief One step of a read or write of the caller's task; a failed command is
+ * followed by REQUEST SENSE, so USBH_MSC_GetLUNInfo() tells why.
+ */
+static USBH_StatusTypeDef MSC_RdWrProcess(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	MSC_LUNTypeDef    *unit = &MSC_handle.unit[lun];
+	USBH_StatusTypeDef scsi;
+
+	switch (unit->state)
+	{
+	case MSC_READ:
+	case MSC_WRITE:
+		if (unit->state == MSC_READ)
+			scsi = USBH_MSC_SCSI_Read(phost, lun, address, pbuf, length);
+		else
+			scsi = USBH_MSC_SCSI_Write(phost, lun, address, pbuf, length);
+		MSC_next(unit, scsi, MSC_IDLE);
+		if (scsi == USBH_OK)
+			return USBH_OK;
+		break;
+
+	case MSC_REQUEST_SENSE:
+		scsi = USBH_MSC_SCSI_RequestSense(phost, lun, &unit->sense);
+		if (scsi == USBH_OK)
+		{
+			unit->state = MSC_IDLE;
+			unit->error = MSC_ERROR;
+			return USBH_FAIL;
+		}
+		if (scsi != USBH_BUSY)
+		{
+			unit->state = MSC_UNRECOVERED_ERROR;
+			unit->error = MSC_ERROR;
+		}
+		break;
+
+	default:
+		break;
+	}
+	return (unit->state == MSC_UNRECOVERED_ERROR ? USBH_FAIL : USBH_BUSY);
+}
+
+
+/**
+ * @brief Runs a READ(10) or WRITE(10) to completion. While the stick programs its
+ * flash (waiting for the CSW) the task sleeps a tick per poll, so lower priority tasks
+ * keep running; the data packets themselves are polled.
+ */
+static USBH_StatusTypeDef MSC_RdWr(USBH_HandleTypeDef *phost, uint8_t lun, MSC_StateTypeDef op, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	MSC_LUNTypeDef    *unit = &MSC_handle.unit[lun];
+	USBH_StatusTypeDef status;
+	uint32_t           t0;
+
+	if (!MSC_active(phost) || MSC_handle.state != MSC_IDLE || lun >= MSC_handle.max_lun || unit->state != MSC_IDLE)
+		return USBH_FAIL;
+
+	unit->state = op;
+	t0 = phost->Timer;
+	while ((status = MSC_RdWrProcess(phost, lun, address, pbuf, length)) == USBH_BUSY)
+	{
+		if (!MSC_active(phost) || phost->Timer - t0 > MSC_RW_TIMEOUT_MS * length)
+		{
+			unit->state = MSC_UNRECOVERED_ERROR; // BOT is mid-command: no further transfers
+			unit->error = MSC_ERROR;
+			return USBH_FAIL;
+		}
+#if (USBH_USE_OS == 1U)
+		if (MSC_handle.hbot.state == BOT_RECEIVE_CSW_WAIT)
+			osDelay(1);
+#endif
+	}
+	return status;
+}
+
+
+uint8_t USBH_MSC_IsReady(USBH_HandleTypeDef *phost)
+{
+	return (MSC_active(phost) && MSC_handle.state == MSC_IDLE);
+}
+
+
+uint8_t USBH_MSC_GetMaxLUN(USBH_HandleTypeDef *phost)
+{
+	return (USBH_MSC_IsReady(phost) ? MSC_handle.max_lun : 0xFFU);
+}
+
+
+uint8_t USBH_MSC_UnitIsReady(USBH_HandleTypeDef *phost, uint8_t lun)
+{
+	return (USBH_MSC_IsReady(phost) && lun < MSC_handle.max_lun && MSC_handle.unit[lun].error == MSC_OK);
+}
+
+
+USBH_StatusTypeDef USBH_MSC_GetLUNInfo(USBH_HandleTypeDef *phost, uint8_t lun, MSC_LUNTypeDef *info)
+{
+	if (!MSC_active(phost) || lun >= MAX_SUPPORTED_LUN)
+		return USBH_FAIL;
+	*info = MSC_handle.unit[lun];
+	return USBH_OK;
+}
+
+
+/**
+ * @brief Reads length blocks from block address into pbuf, in the caller's task.
+ */
+USBH_StatusTypeDef USBH_MSC_Read(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	return MSC_RdWr(phost, lun, MSC_READ, address, pbuf, length);
+}
+
+
+/**
+ * @brief Writes length blocks from pbuf to block address, in the caller's task.
+ */
+USBH_StatusTypeDef USBH_MSC_Write(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	return MSC_RdWr(phost, lun, MSC_WRITE, address, pbuf, length);
+}
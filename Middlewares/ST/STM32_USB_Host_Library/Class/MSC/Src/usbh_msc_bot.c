@@ -0,0 +1,233 @@
+/*
+ * usbh_msc_bot.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Bulk-Only Transport, see usbh_msc_bot.h. USBH_MSC_BOT_Process() moves one command
+ * through CBW -> data -> CSW, one packet per URB as the ST class does: the HCD of the
+ * F4 in slave mode refills the TX FIFO one packet at a time. A STALL in the data stage
+ * is cleared and the CSW still read (BOT 6.7); an invalid CSW ends in
+ * BOT_UNRECOVERED_ERROR. Every state change posts USBH_CLASS_EVENT, so the USB host
+ * thread keeps running the class while it initialises the LUN.
+ */
+
+#include "usbh_msc.h"
+
+
+static void BOT_event(USBH_HandleTypeDef *phost)
+{
+#if (USBH_USE_OS == 1U)
+	USBH_OS_PutMessage(phost, USBH_CLASS_EVENT, 0U, 0U);
+#endif
+}
+
+
+/**
+ * @brief GET MAX LUN class request; call until it is no longer USBH_BUSY.
+ * @param Maxlun Receives the highest LUN number
+ */
+USBH_StatusTypeDef USBH_MSC_BOT_REQ_GetMaxLUN(USBH_HandleTypeDef *phost, uint8_t *Maxlun)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+
+	if (phost->RequestState == CMD_SEND)
+	{
+		phost->Control.setup.b.bmRequestType = USB_D2H | USB_REQ_TYPE_CLASS | USB_REQ_RECIPIENT_INTERFACE;
+		phost->Control.setup.b.bRequest      = USB_REQ_GET_MAX_LUN;
+		phost->Control.setup.b.wValue.w      = 0U;
+		phost->Control.setup.b.wIndex.w      = MSC_Handle->interface;
+		phost->Control.setup.b.wLength.w     = 1U;
+	}
+	return USBH_CtlReq(phost, Maxlun, 1U);
+}
+
+
+USBH_StatusTypeDef USBH_MSC_BOT_Init(USBH_HandleTypeDef *phost)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+
+	MSC_Handle->hbot.cbw.field.Signature = BOT_CBW_SIGNATURE;
+	MSC_Handle->hbot.cbw.field.Tag       = 0x20304050U;
+	MSC_Handle->hbot.state               = BOT_SEND_CBW;
+	MSC_Handle->hbot.cmd_state           = BOT_CMD_SEND;
+	return USBH_OK;
+}
+
+
+/**
+ * @brief Checks the CSW of the command just done.
+ */
+static USBH_StatusTypeDef BOT_check_CSW(MSC_HandleTypeDef *MSC_Handle)
+{
+	BOT_HandleTypeDef *bot = &MSC_Handle->hbot;
+
+	if (bot->csw.field.Signature != BOT_CSW_SIGNATURE || bot->csw.field.Tag != bot->cbw.field.Tag)
+		return USBH_UNRECOVERED_ERROR;
+	if (bot->csw.field.Status == BOT_CSW_CMD_PASSED)
+		return USBH_OK;
+	if (bot->csw.field.Status == BOT_CSW_CMD_FAILED)
+		return USBH_FAIL;
+	return USBH_UNRECOVERED_ERROR; // phase error: only a BOT reset recovers
+}
+
+
+/**
+ * @brief Runs the command in hbot.cbw one step.
+ * @return USBH_BUSY while it runs; USBH_OK, USBH_FAIL (the command failed, REQUEST
+ * SENSE tells why) or USBH_UNRECOVERED_ERROR when done
+ */
+USBH_StatusTypeDef USBH_MSC_BOT_Process(USBH_HandleTypeDef *phost, uint8_t lun)
+{
+	MSC_HandleTypeDef   *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+	BOT_HandleTypeDef   *bot        = &MSC_Handle->hbot;
+	USBH_StatusTypeDef   status     = USBH_BUSY;
+	USBH_URBStateTypeDef urb;
+	uint32_t             n;
+
+	switch (bot->state)
+	{
+	case BOT_SEND_CBW:
+		bot->cbw.field.LUN = lun;
+		bot->cbw.field.Tag++;
+		bot->remaining = bot->cbw.field.DataTransferLength;
+		bot->state     = BOT_SEND_CBW_WAIT;
+		(void)USBH_BulkSendData(phost, bot->cbw.data, BOT_CBW_LENGTH, MSC_Handle->OutPipe, 1U);
+		break;
+
+	case BOT_SEND_CBW_WAIT:
+		urb = USBH_LL_GetURBState(phost, MSC_Handle->OutPipe);
+		if (urb == USBH_URB_DONE)
+		{
+			if (bot->remaining == 0U)
+				bot->state = BOT_RECEIVE_CSW;
+			else if (bot->cbw.field.Flags & USB_EP_DIR_IN)
+				bot->state = BOT_DATA_IN;
+			else
+				bot->state = BOT_DATA_OUT;
+			BOT_event(phost);
+		}
+		else if (urb == USBH_URB_NOTREADY)
+		{
+			bot->cbw.field.Tag--; // sent again with the same tag
+			bot->state = BOT_SEND_CBW;
+			BOT_event(phost);
+		}
+		else if (urb == USBH_URB_STALL)
+		{
+			bot->state = BOT_ERROR_OUT;
+			BOT_event(phost);
+		}
+		break;
+
+	case BOT_DATA_IN:
+		bot->state = BOT_DATA_IN_WAIT;
+		(void)USBH_BulkReceiveData(phost, bot->pbuf, MSC_Handle->InEpSize, MSC_Handle->InPipe);
+		break;
+
+	case BOT_DATA_IN_WAIT:
+		urb = USBH_LL_GetURBState(phost, MSC_Handle->InPipe);
+		if (urb == USBH_URB_DONE)
+		{
+			n = USBH_LL_GetLastXferSize(phost, MSC_Handle->InPipe);
+			if (n >= bot->remaining || n < MSC_Handle->InEpSize) // the last packet, or short: the device ends the data stage
+				bot->remaining = 0U;
+			else
+			{
+				bot->remaining -= n;
+				bot->pbuf      += n;
+			}
+			bot->state = (bot->remaining ? BOT_DATA_IN : BOT_RECEIVE_CSW);
+			BOT_event(phost);
+		}
+		else if (urb == USBH_URB_STALL)
+		{
+			bot->state = BOT_ERROR_IN;
+			BOT_event(phost);
+		}
+		break;
+
+	case BOT_DATA_OUT:
+		n = (bot->remaining > MSC_Handle->OutEpSize ? MSC_Handle->OutEpSize : bot->remaining);
+		bot->state = BOT_DATA_OUT_WAIT;
+		(void)USBH_BulkSendData(phost, bot->pbuf, (uint16_t)n, MSC_Handle->OutPipe, 1U);
+		break;
+
+	case BOT_DATA_OUT_WAIT:
+		urb = USBH_LL_GetURBState(phost, MSC_Handle->OutPipe);
+		if (urb == USBH_URB_DONE)
+		{
+			n = (bot->remaining > MSC_Handle->OutEpSize ? MSC_Handle->OutEpSize : bot->remaining);
+			bot->remaining -= n;
+			bot->pbuf      += n;
+			bot->state = (bot->remaining ? BOT_DATA_OUT : BOT_RECEIVE_CSW);
+			BOT_event(phost);
+		}
+		else if (urb == USBH_URB_NOTREADY)
+		{
+			bot->state = BOT_DATA_OUT; // NAK: the same packet again
+			BOT_event(phost);
+		}
+		else if (urb == USBH_URB_STALL)
+		{
+			bot->state = BOT_ERROR_OUT;
+			BOT_event(phost);
+		}
+		break;
+
+	case BOT_RECEIVE_CSW:
+		bot->state = BOT_RECEIVE_CSW_WAIT;
+		(void)USBH_BulkReceiveData(phost, bot->csw.data, BOT_CSW_LENGTH, MSC_Handle->InPipe);
+		break;
+
+	case BOT_RECEIVE_CSW_WAIT:
+		urb = USBH_LL_GetURBState(phost, MSC_Handle->InPipe);
+		if (urb == USBH_URB_DONE)
+		{
+			bot->state     = BOT_SEND_CBW;
+			bot->cmd_state = BOT_CMD_SEND;
+			status = BOT_check_CSW(MSC_Handle);
+			if (status == USBH_UNRECOVERED_ERROR)
+				bot->state = BOT_UNRECOVERED_ERROR;
+			BOT_event(phost);
+		}
+		else if (urb == USBH_URB_STALL)
+		{
+			bot->state = BOT_ERROR_IN; // clear the halt and read the CSW once more
+			BOT_event(phost);
+		}
+		break;
+
+	case BOT_ERROR_IN:
+		status = USBH_ClrFeature(phost, MSC_Handle->InEp);
+		if (status == USBH_OK)
+		{
+			(void)USBH_LL_SetToggle(phost, MSC_Handle->InPipe, 0U);
+			bot->state = BOT_RECEIVE_CSW;
+		}
+		else if (status != USBH_BUSY)
+			bot->state = BOT_UNRECOVERED_ERROR;
+		status = USBH_BUSY;
+		BOT_event(phost);
+		break;
+
+	case BOT_ERROR_OUT:
+		status = USBH_ClrFeature(phost, MSC_Handle->OutEp);
+		if (status == USBH_OK)
+		{
+			(void)USBH_LL_SetToggle(phost, MSC_Handle->OutPipe, 0U);
+			bot->state = BOT_RECEIVE_CSW;
+		}
+		else if (status != USBH_BUSY)
+			bot->state = BOT_UNRECOVERED_ERROR;
+		status = USBH_BUSY;
+		BOT_event(phost);
+		break;
+
+	case BOT_UNRECOVERED_ERROR:
+	default:
+		status = USBH_UNRECOVERED_ERROR;
+		break;
+	}
+	return status;
+}
@@ -0,0 +1,175 @@
+/*
+ * usbh_msc_scsi.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * SCSI commands over BOT, see usbh_msc_scsi.h. A command fills the CBW on the first
+ * call (hbot.cmd_state BOT_CMD_SEND) and runs USBH_MSC_BOT_Process() on the next ones;
+ * BOT sets cmd_state back when the CSW is in. Block addresses and lengths are big-endian
+ * in the command blocks and in the READ CAPACITY data.
+ */
+
+#include <string.h>
+#include "usbh_msc.h"
+
+
+static uint32_t SCSI_be32(const uint8_t *p)
+{
+	return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+
+/**
+ * @brief Fills the CBW of a command.
+ * @param len Bytes of the data stage, 0 if none
+ * @param dir USB_EP_DIR_IN or USB_EP_DIR_OUT
+ * @param cblen Length of the command block: 6 or 10
+ */
+static void SCSI_cbw(MSC_HandleTypeDef *MSC_Handle, uint32_t len, uint8_t dir, uint8_t cblen, uint8_t *pbuf)
+{
+	BOT_HandleTypeDef *bot = &MSC_Handle->hbot;
+
+	bot->cbw.field.DataTransferLength = len;
+	bot->cbw.field.Flags              = dir;
+	bot->cbw.field.CBLength           = cblen;
+	memset(bot->cbw.field.CB, 0, BOT_CBW_CB_LENGTH);
+	bot->pbuf      = (pbuf ? pbuf : (uint8_t *)bot->data);
+	bot->state     = BOT_SEND_CBW;
+	bot->cmd_state = BOT_CMD_WAIT;
+}
+
+
+/**
+ * @brief READ(10) and WRITE(10): length blocks from address.
+ */
+static void SCSI_rw10(MSC_HandleTypeDef *MSC_Handle, uint8_t lun, uint8_t opcode, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	uint8_t *cb = MSC_Handle->hbot.cbw.field.CB;
+
+	SCSI_cbw(MSC_Handle, length * MSC_Handle->unit[lun].capacity.block_size,
+	         (opcode == SCSI_READ10 ? USB_EP_DIR_IN : USB_EP_DIR_OUT), 10U, pbuf);
+	cb[0] = opcode;
+	cb[2] = (uint8_t)(address >> 24);
+	cb[3] = (uint8_t)(address >> 16);
+	cb[4] = (uint8_t)(address >> 8);
+	cb[5] = (uint8_t)address;
+	cb[7] = (uint8_t)(length >> 8);
+	cb[8] = (uint8_t)length;
+}
+
+
+USBH_StatusTypeDef USBH_MSC_SCSI_TestUnitReady(USBH_HandleTypeDef *phost, uint8_t lun)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+
+	if (MSC_Handle->hbot.cmd_state == BOT_CMD_SEND)
+	{
+		SCSI_cbw(MSC_Handle, 0U, USB_EP_DIR_OUT, 6U, NULL);
+		MSC_Handle->hbot.cbw.field.CB[0] = SCSI_TEST_UNIT_READY;
+		return USBH_BUSY;
+	}
+	return USBH_MSC_BOT_Process(phost, lun);
+}
+
+
+USBH_StatusTypeDef USBH_MSC_SCSI_ReadCapacity(USBH_HandleTypeDef *phost, uint8_t lun, SCSI_CapacityTypeDef *capacity)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+	const uint8_t     *data       = (const uint8_t *)MSC_Handle->hbot.data;
+	USBH_StatusTypeDef status;
+
+	if (MSC_Handle->hbot.cmd_state == BOT_CMD_SEND)
+	{
+		SCSI_cbw(MSC_Handle, DATA_LEN_READ_CAPACITY10, USB_EP_DIR_IN, 10U, NULL);
+		MSC_Handle->hbot.cbw.field.CB[0] = SCSI_READ_CAPACITY10;
+		return USBH_BUSY;
+	}
+	status = USBH_MSC_BOT_Process(phost, lun);
+	if (status == USBH_OK)
+	{
+		capacity->block_nbr  = SCSI_be32(&data[0]) + 1U; // the last LBA
+		capacity->block_size = (uint16_t)SCSI_be32(&data[4]);
+	}
+	return status;
+}
+
+
+USBH_StatusTypeDef USBH_MSC_SCSI_Inquiry(USBH_HandleTypeDef *phost, uint8_t lun, SCSI_StdInquiryDataTypeDef *inquiry)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+	const uint8_t     *data       = (const uint8_t *)MSC_Handle->hbot.data;
+	USBH_StatusTypeDef status;
+
+	if (MSC_Handle->hbot.cmd_state == BOT_CMD_SEND)
+	{
+		SCSI_cbw(MSC_Handle, DATA_LEN_INQUIRY, USB_EP_DIR_IN, 6U, NULL);
+		MSC_Handle->hbot.cbw.field.CB[0] = SCSI_INQUIRY;
+		MSC_Handle->hbot.cbw.field.CB[1] = (uint8_t)(lun << 5);
+		MSC_Handle->hbot.cbw.field.CB[4] = DATA_LEN_INQUIRY;
+		return USBH_BUSY;
+	}
+	status = USBH_MSC_BOT_Process(phost, lun);
+	if (status == USBH_OK)
+	{
+		memset(inquiry, 0, sizeof(*inquiry));
+		inquiry->PeripheralQualifier = data[0] >> 5;
+		inquiry->DeviceType          = data[0] & 0x1FU;
+		inquiry->RemovableMedia      = (data[1] & 0x80U) ? 1U : 0U;
+		memcpy(inquiry->vendor_id,   &data[8],  8U);
+		memcpy(inquiry->product_id,  &data[16], 16U);
+		memcpy(inquiry->revision_id, &data[32], 4U);
+	}
+	return status;
+}
+
+
+USBH_StatusTypeDef USBH_MSC_SCSI_RequestSense(USBH_HandleTypeDef *phost, uint8_t lun, SCSI_SenseTypeDef *sense_data)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+	const uint8_t     *data       = (const uint8_t *)MSC_Handle->hbot.data;
+	USBH_StatusTypeDef status;
+
+	if (MSC_Handle->hbot.cmd_state == BOT_CMD_SEND)
+	{
+		SCSI_cbw(MSC_Handle, DATA_LEN_REQUEST_SENSE, USB_EP_DIR_IN, 6U, NULL);
+		MSC_Handle->hbot.cbw.field.CB[0] = SCSI_REQUEST_SENSE;
+		MSC_Handle->hbot.cbw.field.CB[1] = (uint8_t)(lun << 5);
+		MSC_Handle->hbot.cbw.field.CB[4] = DATA_LEN_REQUEST_SENSE;
+		return USBH_BUSY;
+	}
+	status = USBH_MSC_BOT_Process(phost, lun);
+	if (status == USBH_OK)
+	{
+		sense_data->key  = data[2] & 0x0FU;
+		sense_data->asc  = data[12];
+		sense_data->ascq = data[13];
+	}
+	return status;
+}
+
+
+USBH_StatusTypeDef USBH_MSC_SCSI_Write(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+
+	if (MSC_Handle->hbot.cmd_state == BOT_CMD_SEND)
+	{
+		SCSI_rw10(MSC_Handle, lun, SCSI_WRITE10, address, pbuf, length);
+		return USBH_BUSY;
+	}
+	return USBH_MSC_BOT_Process(phost, lun);
+}
+
+
+USBH_StatusTypeDef USBH_MSC_SCSI_Read(USBH_HandleTypeDef *phost, uint8_t lun, uint32_t address, uint8_t *pbuf, uint32_t length)
+{
+	MSC_HandleTypeDef *MSC_Handle = (MSC_HandleTypeDef *)USBH_msc.pData;
+
+	if (MSC_Handle->hbot.cmd_state == BOT_CMD_SEND)
+	{
+		SCSI_rw10(MSC_Handle, lun, SCSI_READ10, address, pbuf, length);
+		return USBH_BUSY;
+	}
+	return USBH_MSC_BOT_Process(phost, lun);
+}
@@ -0,0 +1,52 @@
+/*
+ * diskio.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Disk interface of FatFs, see diskio.h: passes every call to the driver linked to
+ * the drive (ff_gen_drv.c), with the driver's LUN.
+ */
+
+#include "diskio.h"
+#include "ff_gen_drv.h"
+
+extern Disk_drvTypeDef disk;
+
+
+DSTATUS disk_status(BYTE pdrv)
+{
+	return disk.drv[pdrv]->disk_status(disk.lun[pdrv]);
+}
+
+
+DSTATUS disk_initialize(BYTE pdrv)
+{
+	DSTATUS stat = RES_OK;
+
+	if (disk.is_initialized[pdrv] == 0)
+	{
+		stat = disk.drv[pdrv]->disk_initialize(disk.lun[pdrv]);
+		if (stat == RES_OK)
+			disk.is_initialized[pdrv] = 1;
+	}
+	return stat;
+}
+
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+	return disk.drv[pdrv]->disk_read(disk.lun[pdrv], buff, sector, count);
+}
+
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+	return disk.drv[pdrv]->disk_write(disk.lun[pdrv], buff, sector, count);
+}
+
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	return disk.drv[pdrv]->disk_ioctl(disk.lun[pdrv], cmd, buff);
+}
@@ -0,0 +1,44 @@
+/*
+ * diskio.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Disk interface of FatFs: ff.c calls these for physical drive pdrv, diskio.c passes
+ * them on to the driver linked with FATFS_LinkDriver() (ff_gen_drv.h).
+ */
+
+#ifndef _DISKIO_DEFINED
+#define _DISKIO_DEFINED
+
+#include "integer.h"
+
+typedef BYTE DSTATUS;
+
+typedef enum
+{
+	RES_OK = 0,   // successful
+	RES_ERROR,    // read/write error
+	RES_WRPRT,    // write protected
+	RES_NOTRDY,   // not ready
+	RES_PARERR    // invalid parameter
+} DRESULT;
+
+/// DSTATUS bits
+#define STA_NOINIT       0x01
+#define STA_NODISK       0x02
+#define STA_PROTECT      0x04
+
+/// disk_ioctl() commands
+#define CTRL_SYNC        0   // finish pending writes
+#define GET_SECTOR_COUNT 1
+#define GET_SECTOR_SIZE  2
+#define GET_BLOCK_SIZE   3   // erase block, in sectors
+
+DSTATUS disk_initialize(BYTE pdrv);
+DSTATUS disk_status(BYTE pdrv);
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count);
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count);
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff);
+
+#endif /* _DISKIO_DEFINED */
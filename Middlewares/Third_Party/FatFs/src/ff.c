@@ -0,0 +1,919 @@
+/*
+ * ff.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * FAT16/FAT32 file system, see ff.h. The structure follows FatFs: one sector window
+ * per volume (FATFS.win) for the FAT and the directory, one sector buffer per file
+ * (FIL.buf) for partial sectors, and whole sectors straight from the caller's buffer to
+ * the disk in one disk_write() per cluster. A dirty FAT sector is written to both FAT
+ * copies; the FAT32 FSInfo (free count, next free cluster) is kept up to date on
+ * f_sync(). Clusters are allocated after the last allocated one, so a file written in
+ * one go is contiguous on a stick that is not full.
+ */
+
+#include <string.h>
+#include "ff.h"
+#include "diskio.h"
+
+#define SS            _MAX_SS
+#define SZDIRE        32                  // directory entry
+#define DIR_PER_SECT  (SS / SZDIRE)
+#define MAX_DIR       0x10000             // entries in a directory (FAT spec)
+#define MAX_FAT12     0xFF5               // clusters
+#define MAX_FAT16     0xFFF5
+
+#define FA_MODIFIED   0x40                // file changed, directory entry to update
+#define FA_DIRTY      0x80                // FIL.buf changed
+
+// boot sector and BPB
+#define BS_JmpBoot      0
+#define BPB_BytsPerSec  11
+#define BPB_SecPerClus  13
+#define BPB_RsvdSecCnt  14
+#define BPB_NumFATs     16
+#define BPB_RootEntCnt  17
+#define BPB_TotSec16    19
+#define BPB_FATSz16     22
+#define BPB_TotSec32    32
+#define BS_FilSysType   54
+#define BPB_FATSz32     36
+#define BPB_RootClus32  44
+#define BPB_FSInfo32    48
+#define BS_FilSysType32 82
+#define BS_55AA         510
+#define MBR_Table       446
+#define SZ_PTE          16
+
+// FSInfo
+#define FSI_LeadSig     0
+#define FSI_StrucSig    484
+#define FSI_Free_Count  488
+#define FSI_Nxt_Free    492
+
+// directory entry
+#define DIR_Name        0
+#define DIR_Attr        11
+#define DIR_CrtTime     14
+#define DIR_LstAccDate  18
+#define DIR_FstClusHI   20
+#define DIR_ModTime     22
+#define DIR_FstClusLO   26
+#define DIR_FileSize    28
+#define DDEM            0xE5              // deleted entry
+
+#define ABORT(fp, res)  do { (fp)->err = (BYTE)(res); return (res); } while (0)
+
+/// position in the root directory
+typedef struct
+{
+	DWORD clust;   // 0: FAT16 root
+	DWORD sect;
+	UINT  index;
+} DIRPOS;
+
+static FATFS *FatFs[_VOLUMES];
+static WORD   Fsid;
+
+
+static WORD ld_word(const BYTE *p)
+{
+	return (WORD)(p[0] | (p[1] << 8));
+}
+
+static DWORD ld_dword(const BYTE *p)
+{
+	return (DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16) | ((DWORD)p[3] << 24);
+}
+
+static void st_word(BYTE *p, WORD val)
+{
+	p[0] = (BYTE)val;
+	p[1] = (BYTE)(val >> 8);
+}
+
+static void st_dword(BYTE *p, DWORD val)
+{
+	p[0] = (BYTE)val;
+	p[1] = (BYTE)(val >> 8);
+	p[2] = (BYTE)(val >> 16);
+	p[3] = (BYTE)(val >> 24);
+}
+
+
+/**
+ * @brief Writes the window back if it is dirty; a FAT sector also to the second FAT.
+ */
+static FRESULT sync_window(FATFS *fs)
+{
+	if (!fs->wflag)
+		return FR_OK;
+	if (disk_write(fs->drv, fs->win, fs->winsect, 1) != RES_OK)
+		return FR_DISK_ERR;
+	if (fs->winsect - fs->fatbase < fs->fsize && fs->n_fats == 2 &&
+	    disk_write(fs->drv, fs->win, fs->winsect + fs->fsize, 1) != RES_OK)
+		return FR_DISK_ERR;
+	fs->wflag = 0;
+	return FR_OK;
+}
+
+
+static FRESULT move_window(FATFS *fs, DWORD sect)
+{
+	if (sect == fs->winsect)
+		return FR_OK;
+	if (sync_window(fs) != FR_OK)
+		return FR_DISK_ERR;
+	if (disk_read(fs->drv, fs->win, sect, 1) != RES_OK)
+	{
+		fs->winsect = 0xFFFFFFFF;
+		return FR_DISK_ERR;
+	}
+	fs->winsect = sect;
+	return FR_OK;
+}
+
+
+static DWORD clust2sect(const FATFS *fs, DWORD clst)
+{
+	return fs->database + (clst - 2) * fs->csize;
+}
+
+
+/**
+ * @brief FAT entry of a cluster.
+ * @return The entry; 1 for an invalid cluster, 0xFFFFFFFF on a disk error
+ */
+static DWORD get_fat(FATFS *fs, DWORD clst)
+{
+	if (clst < 2 || clst >= fs->n_fatent)
+		return 1;
+	if (fs->fs_type == FS_FAT16)
+	{
+		if (move_window(fs, fs->fatbase + clst / (SS / 2)) != FR_OK)
+			return 0xFFFFFFFF;
+		return ld_word(fs->win + clst % (SS / 2) * 2);
+	}
+	if (move_window(fs, fs->fatbase + clst / (SS / 4)) != FR_OK)
+		return 0xFFFFFFFF;
+	return ld_dword(fs->win + clst % (SS / 4) * 4) & 0x0FFFFFFF;
+}
+
+
+static FRESULT put_fat(FATFS *fs, DWORD clst, DWORD val)
+{
+	BYTE *p;
+
+	if (clst < 2 || clst >= fs->n_fatent)
+		return FR_INT_ERR;
+	if (fs->fs_type == FS_FAT16)
+	{
+		if (move_window(fs, fs->fatbase + clst / (SS / 2)) != FR_OK)
+			return FR_DISK_ERR;
+		st_word(fs->win + clst % (SS / 2) * 2, (WORD)val);
+	}
+	else
+	{
+		if (move_window(fs, fs->fatbase + clst / (SS / 4)) != FR_OK)
+			return FR_DISK_ERR;
+		p = fs->win + clst % (SS / 4) * 4;
+		st_dword(p, (val & 0x0FFFFFFF) | (ld_dword(p) & 0xF0000000)); // the top 4 bits are reserved
+	}
+	fs->wflag = 1;
+	return FR_OK;
+}
+
+
+/**
+ * @brief The cluster after clst, allocated if clst ends the chain; clst 0 starts a
+ * new chain.
+ * @return The cluster; 0 if the disk is full, 1 on an internal error, 0xFFFFFFFF on
+ * a disk error
+ */
+static DWORD create_chain(FATFS *fs, DWORD clst)
+{
+	DWORD   cs, ncl, scl;
+	FRESULT res;
+
+	if (clst == 0)
+	{
+		scl = fs->last_clst;
+		if (scl == 0 || scl >= fs->n_fatent)
+			scl = 1;
+	}
+	else
+	{
+		cs = get_fat(fs, clst);
+		if (cs < 2)
+			return 1;
+		if (cs == 0xFFFFFFFF || cs < fs->n_fatent)
+			return cs;                          // disk error, or clst already has a next cluster
+		scl = clst;
+	}
+	if (fs->free_clst == 0)
+		return 0;
+
+	ncl = scl;
+	for (;;)
+	{
+		ncl++;
+		if (ncl >= fs->n_fatent)
+		{
+			ncl = 2;
+			if (ncl > scl)
+				return 0;
+		}
+		cs = get_fat(fs, ncl);
+		if (cs == 0)
+			break;
+		if (cs == 1 || cs == 0xFFFFFFFF)
+			return cs;
+		if (ncl == scl)
+			return 0;                           // all the way round
+	}
+
+	res = put_fat(fs, ncl, 0x0FFFFFFF);         // end of chain (0xFFFF on FAT16)
+	if (res == FR_OK && clst != 0)
+		res = put_fat(fs, clst, ncl);
+	if (res != FR_OK)
+		return (res == FR_DISK_ERR ? 0xFFFFFFFF : 1);
+
+	fs->last_clst = ncl;
+	if (fs->free_clst <= fs->n_fatent - 2)
+		fs->free_clst--;
+	fs->fsi_flag = 1;
+	return ncl;
+}
+
+
+/**
+ * @brief Writes the window, the FSInfo if it changed, and flushes the disk.
+ */
+static FRESULT sync_fs(FATFS *fs)
+{
+	FRESULT res = sync_window(fs);
+
+	if (res == FR_OK && fs->fs_type == FS_FAT32 && fs->fsi_sect && fs->fsi_flag)
+	{
+		memset(fs->win, 0, SS);
+		st_dword(fs->win + FSI_LeadSig,    0x41615252);
+		st_dword(fs->win + FSI_StrucSig,   0x61417272);
+		st_dword(fs->win + FSI_Free_Count, fs->free_clst);
+		st_dword(fs->win + FSI_Nxt_Free,   fs->last_clst);
+		st_word (fs->win + BS_55AA,        0xAA55);
+		fs->winsect = fs->fsi_sect;
+		if (disk_write(fs->drv, fs->win, fs->winsect, 1) != RES_OK)
+			res = FR_DISK_ERR;
+		fs->fsi_flag = 0;
+	}
+	if (res == FR_OK && disk_ioctl(fs->drv, CTRL_SYNC, NULL) != RES_OK)
+		res = FR_DISK_ERR;
+	return res;
+}
+
+
+/**
+ * @brief Drive number of a path "n:..." (no prefix: drive 0); moves the path past it.
+ * @return The drive, -1 if invalid
+ */
+static int get_ldnumber(const char **path)
+{
+	const char *p = *path;
+	const char *c;
+
+	if (!p)
+		return -1;
+	for (c = p; *c && *c != ':' && *c != '/' && *c != '\\'; c++)
+		;
+	if (*c != ':')
+		return 0;
+	if (c != p + 1 || p[0] < '0' || p[0] >= '0' + _VOLUMES)
+		return -1;
+	*path = c + 1;
+	return p[0] - '0';
+}
+
+
+/**
+ * @brief 0: a FAT boot sector, 1: a valid sector but not FAT (an MBR), 2: no 0xAA55,
+ * 3: disk error.
+ */
+static int check_fs(FATFS *fs, DWORD sect)
+{
+	fs->wflag   = 0;
+	fs->winsect = 0xFFFFFFFF;
+	if (move_window(fs, sect) != FR_OK)
+		return 3;
+	if (ld_word(fs->win + BS_55AA) != 0xAA55)
+		return 2;
+	if ((fs->win[BS_JmpBoot] == 0xE9 || fs->win[BS_JmpBoot] == 0xEB || fs->win[BS_JmpBoot] == 0xE8) &&
+	    (memcmp(fs->win + BS_FilSysType, "FAT", 3) == 0 || memcmp(fs->win + BS_FilSysType32, "FAT32", 5) == 0))
+		return 0;
+	return 1;
+}
+
+
+/**
+ * @brief Mounts the volume of a path if it is not mounted (or the disk was replaced).
+ * @param wmode Non-zero if the caller writes
+ */
+static FRESULT find_volume(const char **path, FATFS **rfs, BYTE wmode)
+{
+	FATFS  *fs;
+	DSTATUS stat;
+	DWORD   bsect, fasize, tsect, sysect, nclst, szbfat;
+	WORD    nrsv;
+	BYTE    fmt;
+	int     vol, i;
+
+	*rfs = NULL;
+	vol = get_ldnumber(path);
+	if (vol < 0)
+		return FR_INVALID_DRIVE;
+	fs = FatFs[vol];
+	if (!fs)
+		return FR_NOT_ENABLED;
+	*rfs = fs;
+
+	if (fs->fs_type)
+	{
+		stat = disk_status(fs->drv);
+		if (!(stat & STA_NOINIT))
+			return ((wmode && (stat & STA_PROTECT)) ? FR_WRITE_PROTECTED : FR_OK);
+	}
+
+	fs->fs_type = 0;
+	fs->drv     = (BYTE)vol;
+	stat = disk_initialize(fs->drv);
+	if (stat & STA_NOINIT)
+		return FR_NOT_READY;
+	if (wmode && (stat & STA_PROTECT))
+		return FR_WRITE_PROTECTED;
+
+	// the boot sector: sector 0 (a superfloppy) or the first FAT partition of the MBR
+	bsect = 0;
+	fmt = check_fs(fs, bsect);
+	if (fmt == 1)
+	{
+		DWORD part[4];
+
+		for (i = 0; i < 4; i++)
+		{
+			const BYTE *pte = fs->win + MBR_Table + i * SZ_PTE;
+			part[i] = (pte[4] ? ld_dword(pte + 8) : 0);
+		}
+		for (i = 0, fmt = 2; i < 4 && fmt >= 2; i++)
+		{
+			bsect = part[i];
+			fmt = (bsect ? check_fs(fs, bsect) : 2);
+		}
+	}
+	if (fmt == 3)
+		return FR_DISK_ERR;
+	if (fmt)
+		return FR_NO_FILESYSTEM;
+
+	if (ld_word(fs->win + BPB_BytsPerSec) != SS)
+		return FR_NO_FILESYSTEM;
+	fasize = ld_word(fs->win + BPB_FATSz16);
+	if (!fasize)
+		fasize = ld_dword(fs->win + BPB_FATSz32);
+	fs->fsize     = fasize;
+	fs->n_fats    = fs->win[BPB_NumFATs];
+	fs->csize     = fs->win[BPB_SecPerClus];
+	fs->n_rootdir = ld_word(fs->win + BPB_RootEntCnt);
+	tsect = ld_word(fs->win + BPB_TotSec16);
+	if (!tsect)
+		tsect = ld_dword(fs->win + BPB_TotSec32);
+	nrsv = ld_word(fs->win + BPB_RsvdSecCnt);
+	if ((fs->n_fats != 1 && fs->n_fats != 2) || !fs->csize || (fs->csize & (fs->csize - 1)) ||
+	    fs->n_rootdir % DIR_PER_SECT || !nrsv || !fasize)
+		return FR_NO_FILESYSTEM;
+
+	sysect = nrsv + fasize * fs->n_fats + fs->n_rootdir / DIR_PER_SECT;
+	if (tsect <= sysect)
+		return FR_NO_FILESYSTEM;
+	nclst = (tsect - sysect) / fs->csize;
+	if (nclst <= MAX_FAT12)
+		return FR_NO_FILESYSTEM;                // FAT12 is not supported
+	fmt = (nclst <= MAX_FAT16 ? FS_FAT16 : FS_FAT32);
+
+	fs->n_fatent = nclst + 2;
+	fs->volbase  = bsect;
+	fs->fatbase  = bsect + nrsv;
+	fs->database = bsect + sysect;
+	if (fmt == FS_FAT32)
+	{
+		if (fs->n_rootdir)
+			return FR_NO_FILESYSTEM;
+		fs->dirbase = ld_dword(fs->win + BPB_RootClus32);
+		szbfat = fs->n_fatent * 4;
+	}
+	else
+	{
+		if (!fs->n_rootdir)
+			return FR_NO_FILESYSTEM;
+		fs->dirbase = fs->fatbase + fasize * fs->n_fats;
+		szbfat = fs->n_fatent * 2;
+	}
+	if (fs->fsize < (szbfat + SS - 1) / SS)
+		return FR_NO_FILESYSTEM;
+
+	fs->last_clst = fs->free_clst = 0xFFFFFFFF;
+	fs->fsi_flag  = 0;
+	fs->fsi_sect  = 0;
+	if (fmt == FS_FAT32 && ld_word(fs->win + BPB_FSInfo32))
+	{
+		DWORD fsi = bsect + ld_word(fs->win + BPB_FSInfo32);
+
+		if (move_window(fs, fsi) == FR_OK &&
+		    ld_dword(fs->win + FSI_LeadSig) == 0x41615252 && ld_dword(fs->win + FSI_StrucSig) == 0x61417272 &&
+		    ld_word(fs->win + BS_55AA) == 0xAA55)
+		{
+			fs->fsi_sect  = fsi;
+			fs->free_clst = ld_dword(fs->win + FSI_Free_Count);
+			fs->last_clst = ld_dword(fs->win + FSI_Nxt_Free);
+			if (fs->free_clst > fs->n_fatent - 2)
+				fs->free_clst = 0xFFFFFFFF;     // unknown
+		}
+	}
+
+	fs->fs_type = fmt;
+	fs->id      = ++Fsid;
+	return FR_OK;
+}
+
+
+/**
+ * @brief An open file of the current mount.
+ */
+static FRESULT validate(FIL *fp, FATFS **rfs)
+{
+	*rfs = NULL;
+	if (!fp || !fp->obj.fs || !fp->obj.fs->fs_type || fp->obj.id != fp->obj.fs->id ||
+	    (disk_status(fp->obj.fs->drv) & STA_NOINIT))
+		return FR_INVALID_OBJECT;
+	*rfs = fp->obj.fs;
+	return FR_OK;
+}
+
+
+/**
+ * @brief The 8.3 directory name of a path in the root: "name.ext", upper case,
+ * padded with spaces.
+ */
+static FRESULT make_sfn(const char *path, BYTE *sfn)
+{
+	const char *illegal = "\"*+,:;<=>?[]|\x7F";
+	UINT        i = 0, ni = 8;
+	BYTE        c;
+
+	while (*path == '/' || *path == '\\')
+		path++;
+	memset(sfn, ' ', 11);
+	for (;;)
+	{
+		c = (BYTE)*path++;
+		if (c == 0)
+			break;
+		if (c == '/' || c == '\\')
+			return FR_NO_PATH;                  // subdirectories are not supported
+		if (c == '.' && ni == 8)
+		{
+			if (i == 0)
+				return FR_INVALID_NAME;
+			i  = 8;
+			ni = 11;
+			continue;
+		}
+		if (i >= ni || c <= ' ' || c >= 0x80 || c == '.' || strchr(illegal, c))
+			return FR_INVALID_NAME;
+		if (c >= 'a' && c <= 'z')
+			c -= 0x20;
+		sfn[i++] = c;
+	}
+	if (sfn[0] == ' ')
+		return FR_INVALID_NAME;
+	return FR_OK;
+}
+
+
+static void dir_first(const FATFS *fs, DIRPOS *d)
+{
+	d->index = 0;
+	if (fs->fs_type == FS_FAT32)
+	{
+		d->clust = fs->dirbase;
+		d->sect  = clust2sect(fs, d->clust);
+	}
+	else
+	{
+		d->clust = 0;
+		d->sect  = fs->dirbase;
+	}
+}
+
+
+/**
+ * @brief Next directory entry.
+ * @param stretch At the end of a FAT32 root: allocate and clear one more cluster
+ * @return FR_NO_FILE at the end of the directory
+ */
+static FRESULT dir_next(FATFS *fs, DIRPOS *d, int stretch)
+{
+	DWORD clst;
+	UINT  n;
+
+	if (++d->index >= MAX_DIR)
+		return FR_NO_FILE;
+	if (d->index % DIR_PER_SECT)
+		return FR_OK;
+	d->sect++;
+	if (!d->clust)
+		return (d->index < fs->n_rootdir ? FR_OK : FR_NO_FILE);
+	if ((d->index / DIR_PER_SECT) % fs->csize)
+		return FR_OK;
+
+	clst = get_fat(fs, d->clust);
+	if (clst <= 1)
+		return FR_INT_ERR;
+	if (clst == 0xFFFFFFFF)
+		return FR_DISK_ERR;
+	if (clst >= fs->n_fatent)
+	{
+		if (!stretch)
+			return FR_NO_FILE;
+		clst = create_chain(fs, d->clust);
+		if (clst == 0)
+			return FR_DENIED;                   // disk full
+		if (clst == 1)
+			return FR_INT_ERR;
+		if (clst == 0xFFFFFFFF || sync_window(fs) != FR_OK)
+			return FR_DISK_ERR;
+		memset(fs->win, 0, SS);
+		for (n = 0; n < fs->csize; n++)
+		{
+			fs->winsect = clust2sect(fs, clst) + n;
+			fs->wflag   = 1;
+			if (sync_window(fs) != FR_OK)
+				return FR_DISK_ERR;
+		}
+	}
+	d->clust = clst;
+	d->sect  = clust2sect(fs, clst);
+	return FR_OK;
+}
+
+
+/**
+ * @brief Looks up an 8.3 name in the root directory and notes the first free entry.
+ * @param stretch Extend a full FAT32 root to get a free entry
+ * @return FR_OK with the entry in fs->win at *found, FR_NO_FILE if not there
+ */
+static FRESULT dir_find(FATFS *fs, const BYTE *sfn, DIRPOS *found, DIRPOS *fre, int *have_free, int stretch)
+{
+	DIRPOS  d;
+	FRESULT res;
+	BYTE   *e;
+
+	*have_free = 0;
+	dir_first(fs, &d);
+	for (;;)
+	{
+		res = move_window(fs, d.sect);
+		if (res != FR_OK)
+			return res;
+		e = fs->win + (d.index % DIR_PER_SECT) * SZDIRE;
+		if (e[DIR_Name] == 0 || e[DIR_Name] == DDEM)
+		{
+			if (!*have_free)
+			{
+				*fre       = d;
+				*have_free = 1;
+			}
+			if (e[DIR_Name] == 0)
+				return FR_NO_FILE;              // the entries after it are unused too
+		}
+		else if (e[DIR_Attr] != AM_LFN && !(e[DIR_Attr] & AM_VOL) && memcmp(e + DIR_Name, sfn, 11) == 0)
+		{
+			*found = d;
+			return FR_OK;
+		}
+		res = dir_next(fs, &d, stretch && !*have_free);
+		if (res != FR_OK)
+			return res;
+	}
+}
+
+
+/**
+ * @brief Registers (fs) or unregisters (NULL) the file system object of a drive.
+ * @param opt 1: mount now, 0: on the first access
+ */
+FRESULT f_mount(FATFS *fs, const char *path, BYTE opt)
+{
+	const char *rp = path;
+	int         vol = get_ldnumber(&rp);
+
+	if (vol < 0)
+		return FR_INVALID_DRIVE;
+	if (FatFs[vol])
+		FatFs[vol]->fs_type = 0;
+	if (fs)
+		fs->fs_type = 0;
+	FatFs[vol] = fs;
+	if (!fs || opt != 1)
+		return FR_OK;
+	return find_volume(&path, &fs, 0);
+}
+
+
+/**
+ * @brief Opens a file in the root directory: an existing one (FA_OPEN_EXISTING) or a
+ * new one (FA_CREATE_NEW, FR_EXIST if the name is taken).
+ */
+FRESULT f_open(FIL *fp, const char *path, BYTE mode)
+{
+	FATFS  *fs;
+	BYTE    sfn[11];
+	BYTE   *e;
+	DIRPOS  d, fr;
+	DWORD   tm;
+	FRESULT res;
+	int     have_free;
+
+	if (!fp)
+		return FR_INVALID_OBJECT;
+	fp->obj.fs = NULL;
+	if (mode & (FA_CREATE_ALWAYS | FA_OPEN_ALWAYS))
+		return FR_INVALID_PARAMETER;
+	mode &= FA_READ | FA_WRITE | FA_CREATE_NEW;
+
+	res = find_volume(&path, &fs, (BYTE)(mode & ~FA_READ));
+	if (res == FR_OK)
+		res = make_sfn(path, sfn);
+	if (res == FR_OK)
+		res = dir_find(fs, sfn, &d, &fr, &have_free, mode & FA_CREATE_NEW);
+
+	if (mode & FA_CREATE_NEW)
+	{
+		if (res == FR_OK)
+			return FR_EXIST;
+		if (res != FR_NO_FILE)
+			return res;
+		if (!have_free)
+			return FR_DENIED;                   // FAT16 root directory full
+		res = move_window(fs, fr.sect);
+		if (res != FR_OK)
+			return res;
+		d = fr;
+		e = fs->win + (d.index % DIR_PER_SECT) * SZDIRE;
+		memset(e, 0, SZDIRE);
+		memcpy(e + DIR_Name, sfn, 11);
+		e[DIR_Attr] = AM_ARC;
+		tm = get_fattime();
+		st_dword(e + DIR_CrtTime, tm);
+		st_dword(e + DIR_ModTime, tm);
+		st_word (e + DIR_LstAccDate, (WORD)(tm >> 16));
+		fs->wflag = 1;
+		mode |= FA_MODIFIED;
+	}
+	else
+	{
+		if (res != FR_OK)
+			return res;
+		e = fs->win + (d.index % DIR_PER_SECT) * SZDIRE;
+		if (e[DIR_Attr] & AM_DIR)
+			return FR_NO_FILE;
+		if ((mode & FA_WRITE) && (e[DIR_Attr] & AM_RDO))
+			return FR_DENIED;
+	}
+
+	fp->obj.sclust  = ld_word(e + DIR_FstClusLO);
+	if (fs->fs_type == FS_FAT32)
+		fp->obj.sclust |= (DWORD)ld_word(e + DIR_FstClusHI) << 16;
+	fp->obj.objsize = ld_dword(e + DIR_FileSize);
+	fp->obj.attr    = e[DIR_Attr];
+	fp->dir_sect    = d.sect;
+	fp->dir_ofs     = (d.index % DIR_PER_SECT) * SZDIRE;
+	fp->flag        = mode & (FA_READ | FA_WRITE | FA_MODIFIED);
+	fp->err         = 0;
+	fp->fptr        = 0;
+	fp->clust       = 0;
+	fp->sect        = 0;
+	fp->obj.fs      = fs;
+	fp->obj.id      = fs->id;
+	return FR_OK;
+}
+
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+	FATFS  *fs;
+	BYTE   *rbuff = buff;
+	DWORD   clst, sect;
+	UINT    rcnt, cc, csect;
+	FRESULT res;
+
+	*br = 0;
+	res = validate(fp, &fs);
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK)
+		return res;
+	if (!(fp->flag & FA_READ))
+		return FR_DENIED;
+	if (btr > fp->obj.objsize - fp->fptr)
+		btr = (UINT)(fp->obj.objsize - fp->fptr);
+
+	while (btr)
+	{
+		rcnt = 0;
+		if (fp->fptr % SS == 0)
+		{
+			csect = (UINT)(fp->fptr / SS) & (fs->csize - 1);
+			if (csect == 0)
+			{
+				clst = (fp->fptr == 0 ? fp->obj.sclust : get_fat(fs, fp->clust));
+				if (clst == 0xFFFFFFFF)
+					ABORT(fp, FR_DISK_ERR);
+				if (clst < 2 || clst >= fs->n_fatent)
+					ABORT(fp, FR_INT_ERR);      // chain shorter than the file
+				fp->clust = clst;
+			}
+			sect = clust2sect(fs, fp->clust) + csect;
+			cc = btr / SS;
+			if (cc)
+			{
+				if (csect + cc > fs->csize)
+					cc = fs->csize - csect;
+				if (disk_read(fs->drv, rbuff, sect, cc) != RES_OK)
+					ABORT(fp, FR_DISK_ERR);
+				if ((fp->flag & FA_DIRTY) && fp->sect - sect < cc)
+					memcpy(rbuff + (fp->sect - sect) * SS, fp->buf, SS);
+				rcnt = SS * cc;
+			}
+			else if (fp->sect != sect)
+			{
+				if ((fp->flag & FA_DIRTY) && disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK)
+					ABORT(fp, FR_DISK_ERR);
+				fp->flag &= (BYTE)~FA_DIRTY;
+				if (disk_read(fs->drv, fp->buf, sect, 1) != RES_OK)
+					ABORT(fp, FR_DISK_ERR);
+				fp->sect = sect;
+			}
+		}
+		if (!rcnt)
+		{
+			rcnt = SS - (UINT)(fp->fptr % SS);
+			if (rcnt > btr)
+				rcnt = btr;
+			memcpy(rbuff, fp->buf + fp->fptr % SS, rcnt);
+		}
+		rbuff    += rcnt;
+		fp->fptr += rcnt;
+		*br      += rcnt;
+		btr      -= rcnt;
+	}
+	return FR_OK;
+}
+
+
+/**
+ * @brief Writes at the file pointer. Whole sectors go from buff to the disk directly,
+ * up to the end of the cluster per disk_write(). A full disk ends the write early with
+ * FR_OK and *bw < btw, as FatFs does.
+ */
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw)
+{
+	FATFS      *fs;
+	const BYTE *wbuff = buff;
+	DWORD       clst, sect;
+	UINT        wcnt, cc, csect;
+	FRESULT     res;
+
+	*bw = 0;
+	res = validate(fp, &fs);
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK)
+		return res;
+	if (!(fp->flag & FA_WRITE))
+		return FR_DENIED;
+	if ((DWORD)(fp->fptr + btw) < fp->fptr)
+		btw = (UINT)(0xFFFFFFFF - fp->fptr);    // 4 GB file size limit
+
+	while (btw)
+	{
+		wcnt = 0;
+		if (fp->fptr % SS == 0)
+		{
+			csect = (UINT)(fp->fptr / SS) & (fs->csize - 1);
+			if (csect == 0)
+			{
+				if (fp->fptr == 0)
+				{
+					clst = fp->obj.sclust;
+					if (clst == 0)
+						clst = create_chain(fs, 0);
+				}
+				else
+					clst = create_chain(fs, fp->clust);
+				if (clst == 0)
+					break;                      // disk full
+				if (clst == 1)
+					ABORT(fp, FR_INT_ERR);
+				if (clst == 0xFFFFFFFF)
+					ABORT(fp, FR_DISK_ERR);
+				fp->clust = clst;
+				if (fp->obj.sclust == 0)
+					fp->obj.sclust = clst;
+			}
+			if (fp->flag & FA_DIRTY)
+			{
+				if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK)
+					ABORT(fp, FR_DISK_ERR);
+				fp->flag &= (BYTE)~FA_DIRTY;
+			}
+			sect = clust2sect(fs, fp->clust) + csect;
+			cc = btw / SS;
+			if (cc)
+			{
+				if (csect + cc > fs->csize)
+					cc = fs->csize - csect;
+				if (disk_write(fs->drv, wbuff, sect, cc) != RES_OK)
+					ABORT(fp, FR_DISK_ERR);
+				if (fp->sect - sect < cc)       // the buffered sector was overwritten
+					memcpy(fp->buf, wbuff + (fp->sect - sect) * SS, SS);
+				wcnt = SS * cc;
+			}
+			else
+			{
+				if (fp->sect != sect && fp->fptr < fp->obj.objsize &&
+				    disk_read(fs->drv, fp->buf, sect, 1) != RES_OK)
+					ABORT(fp, FR_DISK_ERR);     // partly overwrites existing data
+				fp->sect = sect;
+			}
+		}
+		if (!wcnt)
+		{
+			wcnt = SS - (UINT)(fp->fptr % SS);
+			if (wcnt > btw)
+				wcnt = btw;
+			memcpy(fp->buf + fp->fptr % SS, wbuff, wcnt);
+			fp->flag |= FA_DIRTY;
+		}
+		wbuff    += wcnt;
+		fp->fptr += wcnt;
+		*bw      += wcnt;
+		btw      -= wcnt;
+		if (fp->fptr > fp->obj.objsize)
+			fp->obj.objsize = fp->fptr;
+	}
+	fp->flag |= FA_MODIFIED;
+	return FR_OK;
+}
+
+
+/**
+ * @brief Writes the buffered sector, the directory entry (size, first cluster, time),
+ * the FAT and the FSInfo: after it the file survives a power cut or a pulled stick.
+ */
+FRESULT f_sync(FIL *fp)
+{
+	FATFS  *fs;
+	BYTE   *e;
+	FRESULT res;
+
+	res = validate(fp, &fs);
+	if (res != FR_OK || !(fp->flag & FA_MODIFIED))
+		return res;
+	if (fp->flag & FA_DIRTY)
+	{
+		if (disk_write(fs->drv, fp->buf, fp->sect, 1) != RES_OK)
+			return FR_DISK_ERR;
+		fp->flag &= (BYTE)~FA_DIRTY;
+	}
+	res = move_window(fs, fp->dir_sect);
+	if (res != FR_OK)
+		return res;
+	e = fs->win + fp->dir_ofs;
+	e[DIR_Attr] |= AM_ARC;
+	st_word (e + DIR_FstClusLO, (WORD)fp->obj.sclust);
+	if (fs->fs_type == FS_FAT32)
+		st_word(e + DIR_FstClusHI, (WORD)(fp->obj.sclust >> 16));
+	st_dword(e + DIR_FileSize, fp->obj.objsize);
+	st_dword(e + DIR_ModTime, get_fattime());
+	st_word (e + DIR_LstAccDate, 0);
+	fs->wflag = 1;
+	res = sync_fs(fs);
+	fp->flag &= (BYTE)~FA_MODIFIED;
+	return res;
+}
+
+
+FRESULT f_close(FIL *fp)
+{
+	FRESULT res = f_sync(fp);
+
+	if (res == FR_OK)
+		fp->obj.fs = NULL;
+	return res;
+}
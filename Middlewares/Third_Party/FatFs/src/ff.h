@@ -0,0 +1,130 @@
+/*
+ * ff.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * FAT file system, the part of the FatFs API (ChaN, names and semantics of R0.12) the
+ * logger uses: f_mount, f_open, f_read, f_write, f_sync, f_close. Compact on purpose:
+ * FAT16 and FAT32 with 512-byte sectors, 8.3 names in the root directory, no long file
+ * names, no subdirectories, not reentrant (see ffconf.h). A stick formatted by any OS
+ * mounts; FAT12 (media under 2 MB) and exFAT (over 32 GB) are refused with
+ * FR_NO_FILESYSTEM. Generating the project with FATFS in CubeMX puts the complete
+ * FatFs in its place without changes to the callers.
+ */
+
+#ifndef _FATFS
+#define _FATFS 1
+
+#include "integer.h"
+#include "ffconf.h"
+
+typedef DWORD FSIZE_t;
+
+/// File system object, one per logical drive (f_mount)
+typedef struct
+{
+	BYTE  fs_type;     // FS_FAT16, FS_FAT32, 0: not mounted
+	BYTE  drv;         // physical drive
+	BYTE  n_fats;      // 1 or 2
+	BYTE  wflag;       // win[] dirty
+	BYTE  fsi_flag;    // FSInfo dirty (FAT32)
+	WORD  id;          // mount id, invalidates the file objects of an earlier mount
+	WORD  n_rootdir;   // root directory entries (FAT16)
+	WORD  csize;       // sectors per cluster
+	DWORD last_clst;   // last allocated cluster
+	DWORD free_clst;   // free clusters, 0xFFFFFFFF: unknown
+	DWORD n_fatent;    // clusters + 2
+	DWORD fsize;       // sectors per FAT
+	DWORD volbase;     // volume boot sector
+	DWORD fsi_sect;    // FSInfo sector (FAT32)
+	DWORD fatbase;     // first FAT sector
+	DWORD dirbase;     // root directory: sector (FAT16), cluster (FAT32)
+	DWORD database;    // first sector of cluster 2
+	DWORD winsect;     // sector in win[]
+	BYTE  win[_MAX_SS] __attribute__((aligned(4))); // FAT and directory sectors
+} FATFS;
+
+#define FS_FAT12  1
+#define FS_FAT16  2
+#define FS_FAT32  3
+
+typedef struct
+{
+	FATFS  *fs;
+	WORD    id;        // fs->id at f_open
+	BYTE    attr;
+	DWORD   sclust;    // first cluster, 0 if empty
+	FSIZE_t objsize;
+} _FDID;
+
+/// File object (f_open)
+typedef struct
+{
+	_FDID   obj;
+	BYTE    flag;      // FA_READ, FA_WRITE, FA_MODIFIED, FA_DIRTY
+	BYTE    err;       // an earlier error aborts every further call
+	FSIZE_t fptr;
+	DWORD   clust;     // cluster of fptr (of fptr - 1 on a cluster boundary)
+	DWORD   sect;      // sector in buf[]
+	DWORD   dir_sect;  // sector of the directory entry
+	UINT    dir_ofs;   // offset of the directory entry in that sector
+	BYTE    buf[_MAX_SS] __attribute__((aligned(4))); // partial sector
+} FIL;
+
+typedef enum
+{
+	FR_OK = 0,
+	FR_DISK_ERR,
+	FR_INT_ERR,
+	FR_NOT_READY,
+	FR_NO_FILE,
+	FR_NO_PATH,
+	FR_INVALID_NAME,
+	FR_DENIED,
+	FR_EXIST,
+	FR_INVALID_OBJECT,
+	FR_WRITE_PROTECTED,
+	FR_INVALID_DRIVE,
+	FR_NOT_ENABLED,
+	FR_NO_FILESYSTEM,
+	FR_MKFS_ABORTED,
+	FR_TIMEOUT,
+	FR_LOCKED,
+	FR_NOT_ENOUGH_CORE,
+	FR_TOO_MANY_OPEN_FILES,
+	FR_INVALID_PARAMETER
+} FRESULT;
+
+/// f_open() modes; FA_OPEN_EXISTING and FA_CREATE_NEW are supported
+#define FA_READ           0x01
+#define FA_WRITE          0x02
+#define FA_OPEN_EXISTING  0x00
+#define FA_CREATE_NEW     0x04
+#define FA_CREATE_ALWAYS  0x08
+#define FA_OPEN_ALWAYS    0x10
+#define FA_OPEN_APPEND    0x30
+
+/// directory entry attributes
+#define AM_RDO  0x01
+#define AM_HID  0x02
+#define AM_SYS  0x04
+#define AM_VOL  0x08
+#define AM_LFN  0x0F
+#define AM_DIR  0x10
+#define AM_ARC  0x20
+
+FRESULT f_mount(FATFS *fs, const char *path, BYTE opt);
+FRESULT f_open (FIL *fp, const char *path, BYTE mode);
+FRESULT f_read (FIL *fp, void *buff, UINT btr, UINT *br);
+FRESULT f_write(FIL *fp, const void *buff, UINT btw, UINT *bw);
+FRESULT f_sync (FIL *fp);
+FRESULT f_close(FIL *fp);
+
+/// Time stamp of the directory entries, provided by the application (fatfs.c)
+DWORD   get_fattime(void);
+
+#define f_size(fp)  ((fp)->obj.objsize)
+#define f_tell(fp)  ((fp)->fptr)
+
+#endif /* _FATFS */
@@ -0,0 +1,65 @@
+/*
+ * ff_gen_drv.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Driver table of FatFs, see ff_gen_drv.h.
+ */
+
+#include "ff_gen_drv.h"
+
+Disk_drvTypeDef disk = { { 0 }, { 0 }, { 0 }, 0 };
+
+
+/**
+ * @brief Links a diskio driver to the next free drive.
+ * @param path Receives the drive path, "n:/" (4 chars)
+ * @param lun LUN the driver gets with every call
+ * @return 0 on success, 1 if all _VOLUMES drives are taken
+ */
+uint8_t FATFS_LinkDriverEx(const Diskio_drvTypeDef *drv, char *path, BYTE lun)
+{
+	uint8_t n = disk.nbr;
+
+	if (n >= _VOLUMES)
+		return 1;
+	disk.is_initialized[n] = 0;
+	disk.drv[n]            = drv;
+	disk.lun[n]            = lun;
+	disk.nbr++;
+	path[0] = (char)('0' + n);
+	path[1] = ':';
+	path[2] = '/';
+	path[3] = 0;
+	return 0;
+}
+
+
+uint8_t FATFS_LinkDriver(const Diskio_drvTypeDef *drv, char *path)
+{
+	return FATFS_LinkDriverEx(drv, path, 0);
+}
+
+
+/**
+ * @brief Unlinks the driver of the last drive (path "n:/").
+ * @return 0 on success, 1 if the drive has no driver
+ */
+uint8_t FATFS_UnLinkDriver(char *path)
+{
+	uint8_t n = (uint8_t)(path[0] - '0');
+
+	if (disk.nbr == 0 || n != disk.nbr - 1)
+		return 1;
+	disk.drv[n] = 0;
+	disk.lun[n] = 0;
+	disk.nbr--;
+	return 0;
+}
+
+
+uint8_t FATFS_GetAttachedDriversNbr(void)
+{
+	return disk.nbr;
+}
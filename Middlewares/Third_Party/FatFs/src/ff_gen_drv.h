@@ -0,0 +1,39 @@
+/*
+ * ff_gen_drv.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Driver table of FatFs, with the names CubeMX uses: a diskio driver is linked to the
+ * next logical drive and gets its path ("0:/") back.
+ */
+
+#ifndef __FF_GEN_DRV_H
+#define __FF_GEN_DRV_H
+
+#include "diskio.h"
+#include "ff.h"
+
+typedef struct
+{
+	DSTATUS (*disk_initialize)(BYTE lun);
+	DSTATUS (*disk_status)    (BYTE lun);
+	DRESULT (*disk_read)      (BYTE lun, BYTE *buff, DWORD sector, UINT count);
+	DRESULT (*disk_write)     (BYTE lun, const BYTE *buff, DWORD sector, UINT count);
+	DRESULT (*disk_ioctl)     (BYTE lun, BYTE cmd, void *buff);
+} Diskio_drvTypeDef;
+
+typedef struct
+{
+	uint8_t                  is_initialized[_VOLUMES];
+	const Diskio_drvTypeDef *drv[_VOLUMES];
+	uint8_t                  lun[_VOLUMES];
+	volatile uint8_t         nbr;
+} Disk_drvTypeDef;
+
+uint8_t FATFS_LinkDriver(const Diskio_drvTypeDef *drv, char *path);
+uint8_t FATFS_LinkDriverEx(const Diskio_drvTypeDef *drv, char *path, BYTE lun);
+uint8_t FATFS_UnLinkDriver(char *path);
+uint8_t FATFS_GetAttachedDriversNbr(void);
+
+#endif /* __FF_GEN_DRV_H */
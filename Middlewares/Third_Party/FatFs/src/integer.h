@@ -0,0 +1,24 @@
+/*
+ * integer.h
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Integer types of the FatFs API (ff.h, diskio.h).
+ */
+
+#ifndef _FF_INTEGER
+#define _FF_INTEGER
+
+#include <stdint.h>
+
+typedef int      INT;
+typedef unsigned UINT;
+typedef uint8_t  BYTE;
+typedef int16_t  SHORT;
+typedef uint16_t WORD;
+typedef uint16_t WCHAR;
+typedef int32_t  LONG;
+typedef uint32_t DWORD;
+
+#endif /* _FF_INTEGER */
@@ -0,0 +1,81 @@
+/*
+ * fixfmt_bench.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Host benchmark of Core/MyApp/App/fixfmt.c against snprintf, on the numbers the GPS
+ * paths print: coordinates at 6 decimals, errors in m at 3 and LCD values at 2. Only
+ * the ratio carries over to the target, and there both sides use soft-float double.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "fixfmt.h"
+
+#define FIXFMT_BENCH_VALUES 4096
+#define FIXFMT_BENCH_ROUNDS 200
+
+static double values[FIXFMT_BENCH_VALUES];
+static volatile char sink;
+
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+
+/**
+ * @brief ns per call of fmt_double (fixfmt != 0) or snprintf.
+ */
+static double run(int decimals, int fixfmt)
+{
+	char   buf[64];
+	double t0;
+	int    r, i;
+
+	t0 = now_ns();
+	for (r = 0; r < FIXFMT_BENCH_ROUNDS; r++)
+		for (i = 0; i < FIXFMT_BENCH_VALUES; i++)
+		{
+			if (fixfmt)
+				fmt_double(buf, values[i], decimals, FIXFMT_PLUS);
+			else
+				snprintf(buf, sizeof(buf), "%+.*f", decimals, values[i]);
+			sink = buf[1];
+		}
+	return (now_ns() - t0) / ((double)FIXFMT_BENCH_ROUNDS * FIXFMT_BENCH_VALUES);
+}
+
+
+static void bench(const char *what, double base, double spread, int decimals)
+{
+	double t_fix, t_printf;
+	int    i;
+
+	srand(1);
+	for (i = 0; i < FIXFMT_BENCH_VALUES; i++)
+		values[i] = base + spread * (rand() / (double)RAND_MAX - 0.5);
+
+	run(decimals, 1); // warm-up
+	t_printf = run(decimals, 0);
+	t_fix    = run(decimals, 1);
+	printf("%-24s %d dec: snprintf %7.1f ns, fixfmt %6.1f ns, %5.1fx\n",
+	       what, decimals, t_printf, t_fix, t_printf / t_fix);
+}
+
+
+int main(void)
+{
+	bench("latitude (deg)",   52.236455, 1e-4, 6);
+	bench("longitude (deg)",   5.168583, 1e-4, 6);
+	bench("error (m)",         0.0,      6.0,  3);
+	bench("LCD error (m)",     0.0,      6.0,  2);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/*
+ * fixfmt_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Round-trip test of Core/MyApp/App/fixfmt.c against the printf of the host C library:
+ * every case is formatted by fmt_double/fmt_float and by snprintf("%.*f") and the texts
+ * must be equal. Cases, each at 0..FIXFMT_MAXDEC decimals, both signs:
+ *  - near ties: k + 0.5 units of the last decimal, and 1..FIXFMT_TEST_ULPS ulps either
+ *    side, the values where a rounded product picks the wrong digit
+ *  - random doubles with a random exponent, and the integer and carry edges
+ *  - floats: every FIXFMT_TEST_STRIDE-th bit pattern below 2^32
+ * glibc printf rounds the exact binary value half to even, which is what fixfmt does.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fixfmt.h"
+
+#define FIXFMT_TEST_TIES    200000   // near-tie centres per number of decimals
+#define FIXFMT_TEST_ULPS    2
+#define FIXFMT_TEST_RANDOM  300000   // random doubles per number of decimals
+#define FIXFMT_TEST_STRIDE  4099     // float bit patterns
+
+static uint64_t cases, mismatches;
+
+
+/**
+ * @brief xorshift64*, so every run tests the same values.
+ */
+static uint64_t rnd(void)
+{
+	static uint64_t x = 0x9E3779B97F4A7C15ULL;
+
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	return x * 0x2545F4914F6CDD1DULL;
+}
+
+
+static void compare(double v, int decimals, int is_float)
+{
+	char want[400], got[FIXFMT_MAXLEN + 8];
+	int  flags = (rnd() & 1 ? FIXFMT_PLUS : 0);
+
+	if (!(fabs(v) < 4294967295.0)) // fixfmt writes "ovf" there
+		return;
+
+	snprintf(want, sizeof(want), (flags & FIXFMT_PLUS ? "%+.*f" : "%.*f"), decimals, v);
+	if (is_float)
+		fmt_float(got, (float)v, decimals, flags);
+	else
+		fmt_double(got, v, decimals, flags);
+
+	cases++;
+	if (strcmp(want, got))
+	{
+		if (mismatches++ < 20)
+			fprintf(stderr, "FAIL: %s %.17g at %d decimals: printf \"%s\", fixfmt \"%s\"\n",
+			        (is_float ? "float" : "double"), v, decimals, want, got);
+	}
+}
+
+
+static void near_ties(int decimals)
+{
+	double   unit = 1.0 / pow(10.0, decimals), v, u;
+	uint64_t k;
+	int      i, j;
+
+	for (i = 0; i < FIXFMT_TEST_TIES; i++)
+	{
+		// small integer parts most of the time, where the fraction has the most bits
+		k = rnd() % (i & 1 ? 1000 : 4000000000ULL / (uint64_t)pow(10.0, 9 - decimals) + 1);
+		v = (k + 0.5) * unit;
+		if (rnd() & 1)
+			v = -v;
+		compare(v, decimals, 0);
+		for (j = 1, u = v; j <= FIXFMT_TEST_ULPS; j++)
+		{
+			u = nextafter(u, INFINITY);
+			compare(u, decimals, 0);
+		}
+		for (j = 1, u = v; j <= FIXFMT_TEST_ULPS; j++)
+		{
+			u = nextafter(u, -INFINITY);
+			compare(u, decimals, 0);
+		}
+	}
+}
+
+
+static void random_doubles(int decimals)
+{
+	static const double edges[] = { 0.0, -0.0, 0.5, 1.5, 2.5, 0.05, 0.075, 9.9999999995, 99.5,
+	                                0.125, 1e-30, 1e-300, 4.9e-324, 4294967294.5, 4294967294.9999995 };
+	double   v;
+	uint64_t bits;
+	int      i;
+
+	for (i = 0; i < (int)(sizeof(edges) / sizeof(edges[0])); i++)
+	{
+		compare(edges[i], decimals, 0);
+		compare(-edges[i], decimals, 0);
+	}
+
+	for (i = 0; i < FIXFMT_TEST_RANDOM; i++)
+	{
+		// exponent -40..31, random mantissa
+		bits = (rnd() & 0x800FFFFFFFFFFFFFULL) | ((uint64_t)(1023 - 40 + rnd() % 72) << 52);
+		memcpy(&v, &bits, sizeof(v));
+		compare(v, decimals, 0);
+	}
+}
+
+
+static void floats(void)
+{
+	uint64_t bits;
+	float    f;
+	int      decimals;
+
+	for (bits = 0; bits < 0x100000000ULL; bits += FIXFMT_TEST_STRIDE)
+	{
+		uint32_t b = (uint32_t)bits;
+
+		memcpy(&f, &b, sizeof(f));
+		if (isnan(f))
+			continue;
+		decimals = (int)(rnd() % (FIXFMT_MAXDEC + 1));
+		compare(f, decimals, 1);
+	}
+}
+
+
+int main(void)
+{
+	int decimals;
+
+	for (decimals = 0; decimals <= FIXFMT_MAXDEC; decimals++)
+	{
+		near_ties(decimals);
+		random_doubles(decimals);
+	}
+	floats();
+
+	printf("fixfmt: %llu cases, %llu differ from printf\n",
+	       (unsigned long long)cases, (unsigned long long)mismatches);
+	return (mismatches ? EXIT_FAILURE : EXIT_SUCCESS);
+}
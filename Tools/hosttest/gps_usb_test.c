@@ -0,0 +1,269 @@
+/*
+ * gps_usb_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Host test of the NMEA framer of Core/MyApp/App/gps.c with its two sources, on the
+ * FreeRTOS stand-ins of stub/admin.h. A receiver stream (gps_stream.nmea: 2 minutes
+ * in the format of a u-blox M8, with GSV/GLL/TXT/PUBX sentences, UBX binary, a cut-off
+ * sentence, one over the NMEA length limit and a truncated tag) is fed:
+ *  - to GPS_rx_byte_ISR() byte by byte, as the UART4 interrupt does
+ *  - to GPS_rx_bytes() in CDC transfers of GPS_USB_RXBUF bytes, and in short packets
+ *  - to both, switching UART4 -> USB -> UART4 with GPS_rx_select() in mid-sentence
+ *    of either source, while UART4 keeps receiving
+ * The sentences put on hGPS_MsgBuf must be exactly those a plain scan of the stream
+ * finds: '$' up to CR, no '$' in between, a tag in the NMEA schema, within GPS_MAXLEN;
+ * a sentence a source switch cuts in two is lost from both sources. Also checked: the
+ * message buffer is only written in an interrupt or a critical section, and every byte
+ * of the active source (and none of the ignored one) reaches LOG_raw().
+ */
+
+#include <admin.h>
+#include <stdlib.h>
+#include "gps.h"
+#include "NMEA.h"
+#include "GPS_usb.h"
+#include "GPS_bus.h"
+#include "telemetry.h"
+#include "supervisor.h"
+#include "ledstatus.h"
+#include "logger.h"
+
+#define GPS_USB_TEST_MAXSENT 8192   // sentences per run
+
+uint32_t host_ms;
+int      host_isr, host_masked, host_kicks;
+FILE    *host_uart;
+int      Uart_debug_out;
+MessageBufferHandle_t hGPS_MsgBuf;
+
+typedef struct
+{
+	uint32_t n;
+	uint32_t off[GPS_USB_TEST_MAXSENT]; // sentence in the stream (expected) or the copy (received)
+	uint8_t  len[GPS_USB_TEST_MAXSENT];
+} SENTENCES;
+
+static uint8_t  *stream;        // the recording
+static uint32_t  stream_len;
+static char      got_text[GPS_USB_TEST_MAXSENT * GPS_MAXLEN];
+static uint32_t  got_pos;
+static SENTENCES got, want;
+static uint32_t  logged[2];     // bytes through LOG_raw(), per LOG_RAW_UART/LOG_RAW_USB
+static int       errors;
+
+
+static void fail(const char *what, uint32_t v)
+{
+	fprintf(stderr, "FAIL: %s (%u)\n", what, v);
+	errors++;
+}
+
+
+// stand-ins of the modules gps.c calls
+size_t xMessageBufferSendFromISR(MessageBufferHandle_t h, const void *data, size_t len, BaseType_t *woken)
+{
+	if (!host_isr && !host_masked)
+		fail("message buffer written outside an interrupt or critical section", (uint32_t)len);
+	if (got.n == GPS_USB_TEST_MAXSENT || len >= GPS_MAXLEN)
+	{
+		fail("sentence does not fit", (uint32_t)len);
+		return 0;
+	}
+	memcpy(&got_text[got_pos], data, len);
+	got.off[got.n] = got_pos;
+	got.len[got.n] = (uint8_t)len;
+	got.n++;
+	got_pos += len;
+	return len;
+}
+
+size_t xMessageBufferReceive(MessageBufferHandle_t h, void *data, size_t len, TickType_t wait) { return 0; }
+void     LOG_raw(LOG_TYPE type, const uint8_t *data, uint32_t n) { logged[type == LOG_RAW_USB] += n; }
+void     LEDSTAT_fix(int valid)                                 { }
+uint32_t tlm_stamp(void)                                        { return 0; }
+void     tlm_fix(const GPS_FIX *fix)                            { }
+uint32_t GPS_bus_publish(const GPS_FIX *fix)                    { return 0; }
+void     SUP_alive(SUP_ID id)                                   { }
+void     GPS_usb_report(void)                                   { }
+
+
+/**
+ * @brief The reference: the wanted sentences that start in [start, end) and end (CR) before end.
+ */
+static void scan(uint32_t start, uint32_t end, SENTENCES *s)
+{
+	uint32_t i = start, j;
+
+	while (i < end)
+	{
+		if (stream[i] != '$')
+		{
+			i++;
+			continue;
+		}
+		for (j = i + 1; j < end && stream[j] != '\r' && stream[j] != '$'; j++)
+			;
+		if (j < end && stream[j] == '\r' && j - i >= 6 && j - i <= GPS_MAXLEN - 2 &&
+		    NMEA_lookup((const char *)&stream[i]) != eNMEA_NONE)
+		{
+			s->off[s->n] = i;
+			s->len[s->n] = (uint8_t)(j - i);
+			s->n++;
+		}
+		i = j;
+	}
+}
+
+
+static void uart4(uint32_t from, uint32_t to)
+{
+	BaseType_t woken = pdFALSE;
+
+	host_isr = TRUE;
+	for (; from < to; from++)
+		GPS_rx_byte_ISR((char)stream[from], &woken);
+	host_isr = FALSE;
+}
+
+
+/**
+ * @brief USB transfers: GPS_USB_RXBUF bytes if short is FALSE, else sizes from 1 byte
+ * to a full buffer, mostly below one 64-byte packet.
+ */
+static void usb(uint32_t from, uint32_t to, int shorts)
+{
+	static uint32_t lcg = 49;
+	uint32_t        n;
+
+	while (from < to)
+	{
+		n = GPS_USB_RXBUF;
+		if (shorts)
+		{
+			lcg = lcg * 1103515245 + 12345;
+			n   = 1 + (lcg >> 8) % ((lcg >> 4) & 3 ? 64 : GPS_USB_RXBUF);
+		}
+		if (n > to - from)
+			n = to - from;
+		GPS_rx_bytes(&stream[from], n);
+		from += n;
+	}
+}
+
+
+/**
+ * @brief Position of the n-th '$' of the stream plus skip: a point in mid-sentence.
+ */
+static uint32_t mid_sentence(uint32_t n, uint32_t skip)
+{
+	uint32_t i;
+
+	for (i = 0; i < stream_len; i++)
+		if (stream[i] == '$' && n-- == 0)
+			return i + skip;
+	return stream_len;
+}
+
+
+static void start(void)
+{
+	got.n = want.n = 0;
+	got_pos = 0;
+	logged[0] = logged[1] = 0;
+}
+
+
+static void compare(const char *name, uint32_t uart_bytes, uint32_t usb_bytes)
+{
+	uint32_t i, n = (got.n < want.n ? got.n : want.n);
+
+	for (i = 0; i < n; i++)
+		if (got.len[i] != want.len[i] || memcmp(&got_text[got.off[i]], &stream[want.off[i]], got.len[i]))
+		{
+			fprintf(stderr, "FAIL: %s: sentence %u is \"%.*s\", expected \"%.*s\"\n", name, i,
+			        got.len[i], &got_text[got.off[i]], want.len[i], (const char *)&stream[want.off[i]]);
+			errors++;
+			break;
+		}
+	if (got.n != want.n)
+		fprintf(stderr, "FAIL: %s: %u sentences, expected %u\n", name, got.n, want.n), errors++;
+	if (logged[0] != uart_bytes || logged[1] != usb_bytes)
+		fprintf(stderr, "FAIL: %s: logged %u UART4 + %u USB bytes, expected %u + %u\n", name,
+		        logged[0], logged[1], uart_bytes, usb_bytes), errors++;
+	if (host_masked)
+		fail("critical sections not balanced", host_masked);
+
+	printf("gps_usb: %-32s %5u sentences\n", name, got.n);
+}
+
+
+int main(int argc, char **argv)
+{
+	FILE    *f;
+	uint32_t x, y, z, w, step, u;
+
+	if (argc != 2 || !(f = fopen(argv[1], "rb")))
+	{
+		fprintf(stderr, "usage: gps_usb_test <recording.nmea>\n");
+		return 2;
+	}
+	fseek(f, 0, SEEK_END);
+	stream_len = (uint32_t)ftell(f);
+	rewind(f);
+	stream = malloc(stream_len);
+	if (!stream || fread(stream, 1, stream_len, f) != stream_len)
+		return 2;
+	fclose(f);
+
+	start();
+	GPS_rx_select(FALSE);
+	uart4(0, stream_len);
+	scan(0, stream_len, &want);
+	compare("UART4, byte by byte", stream_len, 0);
+
+	start();
+	GPS_rx_select(TRUE);
+	usb(0, stream_len, FALSE);
+	scan(0, stream_len, &want);
+	compare("USB, full transfers", 0, stream_len);
+
+	start();
+	GPS_rx_select(TRUE);
+	usb(0, stream_len, TRUE);
+	scan(0, stream_len, &want);
+	compare("USB, short packets", 0, stream_len);
+
+	// UART4 up to x, USB from y to z while UART4 runs on (ignored) to w, then UART4 again;
+	// every switch in mid-sentence of both sources
+	x = mid_sentence(300, 9);
+	y = mid_sentence(100, 17);
+	z = mid_sentence(700, 30);
+	w = mid_sentence(900, 5);
+	start();
+	GPS_rx_select(FALSE);
+	uart4(0, x);
+	GPS_rx_select(TRUE);
+	step = (w - x) / ((z - y) / GPS_USB_RXBUF + 1) + 1;
+	for (u = y; u < z; u += GPS_USB_RXBUF)
+	{
+		usb(u, (u + GPS_USB_RXBUF < z ? u + GPS_USB_RXBUF : z), FALSE);
+		uart4(x, (x + step < w ? x + step : w));
+		x = (x + step < w ? x + step : w);
+	}
+	uart4(x, w);
+	GPS_rx_select(FALSE);
+	uart4(w, stream_len);
+	x = mid_sentence(300, 9);
+	scan(0, x, &want);
+	scan(y, z, &want);
+	scan(w, stream_len, &want);
+	compare("UART4 -> USB -> UART4", x + (stream_len - w), z - y);
+
+	free(stream);
+	if (errors)
+		return 1;
+	printf("gps_usb: both sources give the sentences of the recording back\n");
+	return 0;
+}
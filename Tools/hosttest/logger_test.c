@@ -0,0 +1,277 @@
+/*
+ * logger_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Host test of Core/MyApp/App/logger.c with the RAM disk backend (logdisk_ram.c) and a
+ * stand-in USB stick, on the FreeRTOS stand-ins of stub/admin.h. Logger_task runs as
+ * is; every wait in ulTaskNotifyTake() lets LOGGER_TEST_EPOCHS_PER_POLL epochs of a
+ * known stream pass:
+ *  - an RMC and a GGA sentence per second, byte by byte from the "UART4 interrupt"
+ *  - every 10th second a USB transfer of LOGGER_TEST_USB bytes (longer than a record)
+ *  - a correction per second, every 7th one with a failed transmission
+ * The recording starts on the RAM disk; at epoch LOGGER_TEST_STICK_AT a stick is
+ * mounted and the rest must go to the stick. Then the recording is stopped and written
+ * to <dir>: rec.glg (the RAM disk blocks), dump.txt (a capture of LOG_dump(), as
+ * 'log dump' prints it), stick.glg (the stick blocks), and per part ram.nmea/ram.csv
+ * and stick.nmea/stick.csv (what Tools/log_replay.py --nmea / --corrections must give).
+ * The Makefile runs the replay on all three and compares.
+ *
+ * Checked here: every block header, consecutive seq, no drops, critical sections
+ * balanced.
+ */
+
+#include <admin.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include "logger.h"
+#include "logdisk.h"
+
+#define LOGGER_TEST_EPOCHS          120 // about 24 KB: the RAM disk (LOGDISK_RAM_BLOCKS) never wraps
+#define LOGGER_TEST_EPOCHS_PER_POLL 1   // one epoch per LOG_POLL_MS wait
+#define LOGGER_TEST_USB             300
+#define LOGGER_TEST_STICK_AT        60  // the stick is mounted before this epoch
+#define LOGGER_TEST_STICK_BLOCKS    64
+
+uint32_t host_ms = 10000;
+int      host_isr, host_masked, host_kicks;
+FILE    *host_uart;
+
+static jmp_buf stopped;
+static int     epoch, polls, errors;
+static FILE   *nmea, *csv;
+static FILE   *stick_nmea, *stick_csv;  // nmea and csv from LOGGER_TEST_STICK_AT on
+static int     stick_in, stick_open;
+static uint8_t stick[LOGGER_TEST_STICK_BLOCKS][LOG_BLOCK];
+static uint32_t stick_blocks;
+
+
+static void fail(const char *what, uint32_t v)
+{
+	fprintf(stderr, "FAIL: %s (%u)\n", what, v);
+	errors++;
+}
+
+
+/// the stand-in stick: one recording, kept in stick[]
+static int stick_start(void)
+{
+	if (!stick_in || stick_open || stick_blocks)
+		return FALSE;
+	stick_open = TRUE;
+	return TRUE;
+}
+
+
+static int stick_write(const uint8_t *block)
+{
+	if (!stick_open || stick_blocks >= LOGGER_TEST_STICK_BLOCKS)
+		return FALSE;
+	memcpy(stick[stick_blocks++], block, LOG_BLOCK);
+	return TRUE;
+}
+
+
+static void stick_close(void)
+{
+	stick_open = FALSE;
+}
+
+
+const LOG_DISK logdisk_fatfs = { "USB stick", LOGDISK_FATFS_FLUSH_MS, stick_start, stick_write, stick_close };
+
+
+int logdisk_fatfs_mounted(void)
+{
+	return stick_in;
+}
+
+
+static void uart4(const char *s)
+{
+	host_isr = TRUE;
+	for (; *s; s++)
+		LOG_raw(LOG_RAW_UART, (const uint8_t *)s, 1);
+	host_isr = FALSE;
+}
+
+
+/**
+ * @brief One second of the stream; also writes what the replay must give.
+ */
+static void one_epoch(void)
+{
+	char           line[128];
+	uint8_t        usb[LOGGER_TEST_USB];
+	NRF_CORRECTION c = { 0 };
+	uint8_t        status;
+	int            i;
+
+	host_ms += 1000;
+
+	snprintf(line, sizeof(line), "$GNRMC,%06d.00,A,5214.18%03d,N,00510.11%03d,E,0.0%d,,191026,,,A*00\r\n",
+	         epoch, epoch % 1000, (epoch * 7) % 1000, epoch % 10);
+	uart4(line);
+	fputs(line, nmea);
+	host_ms += 40;
+	snprintf(line, sizeof(line), "$GNGGA,%06d.00,5214.18%03d,N,00510.11%03d,E,1,%02d,0.9,12.%d,M,46.0,M,,*00\r\n",
+	         epoch, epoch % 1000, (epoch * 7) % 1000, 8 + epoch % 5, epoch % 10);
+	uart4(line);
+	fputs(line, nmea);
+
+	if (epoch % 10 == 0)
+	{
+		for (i = 0; i < LOGGER_TEST_USB; i++)
+			usb[i] = (i % 64 == 63 ? '\n' : 'a' + (epoch + i) % 26);
+		LOG_raw(LOG_RAW_USB, usb, sizeof(usb));
+		fwrite(usb, 1, sizeof(usb), nmea);
+	}
+
+	host_ms += 25;
+	c.version = NRF_PKT_VERSION;
+	c.flags   = NRF_FLAG_UP_VALID;
+	c.seq     = epoch;
+	c.time    = epoch * 1000;
+	c.err_e   = 1000 + epoch;   c.err_n  = -2000 - epoch; c.err_u = epoch * 3;
+	c.rate_e  = -epoch;         c.rate_n = epoch;         c.rate_u = 0;
+	c.sd_e    = 500;            c.sd_n   = 600;           c.sd_u   = 900;
+	status = (epoch % 7 == 0 ? 0x1e : 0);
+	LOG_correction(&c, status);
+	fprintf(csv, "%u,%u,%u,%u,%u,%d,%d,%d,%d,%d,%d,%u,%u,%u,%u\r\n", host_ms,
+	        c.version, c.flags, c.seq, c.time, c.err_e, c.err_n, c.err_u,
+	        c.rate_e, c.rate_n, c.rate_u, c.sd_e, c.sd_n, c.sd_u, status);
+
+	epoch++;
+}
+
+
+/**
+ * @brief The wait of Logger_task: the first one passes (the recording opens after
+ * it), then the stream runs, then the recording is stopped, then the test ends.
+ */
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+	int i;
+
+	(void)clear;
+	(void)wait;
+	if (host_masked)
+		fail("Logger_task waits inside a critical section", host_masked);
+
+	if (polls++ == 0)
+		return 0;
+	if (epoch == LOGGER_TEST_STICK_AT && !stick_in)
+	{
+		stick_in = TRUE; // Logger_task moves the recording in this pass
+		nmea     = stick_nmea;
+		csv      = stick_csv;
+		return 1;
+	}
+	if (epoch < LOGGER_TEST_EPOCHS)
+	{
+		for (i = 0; i < LOGGER_TEST_EPOCHS_PER_POLL && epoch < LOGGER_TEST_EPOCHS; i++)
+			one_epoch();
+		return 1;
+	}
+	if (LOG_running())
+	{
+		LOG_run(FALSE);
+		return 1;
+	}
+	longjmp(stopped, 1);
+}
+
+
+static FILE *open_out(const char *dir, const char *name, const char *mode)
+{
+	char  path[512];
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/%s", dir, name);
+	if (!(f = fopen(path, mode)))
+	{
+		perror(path);
+		exit(EXIT_FAILURE);
+	}
+	return f;
+}
+
+
+/**
+ * @brief Checks the blocks of one recording and writes them to <dir>/name.
+ * @return The number of blocks
+ */
+static uint32_t save_blocks(const char *dir, const char *name, const uint8_t *(*block_at)(uint32_t))
+{
+	const uint8_t       *block;
+	const LOG_BLOCK_HDR *hdr;
+	FILE                *rec;
+	uint32_t             i;
+
+	rec = open_out(dir, name, "wb");
+	for (i = 0; (block = block_at(i)); i++)
+	{
+		hdr = (const LOG_BLOCK_HDR *)block;
+		if (hdr->magic != LOG_MAGIC || hdr->version != LOG_VERSION || hdr->sectors != LOG_BLOCK / LOG_SECTOR)
+			fail("block header", i);
+		if (hdr->seq != i)
+			fail("block seq", hdr->seq);
+		if (hdr->used < sizeof(LOG_BLOCK_HDR) || hdr->used > LOG_BLOCK)
+			fail("block used", hdr->used);
+		fwrite(block, 1, LOG_BLOCK, rec);
+	}
+	fclose(rec);
+	return i;
+}
+
+
+static const uint8_t *stick_block(uint32_t i)
+{
+	return (i < stick_blocks ? stick[i] : NULL);
+}
+
+
+int main(int argc, char **argv)
+{
+	static const char csv_head[] = "ms,version,flags,seq,time,err_e,err_n,err_u,rate_e,rate_n,rate_u,sd_e,sd_n,sd_u,status\r\n";
+	const char *dir = (argc > 1 ? argv[1] : ".");
+	FILE       *ram_nmea, *ram_csv;
+	uint32_t    ram, on_stick;
+
+	nmea       = ram_nmea = open_out(dir, "ram.nmea", "wb");
+	csv        = ram_csv  = open_out(dir, "ram.csv", "wb");
+	stick_nmea = open_out(dir, "stick.nmea", "wb");
+	stick_csv  = open_out(dir, "stick.csv", "wb");
+	fputs(csv_head, ram_csv);
+	fputs(csv_head, stick_csv);
+
+	if (!setjmp(stopped))
+		Logger_task(NULL);
+	fclose(ram_nmea);
+	fclose(ram_csv);
+	fclose(stick_nmea);
+	fclose(stick_csv);
+
+	ram = save_blocks(dir, "rec.glg", logdisk_ram_block);
+	if (ram == 0 || ram >= LOGDISK_RAM_BLOCKS)
+		fail("blocks on the RAM disk, the part before the stick must fit", ram);
+	on_stick = save_blocks(dir, "stick.glg", stick_block);
+	if (on_stick == 0 || on_stick >= LOGGER_TEST_STICK_BLOCKS)
+		fail("blocks on the stick", on_stick);
+	if (stick_open)
+		fail("recording on the stick not closed", on_stick);
+
+	host_uart = open_out(dir, "dump.txt", "wb");
+	LOG_dump();
+	fclose(host_uart);
+	host_uart = NULL;
+
+	if (host_masked)
+		fail("critical sections not balanced", host_masked);
+	LOG_report();
+
+	printf("logger: %d epochs, %u blocks on the RAM disk, %u on the stick, %d notifications\n",
+	       epoch, ram, on_stick, host_kicks);
+	return (errors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
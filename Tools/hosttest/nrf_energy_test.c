@@ -0,0 +1,141 @@
+/*
+ * nrf_energy_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Host comparison of the nRF24L01+ energy per correction, duty-cycled (NRF_power.c)
+ * against the radio permanently in standby-I, from the model of NRF_energy.c. Each
+ * scenario replays the slot timeline of NRF_driver_task on a simulated ms clock:
+ *  - a predicted slot: wake NRF_WAKE_LEAD_MS ahead, transmit, back to power-down
+ *  - a missed slot: awake for the lead and NRF_SLOT_GUARD_MS, then power-down until
+ *    the next correction, which waits for Tpd2stby (2 ticks) before it is sent
+ *  - a failed correction costs all retransmits
+ * The model is checked against the same currents in floating point; duty cycling
+ * must win in every scenario.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "NRF_power.h"
+
+#define TX_MS 1   // radio awake for the SPI upload and the TX/ACK burst
+
+typedef struct
+{
+	const char *name;
+	uint32_t    period_ms;  // correction interval
+	uint32_t    n;          // slots
+	uint32_t    fail_every; // every n-th correction gets no ACK, 0: never
+	uint32_t    miss_every; // every n-th slot brings no correction, 0: never
+} SCENARIO;
+
+static const SCENARIO scenarios[] =
+{
+	{ "1 Hz",                     1000, 3600,  0,  0 },
+	{ "1 Hz, 1 in 7 unacked",     1000, 3600,  7,  0 },
+	{ "1 Hz, 1 in 10 missed",     1000, 3600,  0, 10 },
+	{ "5 Hz",                      200, 18000, 0,  0 },
+	{ "10 Hz",                     100, 36000, 0,  0 },
+};
+
+static int errors;
+
+
+/**
+ * @brief The same model in floating point, from the datasheet currents at 3.3 V.
+ */
+static double reference_nJ(const NRF_ACTIVITY *a, int duty)
+{
+	const double v = 3.3;
+	double tx_us   = 130 + 321, ack_us = 130 + 65;
+	double attempts = a->corrections + 3.0 * a->failures;
+	double tx = attempts * (v * 11.3e-3 * tx_us + v * 13.5e-3 * ack_us) * 1e3  // V * A * us = uJ
+			  + 3.0 * a->failures * v * 26e-6 * 250 * 1e3;
+	double total_ms = (double)(a->state_ms[eNRF_PWRDWN] + a->state_ms[eNRF_STANDBY]);
+
+	if (!duty)
+		return v * 26e-6 * total_ms * 1e6 + tx;
+	return v * 0.9e-6 * a->state_ms[eNRF_PWRDWN] * 1e6 + v * 26e-6 * a->state_ms[eNRF_STANDBY] * 1e6
+		 + a->wakeups * v * 0.4e-3 * NRF_TPD2STBY_US * 1e3 + tx;
+}
+
+
+static void check(const char *name, const char *what, double got, double want)
+{
+	if (got < want * 0.999 || got > want * 1.001)
+	{
+		fprintf(stderr, "FAIL: %s: %s %.0f nJ, expected %.0f nJ\n", name, what, got, want);
+		errors++;
+	}
+}
+
+
+static void run(const SCENARIO *s)
+{
+	NRF_ACTIVITY a;
+	NRF_ENERGY   e;
+	uint32_t     k, t, predicted = 0;
+	uint32_t     wake_ms = (NRF_TPD2STBY_US + 999) / 1000 + 1; // NRF_power_wake(): osDelay, +1 tick
+
+	NRF_activity_init(&a, eNRF_STANDBY, 0);
+	NRF_activity_state(&a, eNRF_PWRDWN, 0); // NRF_power_init()
+
+	for (k = 1; k <= s->n; k++)
+	{
+		t = k * s->period_ms;
+		if (s->miss_every && k % s->miss_every == 0)
+		{
+			if (predicted)
+			{
+				NRF_activity_state(&a, eNRF_STANDBY, t - NRF_WAKE_LEAD_MS);
+				NRF_activity_state(&a, eNRF_PWRDWN,  t + NRF_SLOT_GUARD_MS);
+			}
+			predicted = 0;
+			continue;
+		}
+		if (predicted)
+			NRF_activity_state(&a, eNRF_STANDBY, t - NRF_WAKE_LEAD_MS);
+		else
+		{
+			NRF_activity_state(&a, eNRF_STANDBY, t);
+			t += wake_ms;
+		}
+		NRF_activity_tx(&a, s->fail_every && a.corrections % s->fail_every == s->fail_every - 1);
+		NRF_activity_state(&a, eNRF_PWRDWN, t + TX_MS);
+		predicted = 1;
+	}
+	NRF_activity_state(&a, a.state, (s->n + 1) * s->period_ms - NRF_WAKE_LEAD_MS);
+
+	NRF_energy(&a, &e);
+	check(s->name, "duty-cycled",    e.duty_nJ,    reference_nJ(&a, 1));
+	check(s->name, "always standby", e.standby_nJ, reference_nJ(&a, 0));
+	if (e.duty_nJ >= e.standby_nJ)
+	{
+		fprintf(stderr, "FAIL: %s: duty cycling does not save energy\n", s->name);
+		errors++;
+	}
+
+	printf("%-22s %6u %6u %7u %8u %9u %9u %6.1f\n", s->name,
+		   a.corrections, a.failures, a.wakeups,
+		   (unsigned)(e.tx_nJ / a.corrections),
+		   (unsigned)(e.duty_nJ / a.corrections), (unsigned)(e.standby_nJ / a.corrections),
+		   (double)e.standby_nJ / e.duty_nJ);
+}
+
+
+int main(void)
+{
+	unsigned i;
+
+	printf("nRF24L01+ energy per correction (model of NRF_energy.c, nJ)\n");
+	printf("%-22s %6s %6s %7s %8s %9s %9s %6s\n", "scenario",
+		   "corr", "unack", "wakeups", "tx", "duty", "standby", "ratio");
+	for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+		run(&scenarios[i]);
+
+	if (errors)
+		return 1;
+	printf("nrf_energy: model matches the datasheet currents, duty cycling saves energy in every scenario\n");
+	return 0;
+}
@@ -0,0 +1,256 @@
+/*
+ * seqbuf_test.c
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Host stress test of Core/MyApp/App/seqbuf.c. Two kinds of pass:
+ *  - threads: one writer publishes in bursts until SEQBUF_TEST_READERS reader threads
+ *    together did SEQBUF_TEST_READS reads. On a multi-core host the copies overlap with
+ *    publications all the time; on a single core only on a scheduler tick.
+ *  - preemption: a reader is interrupted by a SIGALRM handler that publishes
+ *    SEQBUF_SLOTS values, like a higher-priority task on the target. This laps the slot
+ *    being copied on any host, so the retry path is always exercised.
+ * Checks:
+ *  - no torn read: all words of a copied value belong to the same publication
+ *  - the returned sequence number is the one the value was published with
+ *  - per reader, values never go back in time
+ *  - "changed since N": once seqbuf_changed(N) is TRUE, the next read is newer than N,
+ *    and after the writer has stopped it is TRUE exactly when N is not the last one
+ * Every pass is repeated just below the 32-bit wrap-around of the sequence number.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "seqbuf.h"
+
+#define SEQBUF_TEST_READERS 3
+#define SEQBUF_TEST_READS   500000UL
+#define SEQBUF_TEST_WORDS   4096         // 16 KB per value: a long copy
+#define SEQBUF_TEST_TICK_US 500          // preemption pass: SIGALRM interval
+
+typedef struct
+{
+	uint32_t seq;                        // sequence number it is published with
+	uint64_t n;                          // publication count of the writer
+	uint32_t w[SEQBUF_TEST_WORDS];       // all (uint32_t)n
+} TEST_VALUE;
+
+static TEST_VALUE        storage[SEQBUF_SLOTS];
+static SEQBUF            sb = SEQBUF_INIT(storage);
+static volatile int      writing;
+static volatile uint64_t reads_total;
+static volatile uint64_t writes;         // publications of the running pass
+static volatile uint64_t errors;
+
+
+static void fail(const char *what, uint32_t seq)
+{
+	fprintf(stderr, "FAIL: %s (seq %u)\n", what, seq);
+	__sync_fetch_and_add(&errors, 1);
+}
+
+
+/**
+ * @brief Publishes value n; the only producer of the container.
+ */
+static void publish(uint64_t n)
+{
+	uint32_t    seq = sb.seq + 1; // what seqbuf_commit() will return, see seqbuf_next()
+	TEST_VALUE *v;
+	int         i;
+
+	if (seq == 0)
+		seq = sb.seq % SEQBUF_SLOTS + 1;
+
+	v = seqbuf_begin(&sb);
+	v->seq = seq;
+	v->n   = n;
+	for (i = 0; i < SEQBUF_TEST_WORDS; i++)
+		v->w[i] = (uint32_t)n;
+	if (seqbuf_commit(&sb) != seq)
+		fail("commit returned another sequence number", seq);
+	writes = n;
+}
+
+
+static void check(const TEST_VALUE *v, uint32_t seq)
+{
+	int i;
+
+	if (v->seq != seq)
+		fail("value does not belong to the returned sequence number", seq);
+	for (i = 0; i < SEQBUF_TEST_WORDS; i++)
+		if (v->w[i] != (uint32_t)v->n)
+		{
+			fail("torn read", seq);
+			break;
+		}
+}
+
+
+/**
+ * @brief Reads while 'writing'; then checks the final state.
+ */
+static void *reader(void *arg)
+{
+	static TEST_VALUE v_main;            // the preemption pass reads on the main stack
+	TEST_VALUE *v = (arg ? arg : &v_main);
+	uint64_t    last_n = 0;
+	uint32_t    last = 0, seq;
+
+	while (writing)
+	{
+		if (!seqbuf_changed(&sb, last))
+		{
+			sched_yield(); // let the writer run, also on a single core
+			continue;
+		}
+
+		if (!(seq = seqbuf_read(&sb, v)))
+			continue;
+		check(v, seq);
+		if (v->n < last_n)
+			fail("read went back in time", seq);
+		if (last && v->n == last_n)
+			fail("changed since N, but the read returned N again", seq);
+		last   = seq;
+		last_n = v->n;
+		__sync_fetch_and_add(&reads_total, 1);
+	}
+
+	// writer stopped: changed() must be exact now
+	__sync_synchronize();
+	if (seqbuf_changed(&sb, last) != (seqbuf_seq(&sb) != last))
+		fail("seqbuf_changed() after the last publication", last);
+	seq = seqbuf_read(&sb, v);
+	check(v, seq);
+	if (v->n != writes || seqbuf_changed(&sb, seq))
+		fail("last publication not seen", seq);
+	return NULL;
+}
+
+
+static void *writer(void *arg)
+{
+	uint64_t n;
+
+	(void)arg;
+	for (n = writes + 1; reads_total < SEQBUF_TEST_READS; n++)
+	{
+		publish(n);
+		if (n % 4 == 0)
+			sched_yield(); // bursts of publications between the reads
+	}
+	__sync_synchronize();
+	writing = 0;
+	return NULL;
+}
+
+
+static void on_tick(int sig)
+{
+	int i;
+
+	(void)sig;
+	for (i = 0; i < SEQBUF_SLOTS; i++) // laps the slot a reader may be copying
+		publish(writes + 1);
+}
+
+
+/**
+ * @brief Empties the container or, with start != 0, puts a published value n = 0 in it.
+ */
+static void reset(uint32_t start)
+{
+	int i;
+
+	sb.seq      = start;
+	sb.retries  = 0;
+	reads_total = 0;
+	writes      = 0;
+	for (i = 0; i < SEQBUF_SLOTS; i++)
+		sb.ver[i] = 0;
+	if (start)
+	{
+		memset(&storage[start % SEQBUF_SLOTS], 0, sizeof(storage[0]));
+		storage[start % SEQBUF_SLOTS].seq = start;
+		sb.ver[start % SEQBUF_SLOTS] = 2 * start;
+	}
+	writing = 1;
+}
+
+
+static void run_threads(uint32_t start)
+{
+	static TEST_VALUE v[SEQBUF_TEST_READERS];
+	pthread_t w, r[SEQBUF_TEST_READERS];
+	int       i;
+
+	reset(start);
+	for (i = 0; i < SEQBUF_TEST_READERS; i++)
+		pthread_create(&r[i], NULL, reader, &v[i]);
+	pthread_create(&w, NULL, writer, NULL);
+	pthread_join(w, NULL);
+	for (i = 0; i < SEQBUF_TEST_READERS; i++)
+		pthread_join(r[i], NULL);
+
+	printf("seqbuf threads:    start %10u, %8llu writes, %8llu reads, %6u retries\n", start,
+	       (unsigned long long)writes, (unsigned long long)reads_total, (unsigned)sb.retries);
+}
+
+
+static void run_preempt(uint32_t start)
+{
+	struct itimerval tick = { { 0, SEQBUF_TEST_TICK_US }, { 0, SEQBUF_TEST_TICK_US } };
+	struct itimerval off  = { { 0, 0 }, { 0, 0 } };
+	TEST_VALUE      *v;
+	uint64_t         last_n = 0;
+	uint32_t         seq;
+
+	reset(start);
+	publish(1);
+	signal(SIGALRM, on_tick);
+	setitimer(ITIMER_REAL, &tick, NULL);
+
+	v = malloc(sizeof(*v));
+	while (reads_total < SEQBUF_TEST_READS / 10 || sb.retries < 100)
+	{
+		seq = seqbuf_read(&sb, v);
+		check(v, seq);
+		if (v->n < last_n)
+			fail("read went back in time", seq);
+		last_n = v->n;
+		reads_total++;
+	}
+
+	setitimer(ITIMER_REAL, &off, NULL);
+	signal(SIGALRM, SIG_DFL);
+	free(v);
+
+	printf("seqbuf preemption: start %10u, %8llu writes, %8llu reads, %6u retries\n", start,
+	       (unsigned long long)writes, (unsigned long long)reads_total, (unsigned)sb.retries);
+}
+
+
+int main(void)
+{
+	run_threads(0);
+	run_threads(UINT32_MAX - 1000); // wraps almost at once
+	run_preempt(0);
+	run_preempt(UINT32_MAX - 1000);
+
+	if (errors)
+	{
+		printf("seqbuf: %llu errors\n", (unsigned long long)errors);
+		return EXIT_FAILURE;
+	}
+	printf("seqbuf: OK\n");
+	return EXIT_SUCCESS;
+}
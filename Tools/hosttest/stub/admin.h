@@ -0,0 +1,73 @@
+/*
+ * admin.h (host stand-in)
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: braml
+ *
+ * Replaces Core/MyApp/App/admin.h, cmsis_os.h and main.h for host tests of modules
+ * that call a few FreeRTOS functions (logger.c, gps.c): one task, a simulated ms clock
+ * and an interrupt flag, all set by the test. ulTaskNotifyTake() and the message
+ * buffer calls are provided by the test, it is where the test runs its producers or
+ * collects the output.
+ */
+
+#ifndef HOSTTEST_ADMIN_H_
+#define HOSTTEST_ADMIN_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TRUE  1
+#define FALSE 0
+
+typedef unsigned long UBaseType_t;
+typedef long          BaseType_t;
+typedef uint32_t      TickType_t;
+typedef void         *TaskHandle_t;
+typedef void         *MessageBufferHandle_t;
+typedef void         *osThreadId_t;
+
+#define pdFALSE               0
+#define pdTRUE                1
+#define portTICK_PERIOD_MS    1
+#define pdMS_TO_TICKS(ms)     ((TickType_t)(ms))
+#define portYIELD_FROM_ISR(x) (void)(x)
+#define taskYIELD()           ((void)0)
+
+/// as in admin.h
+#define GPS_MAXLEN    79+4
+#define GPS_DEBUG_OUT 0x10
+extern int Uart_debug_out;
+extern MessageBufferHandle_t hGPS_MsgBuf;
+
+extern uint32_t host_ms;     // the tick count, 1 ms per tick
+extern int      host_isr;    // TRUE: the code runs "in an interrupt"
+extern int      host_masked; // critical section nesting, must end at 0
+extern int      host_kicks;  // task notifications given
+extern FILE    *host_uart;   // UART_puts() output, stdout if NULL
+
+static inline UBaseType_t taskENTER_CRITICAL_FROM_ISR(void) { host_masked++; return 0; }
+static inline void taskEXIT_CRITICAL_FROM_ISR(UBaseType_t m) { (void)m; host_masked--; }
+#define taskENTER_CRITICAL() (host_masked++)
+#define taskEXIT_CRITICAL()  (host_masked--)
+
+static inline TickType_t   xTaskGetTickCount(void)          { return host_ms; }
+static inline TickType_t   xTaskGetTickCountFromISR(void)   { return host_ms; }
+static inline BaseType_t   xPortIsInsideInterrupt(void)     { return host_isr; }
+static inline TaskHandle_t xTaskGetCurrentTaskHandle(void)  { return (TaskHandle_t)&host_ms; }
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t h, BaseType_t *woken) { (void)h; (void)woken; host_kicks++; }
+static inline void xTaskNotifyGive(TaskHandle_t h)          { (void)h; host_kicks++; }
+
+extern uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+extern size_t   xMessageBufferSendFromISR(MessageBufferHandle_t h, const void *data, size_t len, BaseType_t *woken);
+extern size_t   xMessageBufferReceive(MessageBufferHandle_t h, void *data, size_t len, TickType_t wait);
+
+extern void GPS_rx_byte_ISR (char, BaseType_t *);
+extern void GPS_rx_bytes    (const uint8_t *, uint32_t);
+extern void GPS_rx_select   (int);
+
+static inline void UART_puts(const char *s)     { fputs(s, host_uart ? host_uart : stdout); }
+static inline void UART_putint(unsigned int v)  { fprintf(host_uart ? host_uart : stdout, "%u", v); }
+
+#endif /* HOSTTEST_ADMIN_H_ */
@@ -0,0 +1,6 @@
+/* host stand-in, see admin.h */
+#define GPIOD              NULL
+#define LEDGREEN           0x1000
+#define GPIO_PIN_RESET     0
+#define GPIO_PIN_SET       1
+#define HAL_GPIO_WritePin(port, pin, state) ((void)(port), (void)(pin), (void)(state))
@@ -0,0 +1,5 @@
+/* host stand-in, see admin.h */
+#ifndef HOSTTEST_USBH_CORE_H_
+#define HOSTTEST_USBH_CORE_H_
+typedef struct { int unused; } USBH_HandleTypeDef;
+#endif
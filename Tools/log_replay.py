@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""
+log_replay.py - reader and replay of the logger recordings (Core/MyApp/App/logger.h)
+
+A recording is a sequence of fixed-size blocks (LOG_BLOCK, 8 sectors): a 16-byte header
+(magic 'GLOG', version, sectors, used, seq, tick ms) and records (type, len, dt ms,
+payload), zero-padded. Raw GNSS bytes (UART4 or USB) and every broadcast correction.
+
+  log_replay.py LOG0003.GLG                        index: blocks, time span, records
+  log_replay.py LOG0003.GLG --nmea out.nmea        raw receiver stream, both sources
+  log_replay.py LOG0003.GLG --corrections c.csv    corrections with the transmit result
+  log_replay.py LOG0003.GLG --from 120 --to 300    only this part (s since boot), via the index
+  log_replay.py LOG0003.GLG --serial /dev/ttyUSB0  replay the raw stream with its timing
+  log_replay.py putty.log                          a capture of 'log dump' (RAM disk, hex)
+
+--serial needs pyserial; feed it to UART4 of a second board, or to a PC tool.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+import time
+
+MAGIC = 0x474F4C47
+SECTOR = 512
+BLOCK_HDR = struct.Struct("<IBBHII")   # magic version sectors used seq tick
+REC_HDR = struct.Struct("<BBH")        # type len dt
+RAW_UART, RAW_USB, CORRECTION = 1, 2, 3
+TYPES = {RAW_UART: "uart", RAW_USB: "usb", CORRECTION: "correction"}
+
+# LOG_CORR_REC: NRF_CORRECTION (NRF_driver.h) + transmit status
+CORR = struct.Struct("<BBHIiiihhhHHHB")
+CORR_FIELDS = "version flags seq time err_e err_n err_u rate_e rate_n rate_u sd_e sd_n sd_u status".split()
+
+
+def read_blocks(path):
+    """Returns [bytes] of all blocks, from a binary recording or a 'log dump' capture."""
+    data = open(path, "rb").read()
+    if data[:4] == struct.pack("<I", MAGIC):
+        sectors = BLOCK_HDR.unpack_from(data)[2]
+        size = sectors * SECTOR
+        return [data[i:i + size] for i in range(0, len(data) - size + 1, size)]
+
+    blocks, cur = [], None  # hex dump: '=' starts a block, ':' lines hold its used bytes
+    for line in data.decode("ascii", "replace").splitlines():
+        line = line.strip()
+        if line.startswith("="):
+            cur = bytearray()
+            blocks.append(cur)
+        elif line.startswith(":") and cur is not None:
+            cur += bytes.fromhex(line[1:])
+    return [bytes(b) for b in blocks]
+
+
+def index(blocks):
+    """Returns [(block nr, seq, tick, used)] of the valid blocks."""
+    idx = []
+    for nr, b in enumerate(blocks):
+        if len(b) < BLOCK_HDR.size:
+            continue
+        magic, version, _, used, seq, tick = BLOCK_HDR.unpack_from(b)
+        if magic == MAGIC and version == 1 and BLOCK_HDR.size <= used <= len(b):
+            idx.append((nr, seq, tick, used))
+    return idx
+
+
+def records(block, used, tick):
+    """Yields (type, ms since boot, payload) of one block."""
+    pos = BLOCK_HDR.size
+    while pos + REC_HDR.size <= used:
+        rtype, n, dt = REC_HDR.unpack_from(block, pos)
+        pos += REC_HDR.size
+        yield rtype, tick + dt, block[pos:pos + n]
+        pos += n
+
+
+def select(blocks, idx, t_from, t_to):
+    """Yields the records between t_from and t_to (s); skips blocks via the index."""
+    for i, (nr, seq, tick, used) in enumerate(idx):
+        nxt = idx[i + 1][2] if i + 1 < len(idx) else None
+        if t_to is not None and tick > t_to * 1000:
+            break
+        if t_from is not None and nxt is not None and nxt <= t_from * 1000:
+            continue
+        for rtype, ms, payload in records(blocks[nr], used, tick):
+            if (t_from is None or ms >= t_from * 1000) and (t_to is None or ms <= t_to * 1000):
+                yield rtype, ms, payload
+
+
+def show_index(blocks, idx):
+    print("%6s %8s %12s %6s  %s" % ("block", "seq", "tick (s)", "used", "records"))
+    lost = 0
+    for i, (nr, seq, tick, used) in enumerate(idx):
+        count = {}
+        for rtype, _, payload in records(blocks[nr], used, tick):
+            name = TYPES.get(rtype, "type%d" % rtype)
+            count[name] = count.get(name, 0) + (len(payload) if rtype != CORRECTION else 1)
+        if i and seq != idx[i - 1][1] + 1:
+            lost += 1
+        print("%6d %8d %12.3f %6d  %s" % (nr, seq, tick / 1000.0, used,
+                                          " ".join("%s=%d" % kv for kv in sorted(count.items()))))
+    print("\n%d blocks, %d invalid, %d gaps in seq (raw counts in bytes)" % (len(idx), len(blocks) - len(idx), lost))
+
+
+def replay(recs, port, baud, speed):
+    import serial  # pyserial
+    out = serial.Serial(port, baud)
+    t0 = w0 = None
+    for rtype, ms, payload in recs:
+        if rtype not in (RAW_UART, RAW_USB):
+            continue
+        if t0 is None:
+            t0, w0 = ms, time.monotonic()
+        delay = (ms - t0) / 1000.0 / speed - (time.monotonic() - w0)
+        if delay > 0:
+            time.sleep(delay)
+        out.write(payload)
+    out.flush()
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("recording", help="LOGnnnn.GLG, or a terminal capture of 'log dump'")
+    ap.add_argument("--nmea", metavar="FILE", help="write the raw receiver bytes")
+    ap.add_argument("--corrections", metavar="CSV", help="write the corrections")
+    ap.add_argument("--from", dest="t_from", type=float, help="start, s since boot")
+    ap.add_argument("--to", dest="t_to", type=float, help="end, s since boot")
+    ap.add_argument("--serial", metavar="PORT", help="replay the raw bytes on a serial port")
+    ap.add_argument("--baud", type=int, default=9600, help="for --serial (default: %(default)s, UART4)")
+    ap.add_argument("--speed", type=float, default=1.0, help="replay speed factor for --serial")
+    args = ap.parse_args()
+
+    blocks = read_blocks(args.recording)
+    idx = index(blocks)
+    if not idx:
+        sys.exit("no valid blocks in %s" % args.recording)
+
+    if not (args.nmea or args.corrections or args.serial):
+        show_index(blocks, idx)
+        return
+
+    if args.serial:
+        replay(select(blocks, idx, args.t_from, args.t_to), args.serial, args.baud, args.speed)
+        return
+
+    nmea = open(args.nmea, "wb") if args.nmea else None
+    writer = None
+    if args.corrections:
+        writer = csv.writer(open(args.corrections, "w", newline=""))
+        writer.writerow(["ms"] + CORR_FIELDS)
+
+    for rtype, ms, payload in select(blocks, idx, args.t_from, args.t_to):
+        if rtype in (RAW_UART, RAW_USB) and nmea:
+            nmea.write(payload)
+        elif rtype == CORRECTION and writer and len(payload) == CORR.size:
+            writer.writerow([ms] + list(CORR.unpack(payload)))
+
+
+if __name__ == "__main__":
+    main()
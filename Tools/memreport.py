@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+memreport.py - RAM per task and per RTOS object, from the linker map file
+
+All task stacks/TCBs and the queues, message buffers, mutexes, event groups and
+timers are static (admin.c: TASK_STACK, CreateHandles), so the map file of the
+build has the exact size of each. STM32CubeIDE writes it next to the .elf:
+
+  memreport.py Debug/Diff_GPS_TX_RTOS.map
+  memreport.py Debug/Diff_GPS_TX_RTOS.map --all      also every other RAM object > 64 bytes
+
+Two builds, e.g. the demo and the production profile (APP_PROFILE, admin.h). The
+Release and Production configurations differ only in APP_PROFILE (both -Os):
+
+  memreport.py Release/Diff_GPS_TX_RTOS.map --compare Production/Diff_GPS_TX_RTOS.map
+
+Needs the default -fdata-sections, so every variable has its own input section.
+"""
+
+import argparse
+import re
+import sys
+
+RAM_SIZE = 128 * 1024  # STM32F407VGTX_FLASH.ld, region RAM
+CCM_SIZE = 64 * 1024   # region CCMRAM, section .ccmram (logger RAM disk)
+
+# input section, either on one line or with the address/size on the next line
+SECTION = re.compile(r"^ \.(bss|data|noinit)\.(\S+)(?:\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+))?$")
+ADDRSIZE = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+(\S+)$")
+OUTPUT = re.compile(r"^\.(\S+)\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)")
+
+# output sections in flash; .data is in both (its initial values are copied from flash)
+FLASH_SECTIONS = ("isr_vector", "text", "rodata", "ARM.extab", "ARM", "preinit_array", "init_array", "fini_array", "data")
+RAM_SECTIONS = ("data", "bss", "noinit", "_user_heap_stack")
+
+# kernel objects outside admin.c
+KERNEL = {
+    "ucHeap": "heap_4 arena (configTOTAL_HEAP_SIZE)",
+    "defaultTaskBuffer": "defaultTask stack (main.c)",
+    "defaultTaskControlBlock": "defaultTask TCB (main.c)",
+    "Idle_Stack": "idle task stack",
+    "Idle_TCB": "idle task TCB",
+    "Timer_Stack": "timer task stack",
+    "Timer_TCB": "timer task TCB",
+}
+
+
+def parse(path):
+    """Returns ({symbol: (size, object file)}, {output section: size})."""
+    symbols, outputs = {}, {}
+    pending = None
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if pending:
+                m = ADDRSIZE.match(line)
+                if m:
+                    symbols[pending] = (int(m.group(2), 16), m.group(3))
+                pending = None
+                continue
+
+            m = SECTION.match(line)
+            if m:
+                name = m.group(2)
+                if m.group(3):
+                    symbols[name] = (int(m.group(4), 16), m.group(5))
+                else:
+                    pending = name
+                continue
+
+            m = OUTPUT.match(line)
+            if m:
+                outputs[m.group(1)] = int(m.group(3), 16)
+
+    return symbols, outputs
+
+
+def tasks_of(symbols):
+    """Returns {task: stack + TCB} of the TASK_STACK() objects."""
+    return {s[:-len("_stack")]: symbols[s][0] + symbols.get(s[:-len("_stack")] + "_tcb", (0, ""))[0]
+            for s in symbols if s.endswith("_stack")}
+
+
+def compare(path_a, path_b):
+    """Flash, RAM and task memory of two builds, with the difference b - a."""
+    (sym_a, out_a), (sym_b, out_b) = parse(path_a), parse(path_b)
+
+    print("  %-24s %10s %10s %10s" % ("", "a", "b", "b - a"))
+    for title, sections in (("Flash", FLASH_SECTIONS), ("RAM", RAM_SECTIONS)):
+        print(title)
+        tot_a = tot_b = 0
+        for sec in sections:
+            a, b = out_a.get(sec, 0), out_b.get(sec, 0)
+            if a or b:
+                tot_a, tot_b = tot_a + a, tot_b + b
+                print("  .%-23s %10d %10d %+10d" % (sec, a, b, b - a))
+        print("  %-24s %10d %10d %+10d" % ("total", tot_a, tot_b, tot_b - tot_a))
+
+    tasks_a, tasks_b = tasks_of(sym_a), tasks_of(sym_b)
+    print("Tasks (stack + TCB)")
+    for name in sorted(set(tasks_a) | set(tasks_b)):
+        a, b = tasks_a.get(name, 0), tasks_b.get(name, 0)
+        if a != b:
+            print("  %-24s %10d %10d %+10d" % (name, a, b, b - a))
+    a, b = sum(tasks_a.values()), sum(tasks_b.values())
+    print("  %-24s %10d %10d %+10d  (%d -> %d tasks)" % ("total", a, b, b - a, len(tasks_a), len(tasks_b)))
+    print("\na: %s\nb: %s" % (path_a, path_b))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("map", help="linker map file")
+    ap.add_argument("--all", action="store_true", help="also list other RAM objects > 64 bytes")
+    ap.add_argument("--compare", metavar="MAP", help="second map file: flash/RAM/tasks of both and the difference")
+    args = ap.parse_args()
+
+    if args.compare:
+        compare(args.map, args.compare)
+        return
+
+    symbols, outputs = parse(args.map)
+    used = set()
+
+    print("Tasks (admin.c TASK_STACK)")
+    print("  %-18s %8s %8s %8s" % ("task", "stack", "TCB", "total"))
+    total_tasks = 0
+    for name in sorted(s[:-len("_stack")] for s in symbols if s.endswith("_stack")):
+        stack = symbols[name + "_stack"][0]
+        tcb = symbols.get(name + "_tcb", (0, ""))[0]
+        used.update((name + "_stack", name + "_tcb"))
+        total_tasks += stack + tcb
+        print("  %-18s %8d %8d %8d" % (name, stack, tcb, stack + tcb))
+    print("  %-18s %26d" % ("total", total_tasks))
+
+    print("\nRTOS objects (admin.c CreateHandles)")
+    total_objs = 0
+    for name in sorted(s for s in symbols if s.endswith("_mem") or s.endswith("_storage")):
+        size = symbols[name][0]
+        used.add(name)
+        total_objs += size
+        print("  %-24s %8d" % (name, size))
+    print("  %-24s %8d" % ("total", total_objs))
+
+    print("\nKernel")
+    for name, what in KERNEL.items():
+        if name in symbols:
+            used.add(name)
+            print("  %-24s %8d  %s" % (name, symbols[name][0], what))
+
+    if args.all:
+        print("\nOther RAM objects > 64 bytes")
+        rest = sorted(((size, name, obj) for name, (size, obj) in symbols.items()
+                       if name not in used and size > 64), reverse=True)
+        for size, name, obj in rest:
+            print("  %-32s %8d  %s" % (name, size, obj.split("/")[-1]))
+
+    print("\nRAM")
+    ram = 0
+    for sec in RAM_SECTIONS:
+        if sec in outputs:
+            ram += outputs[sec]
+            print("  .%-23s %8d" % (sec, outputs[sec]))
+    print("  %-24s %8d of %d (%d%%)" % ("total", ram, RAM_SIZE, 100 * ram // RAM_SIZE))
+    if "ccmram" in outputs:
+        print("  %-24s %8d of %d (CCM RAM)" % (".ccmram", outputs["ccmram"], CCM_SIZE))
+
+    if not symbols:
+        sys.exit("no .bss/.data input sections found; is this a GNU ld map built with -fdata-sections?")
+
+
+if __name__ == "__main__":
+    main()
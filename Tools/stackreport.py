@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+stackreport.py - worst-case stack per task from the call graph, checked against a soak run
+
+The Debug build compiles with -fstack-usage (STM32CubeIDE default) and -fcallgraph-info=su
+(.cproject, other flags), so every object file has a .su file (stack frame per function)
+and a .ci file (call graph, VCG). The worst-case depth of each task entry function in
+tasks[] (Core/MyApp/App/admin.c) is the deepest path through that graph plus the task
+context that FreeRTOS stacks on a switch. High-water marks from a soak run are read from
+a log of the 't' command, or of tlm_decode.py (the [tasks] lines).
+
+  stackreport.py Debug
+  stackreport.py Debug --soak putty.log --soak tlm.txt
+  stackreport.py Debug --profile production --soak tlm.txt -v     also the deepest call chain
+
+A '+' after the static figure means the path has an indirect call, recursion or a library
+function without a .ci file (see LIBC, --extern): the real worst case can be larger, and the
+recommendation then relies on the soak run. Needs GCC 10 or later for -fcallgraph-info.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+ADMIN_C = os.path.join(os.path.dirname(__file__), "..", "Core", "MyApp", "App", "admin.c")
+
+# saved on the task stack by a context switch on the Cortex-M4F: the extended exception
+# frame (26 words) and r4-r11, lr and s16-s31 of xPortPendSVHandler (25 words)
+CONTEXT = 51 * 4
+
+# newlib (not compiled with the project, so no .ci): frame estimates in bytes, deepest path.
+# The printf family with -u _printf_float goes through _dtoa_r for doubles.
+LIBC = {
+    "snprintf": 800, "sprintf": 800, "vsnprintf": 800, "printf": 800, "vsprintf": 800,
+    "strtod": 300, "atof": 300, "strtof": 300,
+    "atoi": 48, "strtol": 48, "strtoul": 48,
+    "memcpy": 16, "memset": 16, "memcmp": 16, "memmove": 16,
+    "strlen": 8, "strcpy": 16, "strncpy": 16, "strcmp": 16, "strncmp": 16, "strtok": 24, "strchr": 8,
+    "toupper": 8, "tolower": 8,
+    "sqrt": 24, "sqrtf": 8, "sin": 64, "cos": 64, "atan2": 96, "fabs": 8, "floor": 24,
+    "__aeabi_dadd": 24, "__aeabi_dsub": 24, "__aeabi_dmul": 24, "__aeabi_ddiv": 32,
+    "__aeabi_d2f": 8, "__aeabi_f2d": 8, "__aeabi_i2d": 8, "__aeabi_d2iz": 8, "__aeabi_dcmplt": 16,
+    "__aeabi_dcmpgt": 16, "__aeabi_dcmpeq": 16, "__aeabi_dcmpge": 16, "__aeabi_dcmple": 16,
+    "__aeabi_uldivmod": 32, "__aeabi_ldivmod": 32,
+}
+
+NODE = re.compile(r'node:\s*\{\s*title:\s*"([^"]+)"\s*label:\s*"([^"]*)"(.*?)\}')
+EDGE = re.compile(r'edge:\s*\{\s*sourcename:\s*"([^"]+)"\s*targetname:\s*"([^"]+)"')
+FRAME = re.compile(r"\\n(\d+) bytes \((\w+(?:,\w+)?)\)")
+SU = re.compile(r"^(.+):(\d+):(\d+):(\S+)\s+(\d+)\s+(\S+)$")
+
+TASK_STACK = re.compile(r"^TASK_STACK\((\w+),\s*(\d+)\)")
+TASK_ENTRY = re.compile(r'^\s*\{\s*(\w+)\s*,\s*\w+\s*,\s*\.attr\.name\s*=\s*"([^"]+)"\s*,\s*TASK_MEM\((\w+)\)')
+
+# soak logs: the 't' command (free in bytes), tlm_decode.py (free in words, by task number)
+T_LINE = re.compile(r"\[(\d+)\]\s+(\S+)\s+priority:\s*\d+\s+stacksize:\s*(\d+)\s+free:\s*(\d+)")
+TLM_LINE = re.compile(r"^\[tasks\]")
+TLM_TASK = re.compile(r"\b(\d+):\w+/(\d+)\b")
+
+
+def read_tasks(path, profile):
+    """Returns [(function, name, stack bytes)] in the order of tasks[], for one APP_PROFILE."""
+    stacks, tasks = {}, []
+    conds = []  # per open #if: [is an APP_PROFILE test, its lines are skipped]
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            s = line.strip()
+            if s.startswith("#if"):
+                conds.append(["APP_PROFILE" in s, "APP_PROFILE_DEMO" in s and profile != "demo"])
+                continue
+            if s.startswith("#else") and conds:
+                if conds[-1][0]:
+                    conds[-1][1] = not conds[-1][1]
+                continue
+            if s.startswith("#endif") and conds:
+                conds.pop()
+                continue
+            if any(skip for _, skip in conds):
+                continue
+
+            m = TASK_STACK.match(s)
+            if m:
+                stacks[m.group(1)] = (int(m.group(2)) + 7) // 8 * 8
+            m = TASK_ENTRY.match(line)
+            if m:
+                tasks.append((m.group(1), m.group(2), stacks.get(m.group(3), 0)))
+
+    return tasks
+
+
+def read_graph(build):
+    """Returns ({function: (frame bytes, dynamic)}, {function: set of callees})."""
+    frames, calls = {}, {}
+
+    for root, _, files in os.walk(build):
+        for name in files:
+            path = os.path.join(root, name)
+            if name.endswith(".ci"):
+                text = open(path, errors="replace").read()
+                for title, label, _ in NODE.findall(text):
+                    m = FRAME.search(label)
+                    if m:  # a definition; declarations have no frame
+                        size = max(int(m.group(1)), frames.get(title, (0, False))[0])
+                        frames[title] = (size, m.group(2) != "static")
+                for src, dst in EDGE.findall(text):
+                    calls.setdefault(src, set()).add(dst)
+            elif name.endswith(".su"):
+                for line in open(path, errors="replace"):
+                    m = SU.match(line.strip())
+                    if m and m.group(4) not in frames:
+                        frames[m.group(4)] = (int(m.group(5)), m.group(6) != "static")
+
+    return frames, calls
+
+
+def worst_path(func, frames, calls, externs):
+    """Deepest path from func: (bytes, [functions], incomplete)."""
+    memo = {}
+
+    def walk(f, stack):
+        if f in memo:
+            return memo[f]
+        if f in stack:  # recursion: the depth per pass is counted once
+            return 0, [f + " (recursion)"], True
+        if f == "__indirect_call":
+            return 0, ["(indirect call)"], True
+        if f not in frames:
+            if f in externs:
+                return externs[f], [f + " (estimate)"], False
+            return 0, [f + " (unknown)"], True
+
+        size, dynamic = frames[f]
+        best, path, incomplete = 0, [], dynamic
+        stack.add(f)
+        for callee in sorted(calls.get(f, ())):
+            d, p, inc = walk(callee, stack)
+            incomplete |= inc
+            if d > best or not path:
+                best, path = d, p
+        stack.discard(f)
+
+        memo[f] = (size + best, [f] + path, incomplete)
+        return memo[f]
+
+    return walk(func, set())
+
+
+def read_soak(paths, tasks):
+    """Returns {task name: lowest free bytes} over all samples."""
+    low = {}
+    by_nr = {i + 1: name for i, (_, name, _) in enumerate(tasks)}
+
+    def sample(name, free):
+        if name:
+            low[name] = min(free, low.get(name, free))
+
+    for path in paths:
+        for line in open(path, errors="replace"):
+            m = T_LINE.search(line)
+            if m:
+                sample(m.group(2), int(m.group(4)))
+            elif TLM_LINE.match(line):
+                for nr, words in TLM_TASK.findall(line):
+                    sample(by_nr.get(int(nr)), int(words) * 4)
+    return low
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("build", help="build directory with the .su and .ci files, e.g. Debug")
+    ap.add_argument("--soak", action="append", default=[], help="log with 't' output or tlm_decode.py [tasks] lines")
+    ap.add_argument("--profile", choices=("demo", "production"), default="demo", help="APP_PROFILE of the build")
+    ap.add_argument("--admin", default=ADMIN_C, help="admin.c with tasks[] (default: %(default)s)")
+    ap.add_argument("--margin", type=float, default=0.25, help="headroom on the worst case (default: %(default)s)")
+    ap.add_argument("--extern", action="append", default=[], metavar="FUNC=BYTES", help="stack of a library function")
+    ap.add_argument("-v", action="store_true", help="print the deepest call chain per task")
+    args = ap.parse_args()
+
+    externs = dict(LIBC)
+    for e in args.extern:
+        name, _, size = e.partition("=")
+        externs[name] = int(size)
+
+    tasks = read_tasks(args.admin, args.profile)
+    frames, calls = read_graph(args.build)
+    if not frames:
+        sys.exit("no .su/.ci files in %s; build with -fstack-usage -fcallgraph-info=su" % args.build)
+    if not calls:
+        print("no .ci files: only the frame of each entry function is known (-fcallgraph-info=su missing?)\n")
+    soak = read_soak(args.soak, tasks)
+
+    print("%-16s %8s %10s %8s %8s %8s" % ("task", "stack", "static", "soak", "advice", "delta"))
+    total_now = total_new = 0
+    for func, name, stack in tasks:
+        depth, path, incomplete = worst_path(func, frames, calls, externs)
+        static = depth + CONTEXT
+        used = stack - soak[name] if name in soak else None
+
+        # the static figure is a bound only when complete; else take the larger of both
+        if incomplete and used is None:
+            advice = stack
+        else:
+            advice = (int(max(static, used or 0) * (1 + args.margin)) + 7) // 8 * 8
+
+        total_now += stack
+        total_new += advice
+        print("%-16s %8d %9d%s %8s %8d %+8d" % (name, stack, static, "+" if incomplete else " ",
+                                              "-" if used is None else used, advice, advice - stack))
+        if args.v:
+            print("    " + " > ".join(path))
+
+    print("%-16s %8d %10s %8s %8d %+8d" % ("total", total_now, "", "", total_new, total_new - total_now))
+    print("\nstatic = deepest call chain + %d bytes task context; soak = stack - lowest free;" % CONTEXT)
+    print("advice = %d%% over the larger of both, the current size if there is no bound" % (100 * args.margin))
+    if not args.soak:
+        print("no --soak log: tasks marked '+' keep their current size")
+
+
+if __name__ == "__main__":
+    main()
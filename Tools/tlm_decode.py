@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""
+tlm_decode.py - decoder for the binary telemetry on UART2 (Core/MyApp/App/telemetry.h)
+
+Frame: COBS(type | seq | payload | crc16) 0x00, crc16 = CRC-16/CCITT-FALSE, little-endian.
+
+  tlm_decode.py /dev/ttyACM0            live, prints every record
+  tlm_decode.py capture.bin --csv out   from a raw capture, one CSV per record type
+  tlm_decode.py /dev/ttyACM0 --plot     live plot of the smoothed east/north error
+
+Serial ports need pyserial, --plot needs matplotlib. Press 'b' in the terminal
+program (text mode) to switch the board to binary telemetry; this tool sends 'b\\r'
+itself with --start.
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+
+TLM_FIX, TLM_ERROR, TLM_RADIO, TLM_TASKS, TLM_LATENCY, TLM_TEXT = range(1, 7)
+
+# packed little-endian layouts, see telemetry.h / NRF_driver.h
+RECORDS = {
+    TLM_FIX: ("fix", "<IIiiiHHHHBBcB",
+              "seq time lat lon alt speed hdop std_lat std_lon quality numsv status mode"),
+    TLM_ERROR: ("error", "<BBHIiiihhhHHH",
+                "version flags seq time err_e err_n err_u rate_e rate_n rate_u sd_e sd_n sd_u"),
+    TLM_RADIO: ("radio", "<HB", "seq status"),
+    TLM_LATENCY: ("latency", "<BI", "probe us"),
+}
+TASKS_HDR = struct.Struct("<IHBB")   # free_heap dropped cpu ntasks
+TASK_REC = struct.Struct("<BBBH")    # nr state priority free
+PROBES = {1: "fix->corr", 2: "corr->tx"}
+STATES = {0: "run", 1: "ready", 2: "blocked", 3: "susp", 4: "del"}
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            raise ValueError("bad COBS")
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+class Decoder:
+    """Splits a byte stream into records; counts CRC errors and lost frames."""
+
+    def __init__(self):
+        self.buf = bytearray()
+        self.last_seq = None
+        self.crc_errors = 0
+        self.lost = 0
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            end = self.buf.find(0)
+            if end < 0:
+                return
+            frame, self.buf = bytes(self.buf[:end]), self.buf[end + 1:]
+            if not frame:
+                continue
+            try:
+                rec = cobs_decode(frame)
+            except ValueError:
+                self.crc_errors += 1
+                continue
+            if len(rec) < 4 or crc16(rec[:-2]) != struct.unpack_from("<H", rec, len(rec) - 2)[0]:
+                self.crc_errors += 1
+                continue
+            rtype, seq, payload = rec[0], rec[1], rec[2:-2]
+            if self.last_seq is not None:
+                self.lost += (seq - self.last_seq - 1) & 0xFF
+            self.last_seq = seq
+            yield rtype, seq, payload
+
+
+def parse(rtype, payload):
+    """Returns (name, dict) of one record; scales to SI units where useful."""
+    if rtype == TLM_TEXT:
+        return "text", {"text": payload.decode("ascii", "replace")}
+    if rtype == TLM_TASKS:
+        heap, dropped, cpu, n = TASKS_HDR.unpack_from(payload)
+        tasks = [TASK_REC.unpack_from(payload, TASKS_HDR.size + i * TASK_REC.size) for i in range(n)]
+        return "tasks", {"free_heap": heap, "dropped": dropped, "cpu": cpu, "tasks": tasks}
+    if rtype not in RECORDS:
+        return "unknown", {"type": rtype, "raw": payload.hex()}
+    name, fmt, fields = RECORDS[rtype]
+    d = dict(zip(fields.split(), struct.unpack_from(fmt, payload)))
+    if rtype == TLM_FIX:
+        d["lat"] /= 1e7
+        d["lon"] /= 1e7
+        d["alt"] = None if d["alt"] == -2**31 else d["alt"] / 1000.0
+        d["status"] = d["status"].decode()
+    return name, d
+
+
+def show(name, d):
+    if name == "text":
+        sys.stdout.write(d["text"])
+    elif name == "tasks":
+        t = " ".join("%d:%s/%d" % (nr, STATES.get(st, st), free) for nr, st, _, free in d["tasks"])
+        print("[tasks] heap %d cpu %d%% dropped %d  %s" % (d["free_heap"], d["cpu"], d["dropped"], t))
+    elif name == "latency":
+        print("[latency] %s %d us" % (PROBES.get(d["probe"], d["probe"]), d["us"]))
+    elif name == "error":
+        print("[error] #%d E %+.3f N %+.3f U %+.3f m  sd %d/%d/%d mm" %
+              (d["seq"], d["err_e"] / 1000, d["err_n"] / 1000, d["err_u"] / 1000, d["sd_e"], d["sd_n"], d["sd_u"]))
+    else:
+        print("[%s] %s" % (name, " ".join("%s=%s" % kv for kv in d.items())))
+
+
+def open_source(path, baud, start):
+    if os.path.exists(path) and not path.startswith("/dev/"):
+        return open(path, "rb")
+    import serial  # pyserial
+    port = serial.Serial(path, baud, timeout=0.2)
+    if start:
+        port.write(b"b\r")
+    return port
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("source", help="serial port or raw capture file")
+    ap.add_argument("--baud", type=int, default=115200)
+    ap.add_argument("--start", action="store_true", help="send 'b' to switch the board to binary")
+    ap.add_argument("--csv", metavar="DIR", help="write one CSV per record type")
+    ap.add_argument("--raw", metavar="FILE", help="also save the raw stream")
+    ap.add_argument("--plot", action="store_true", help="live plot of the east/north error")
+    ap.add_argument("--quiet", action="store_true", help="do not print records")
+    args = ap.parse_args()
+
+    src = open_source(args.source, args.baud, args.start)
+    raw = open(args.raw, "wb") if args.raw else None
+    dec = Decoder()
+    writers = {}
+    plot = Plot() if args.plot else None
+    if args.csv:
+        os.makedirs(args.csv, exist_ok=True)
+
+    try:
+        while True:
+            data = src.read(4096)
+            if not data:
+                if not hasattr(src, "in_waiting"):  # end of file
+                    break
+                continue
+            if raw:
+                raw.write(data)
+            for rtype, seq, payload in dec.feed(data):
+                name, d = parse(rtype, payload)
+                if not args.quiet:
+                    show(name, d)
+                if args.csv and name not in ("text", "tasks", "unknown"):
+                    if name not in writers:
+                        f = open(os.path.join(args.csv, name + ".csv"), "w", newline="")
+                        writers[name] = csv.DictWriter(f, fieldnames=list(d))
+                        writers[name].writeheader()
+                    writers[name].writerow(d)
+                if plot and name == "error":
+                    plot.add(d)
+            if plot:
+                plot.pause()
+    except KeyboardInterrupt:
+        pass
+    print("\ncrc/framing errors: %d, lost frames: %d" % (dec.crc_errors, dec.lost), file=sys.stderr)
+
+
+class Plot:
+    """Rolling plot of the last 600 corrections (1 min at 10 Hz)."""
+
+    def __init__(self, n=600):
+        import matplotlib.pyplot as plt
+        self.plt, self.n = plt, n
+        self.e, self.nn = [], []
+        plt.ion()
+        self.fig, self.ax = plt.subplots()
+        (self.le,) = self.ax.plot([], [], label="east")
+        (self.ln,) = self.ax.plot([], [], label="north")
+        self.ax.set_ylabel("error (m)")
+        self.ax.legend()
+
+    def add(self, d):
+        self.e = (self.e + [d["err_e"] / 1000])[-self.n:]
+        self.nn = (self.nn + [d["err_n"] / 1000])[-self.n:]
+
+    def pause(self):
+        x = range(len(self.e))
+        self.le.set_data(x, self.e)
+        self.ln.set_data(x, self.nn)
+        self.ax.relim()
+        self.ax.autoscale_view()
+        self.plt.pause(0.01)
+
+
+if __name__ == "__main__":
+    main()
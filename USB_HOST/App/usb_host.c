@@ -26,6 +26,9 @@
 #include "usbh_cdc.h"
 
 /* USER CODE BEGIN Includes */
+#include "GPS_usb.h" // a GNSS receiver as CDC device
+#include "usbh_msc.h"
+#include "logdisk.h" // or a USB stick for the logger
 
 /* USER CODE END Includes */
 
@@ -86,6 +89,12 @@ void MX_USB_HOST_Init(void)
     Error_Handler();
   }
   /* USER CODE BEGIN USB_HOST_Init_PostTreatment */
+  // MSC next to the CDC class of the .ioc; safe after USBH_Start(): the USBH thread
+  // only looks at the classes once a device is enumerated
+  if (USBH_RegisterClass(&hUsbHostFS, USBH_MSC_CLASS) != USBH_OK)
+  {
+    Error_Handler();
+  }
 
   /* USER CODE END USB_HOST_Init_PostTreatment */
 }
@@ -96,6 +105,9 @@ void MX_USB_HOST_Init(void)
 static void USBH_UserProcess  (USBH_HandleTypeDef *phost, uint8_t id)
 {
   /* USER CODE BEGIN CALL_BACK_1 */
+  GPS_usb_event(phost, id);
+  logdisk_fatfs_event(phost, id);
+
   switch(id)
   {
   case HOST_USER_SELECT_CONFIGURATION:
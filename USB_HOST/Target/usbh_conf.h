@@ -76,7 +76,7 @@
 #define USBH_KEEP_CFG_DESCRIPTOR      1U
 
 /*----------   -----------*/
-#define USBH_MAX_NUM_SUPPORTED_CLASS      1U
+#define USBH_MAX_NUM_SUPPORTED_CLASS      2U
 
 /*----------   -----------*/
 #define USBH_MAX_SIZE_CONFIGURATION      256U
@@ -98,7 +98,7 @@
 #if (USBH_USE_OS == 1)
   #include "cmsis_os.h"
   #define USBH_PROCESS_PRIO          osPriorityNormal
-  #define USBH_PROCESS_STACK_SIZE    ((uint16_t)128)
+  #define USBH_PROCESS_STACK_SIZE    ((uint16_t)1024)
 #endif /* (USBH_USE_OS == 1) */
 
 /**